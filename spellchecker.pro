@@ -19,6 +19,17 @@ exists(spellchecker_local_paths.pri) {
 # Include the sources
 include(src/src.pri)
 
+# Offline compiler for the images of the Mapped Dictionary spell checker.
+# It only needs QtCore, build it with "make dictcompiler" (or jom/nmake),
+# the executable ends up in tools/dictcompiler of the build directory.
+DICTCOMPILER_BUILD_DIR = $${OUT_PWD}/tools/dictcompiler
+!mkpath($${DICTCOMPILER_BUILD_DIR}):warning("Could not create $${DICTCOMPILER_BUILD_DIR}")
+dictcompiler.commands = cd $$shell_quote($$shell_path($${DICTCOMPILER_BUILD_DIR})) && $$shell_quote($$shell_path($${QMAKE_QMAKE})) $$shell_quote($$shell_path($${PWD}/tools/dictcompiler/dictcompiler.pro)) && $(MAKE)
+QMAKE_EXTRA_TARGETS += dictcompiler
+OTHER_FILES += \
+    $${PWD}/tools/dictcompiler/dictcompiler.pro \
+    $${PWD}/tools/dictcompiler/main.cpp
+
 # Qt Creator linking
 ## set the QTC_SOURCE environment variable to override the setting here
 QTCREATOR_SOURCES = $$(QTC_SOURCE)
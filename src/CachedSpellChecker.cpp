@@ -0,0 +1,483 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "CachedSpellChecker.h"
+#include "SuggestionCache.h"
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QStandardPaths>
+#include <QVector>
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+// #define BENCH_TIME
+
+namespace {
+/*! \brief Number of shards that the cache is split into.
+ *
+ * Must be a power of 2 since the shard is selected using the lower bits
+ * of the hash of the word. */
+const int NUM_SHARDS = 16;
+/*! \brief Maximum number of words cached per shard.
+ *
+ * This is a safety net against unbounded growth. If a shard is full it is
+ * cleared and starts filling up again with the words currently in use. */
+const int MAX_WORDS_PER_SHARD = 1 << 16;
+/*! \brief Minimum number of pending verdicts before a shard publishes them.
+ *
+ * A shard also waits for a quarter of the size of its snapshot, since
+ * publishing copies the snapshot. */
+const int MIN_PENDING_PER_SHARD = 64;
+/*! \brief Maximum number of misspelled words to keep suggestions for. */
+const int MAX_SUGGESTION_WORDS = 20000;
+
+using Verdicts    = QHash<QString, bool>;
+using VerdictsPtr = std::shared_ptr<const Verdicts>;
+
+/*! \brief Source of the versions of the snapshots.
+ *
+ * The versions are unique over all shards of all caches, thus a thread can
+ * compare the version of its reference to the version of a shard without
+ * knowing which cache the reference came from. */
+std::atomic<quint64> g_nextVersion { 1 };
+
+/*! \brief Snapshots that a thread used last, one for each shard. */
+struct ReaderSnapshots {
+  std::array<VerdictsPtr, NUM_SHARDS> snapshots;
+  std::array<quint64, NUM_SHARDS> versions {};
+};
+thread_local ReaderSnapshots t_readerSnapshots;
+
+/*! \brief Get the file that the suggestions are saved to between sessions. */
+QString suggestionsCacheFile()
+{
+  return QStandardPaths::writableLocation( QStandardPaths::CacheLocation )
+         + QLatin1String( "/SpellChecker/suggestions.cache" );
+}
+
+/*! \brief Remove the trailing periods from the word.
+ *
+ * Words are checked with and without a trailing period, and the checker
+ * treats both forms the same when it comes to added words. */
+QStringRef withoutTrailingPeriods( const QString& word )
+{
+  int length = word.length();
+  while( ( length > 0 )
+         && ( word.at( length - 1 ) == QLatin1Char( '.' ) ) ) {
+    --length;
+  }
+  return word.leftRef( length );
+}
+} // namespace
+
+class SpellChecker::CachedSpellCheckerPrivate
+{
+public:
+  /*! \brief One shard of the cache. */
+  struct Shard {
+    /*! Published verdicts, never changed once published. Only accessed
+     *  with the atomic functions for shared pointers. */
+    VerdictsPtr snapshot;
+    std::atomic<quint64> version { 0 };    /*!< Version of the snapshot. */
+    std::atomic<quint64> generation { 0 }; /*!< Incremented each time results are invalidated. */
+    QMutex mutex;                          /*!< Protects the pending verdicts and publishing. */
+    Verdicts pending;                      /*!< Verdicts that are not published yet. */
+    mutable std::atomic<quint64> hits { 0 };
+    mutable std::atomic<quint64> misses { 0 };
+  };
+
+  std::unique_ptr<ISpellChecker> spellChecker;
+  std::array<Shard, NUM_SHARDS> shards;
+  SuggestionCache suggestions;
+  bool persistentSuggestions;
+
+  CachedSpellCheckerPrivate( std::unique_ptr<ISpellChecker> checker )
+    : spellChecker( std::move( checker ) )
+    , suggestions( MAX_SUGGESTION_WORDS )
+    , persistentSuggestions( false )
+  {
+    for( Shard& shard: shards ) {
+      publish( shard, std::make_shared<const Verdicts>() );
+    }
+  }
+
+  static int shardIndex( const QString& word )
+  {
+    return int( qHash( word ) & ( NUM_SHARDS - 1 ) );
+  }
+
+  /*! \brief Find the verdict of the word without taking a lock.
+   *
+   * The snapshot that the thread used before is reused if the shard did
+   * not publish a new one since.
+   * \return True if the word is in the published verdicts. */
+  bool findPublished( int shardIdx, const QString& word, bool& mistake ) const
+  {
+    const Shard& shard      = shards[shardIdx];
+    ReaderSnapshots& reader = t_readerSnapshots;
+    const quint64 version   = shard.version.load( std::memory_order_acquire );
+    if( reader.versions[shardIdx] != version ) {
+      /* The snapshot is at least as new as the version. If it is newer, it
+       * is loaded again on the next lookup, which is harmless. */
+      reader.snapshots[shardIdx] = std::atomic_load( &shard.snapshot );
+      reader.versions[shardIdx]  = version;
+    }
+    const Verdicts& verdicts      = *reader.snapshots[shardIdx];
+    Verdicts::const_iterator iter = verdicts.constFind( word );
+    if( iter == verdicts.constEnd() ) {
+      return false;
+    }
+    mistake = iter.value();
+    return true;
+  }
+
+  /*! \brief Find the verdict of the word in the published and pending verdicts.
+   *
+   * The hits and misses of the shard are counted.
+   * \return True if the word is in the cache. */
+  bool find( int shardIdx, const QString& word, bool& mistake )
+  {
+    Shard& shard = shards[shardIdx];
+    bool found   = findPublished( shardIdx, word, mistake );
+    if( found == false ) {
+      /* Not published yet, the verdict might still be pending. Misses are
+       * followed by a call to the wrapped checker, which is a lot slower
+       * than taking the lock. */
+      QMutexLocker lock( &shard.mutex );
+      Verdicts::const_iterator iter = shard.pending.constFind( word );
+      found = ( iter != shard.pending.constEnd() );
+      if( found == true ) {
+        mistake = iter.value();
+      }
+    }
+    if( found == true ) {
+      shard.hits.fetch_add( 1, std::memory_order_relaxed );
+    } else {
+      shard.misses.fetch_add( 1, std::memory_order_relaxed );
+    }
+    return found;
+  }
+
+  /*! \brief Add the verdict of the word, checked while the shard was at the \a generation.
+   *
+   * If the results were invalidated while the word was checked, the verdict
+   * might already be outdated and it is not added. */
+  void insert( int shardIdx, const QString& word, bool mistake, quint64 generation )
+  {
+    Shard& shard = shards[shardIdx];
+    QMutexLocker lock( &shard.mutex );
+    if( shard.generation.load( std::memory_order_relaxed ) != generation ) {
+      return;
+    }
+    shard.pending.insert( word, mistake );
+    const VerdictsPtr current = std::atomic_load( &shard.snapshot );
+    if( shard.pending.size() < qMax( MIN_PENDING_PER_SHARD, current->size() / 4 ) ) {
+      return;
+    }
+    if( current->size() + shard.pending.size() > MAX_WORDS_PER_SHARD ) {
+      /* Safety net against unbounded growth, start again with the words
+       * that are currently in use. */
+      publish( shard, std::make_shared<const Verdicts>( shard.pending ) );
+    } else {
+      std::shared_ptr<Verdicts> next = std::make_shared<Verdicts>( *current );
+      for( Verdicts::const_iterator iter = shard.pending.constBegin(); iter != shard.pending.constEnd(); ++iter ) {
+        next->insert( iter.key(), iter.value() );
+      }
+      publish( shard, std::move( next ) );
+    }
+    shard.pending.clear();
+  }
+
+  /*! \brief Replace the snapshot of the shard.
+   *
+   * The mutex of the shard must be locked, except from the constructor. */
+  static void publish( Shard& shard, VerdictsPtr snapshot )
+  {
+    std::atomic_store( &shard.snapshot, std::move( snapshot ) );
+    shard.version.store( g_nextVersion.fetch_add( 1, std::memory_order_relaxed ), std::memory_order_release );
+  }
+};
+// --------------------------------------------------
+// --------------------------------------------------
+// --------------------------------------------------
+
+using namespace SpellChecker;
+
+CachedSpellChecker::CachedSpellChecker( std::unique_ptr<ISpellChecker> spellChecker )
+  : ISpellChecker()
+  , d( new CachedSpellCheckerPrivate( std::move( spellChecker ) ) )
+{
+  Q_ASSERT( d->spellChecker != nullptr );
+  connect( d->spellChecker.get(), &ISpellChecker::dictionaryUpdated, this, &CachedSpellChecker::clear );
+  connect( d->spellChecker.get(), &ISpellChecker::dictionaryUpdated, this, &ISpellChecker::dictionaryUpdated );
+  connect( d->spellChecker.get(), &ISpellChecker::ready,             this, &ISpellChecker::ready );
+}
+// --------------------------------------------------
+
+CachedSpellChecker::~CachedSpellChecker()
+{
+#ifdef BENCH_TIME
+  qDebug() << "CachedSpellChecker:"
+           << "\n  - hits  : " << hits()
+           << "\n  - misses: " << misses();
+#endif /* BENCH_TIME */
+  if( d->persistentSuggestions == true ) {
+    d->suggestions.save( suggestionsCacheFile() );
+  }
+  delete d;
+}
+// --------------------------------------------------
+
+QString CachedSpellChecker::name() const
+{
+  return d->spellChecker->name();
+}
+// --------------------------------------------------
+
+bool CachedSpellChecker::isSpellingMistake( const QString& word ) const
+{
+  /* A checker only becomes ready once, thus if it was not ready before the
+   * lookup its result must not be cached. */
+  if( d->spellChecker->isReady() == false ) {
+    return d->spellChecker->isSpellingMistake( word );
+  }
+  const int shardIdx       = CachedSpellCheckerPrivate::shardIndex( word );
+  const quint64 generation = d->shards[shardIdx].generation.load( std::memory_order_acquire );
+  bool mistake             = false;
+  if( d->find( shardIdx, word, mistake ) == true ) {
+    return mistake;
+  }
+  /* Check the word without holding a lock, the wrapped checker is the
+   * slow part and other threads must be able to use the shard while
+   * this is happening. If another thread checks the same word at the
+   * same time, they will both insert the same result. */
+  mistake = d->spellChecker->isSpellingMistake( word );
+  d->insert( shardIdx, word, mistake, generation );
+  return mistake;
+}
+// --------------------------------------------------
+
+QBitArray CachedSpellChecker::areSpellingMistakes( const QStringList& words ) const
+{
+  if( d->spellChecker->isReady() == false ) {
+    return d->spellChecker->areSpellingMistakes( words );
+  }
+  QBitArray mistakes( words.size() );
+  /* Look up all words in the cache and collect the words that are not in
+   * the cache, these are then checked as a single batch by the wrapped
+   * checker. */
+  QStringList uncachedWords;
+  QVector<int> uncachedIndexes;
+  std::array<quint64, NUM_SHARDS> generations;
+  for( int shardIdx = 0; shardIdx < NUM_SHARDS; ++shardIdx ) {
+    generations[shardIdx] = d->shards[shardIdx].generation.load( std::memory_order_acquire );
+  }
+  for( int index = 0; index < words.size(); ++index ) {
+    const QString& word = words.at( index );
+    bool mistake        = false;
+    if( d->find( CachedSpellCheckerPrivate::shardIndex( word ), word, mistake ) == true ) {
+      mistakes.setBit( index, mistake );
+    } else {
+      uncachedWords.append( word );
+      uncachedIndexes.append( index );
+    }
+  }
+  if( uncachedWords.isEmpty() == true ) {
+    return mistakes;
+  }
+
+  const QBitArray uncachedMistakes = d->spellChecker->areSpellingMistakes( uncachedWords );
+  for( int index = 0; index < uncachedWords.size(); ++index ) {
+    const QString& word = uncachedWords.at( index );
+    const bool mistake  = uncachedMistakes.testBit( index );
+    const int shardIdx  = CachedSpellCheckerPrivate::shardIndex( word );
+    mistakes.setBit( uncachedIndexes.at( index ), mistake );
+    d->insert( shardIdx, word, mistake, generations[shardIdx] );
+  }
+  return mistakes;
+}
+// --------------------------------------------------
+
+void CachedSpellChecker::getSuggestionsForWord( const QString& word, QStringList& suggestions ) const
+{
+  const quint64 generation = d->suggestions.generation();
+  const QString dictionary = d->spellChecker->dictionaryIdentity();
+  if( dictionary.isEmpty() == true ) {
+    /* Not ready, suggestions without a dictionary are not cached. */
+    d->spellChecker->getSuggestionsForWord( word, suggestions );
+    return;
+  }
+  if( d->suggestions.find( dictionary, word, suggestions ) == true ) {
+    return;
+  }
+  d->spellChecker->getSuggestionsForWord( word, suggestions );
+  d->suggestions.insert( generation, dictionary, word, suggestions );
+}
+// --------------------------------------------------
+
+bool CachedSpellChecker::addWord( const QString& word )
+{
+  const bool added = d->spellChecker->addWord( word );
+  if( added == true ) {
+    invalidateWord( word );
+    d->suggestions.clear();
+  }
+  return added;
+}
+// --------------------------------------------------
+
+bool CachedSpellChecker::ignoreWord( const QString& word )
+{
+  const bool ignored = d->spellChecker->ignoreWord( word );
+  if( ignored == true ) {
+    invalidateWord( word );
+    d->suggestions.clear();
+  }
+  return ignored;
+}
+// --------------------------------------------------
+
+QWidget* CachedSpellChecker::optionsWidget()
+{
+  return d->spellChecker->optionsWidget();
+}
+// --------------------------------------------------
+
+QString CachedSpellChecker::dictionaryIdentity() const
+{
+  return d->spellChecker->dictionaryIdentity();
+}
+// --------------------------------------------------
+
+bool CachedSpellChecker::isReady() const
+{
+  return d->spellChecker->isReady();
+}
+// --------------------------------------------------
+
+QStringList CachedSpellChecker::knownWords() const
+{
+  return d->spellChecker->knownWords();
+}
+// --------------------------------------------------
+
+void CachedSpellChecker::setPersistentSuggestions( bool persistent )
+{
+  if( d->persistentSuggestions == persistent ) {
+    return;
+  }
+  d->persistentSuggestions = persistent;
+  if( persistent == true ) {
+    d->suggestions.load( suggestionsCacheFile() );
+  } else {
+    QFile::remove( suggestionsCacheFile() );
+  }
+}
+// --------------------------------------------------
+
+ISpellChecker* CachedSpellChecker::spellChecker() const
+{
+  return d->spellChecker.get();
+}
+// --------------------------------------------------
+
+quint64 CachedSpellChecker::hits() const
+{
+  quint64 total = 0;
+  for( const CachedSpellCheckerPrivate::Shard& shard: d->shards ) {
+    total += shard.hits.load( std::memory_order_relaxed );
+  }
+  return total;
+}
+// --------------------------------------------------
+
+quint64 CachedSpellChecker::misses() const
+{
+  quint64 total = 0;
+  for( const CachedSpellCheckerPrivate::Shard& shard: d->shards ) {
+    total += shard.misses.load( std::memory_order_relaxed );
+  }
+  return total;
+}
+// --------------------------------------------------
+
+void CachedSpellChecker::clear()
+{
+  for( CachedSpellCheckerPrivate::Shard& shard: d->shards ) {
+    QMutexLocker lock( &shard.mutex );
+    shard.pending.clear();
+    shard.generation.fetch_add( 1, std::memory_order_release );
+    CachedSpellCheckerPrivate::publish( shard, std::make_shared<const Verdicts>() );
+  }
+  /* The dictionary or the user dictionary changed, the suggestions might
+   * be different now. */
+  d->suggestions.clear();
+}
+// --------------------------------------------------
+
+void CachedSpellChecker::invalidateWord( const QString& word )
+{
+  /* Adding a word can only turn mistakes into correct words. The checker
+   * also accepts other forms of an added word, like the capitalised form
+   * or the word followed by a period. All mistakes that match the word
+   * while ignoring the case and trailing periods are removed, these forms
+   * end up in different shards thus all shards must be checked. Adding
+   * words is rare compared to checking words so this is acceptable. */
+  const QStringRef addedWord = withoutTrailingPeriods( word );
+  auto isAffected            = [&addedWord]( Verdicts::const_iterator iter ) {
+    return ( iter.value() == true )
+           && ( withoutTrailingPeriods( iter.key() ).compare( addedWord, Qt::CaseInsensitive ) == 0 );
+  };
+  for( CachedSpellCheckerPrivate::Shard& shard: d->shards ) {
+    QMutexLocker lock( &shard.mutex );
+    shard.generation.fetch_add( 1, std::memory_order_release );
+    Verdicts::iterator pendingIter = shard.pending.begin();
+    while( pendingIter != shard.pending.end() ) {
+      if( isAffected( pendingIter ) == true ) {
+        pendingIter = shard.pending.erase( pendingIter );
+      } else {
+        ++pendingIter;
+      }
+    }
+    /* The snapshot can not be changed, a copy without the affected
+     * mistakes is published if it has any. */
+    const VerdictsPtr current = std::atomic_load( &shard.snapshot );
+    bool affected             = false;
+    for( Verdicts::const_iterator iter = current->constBegin(); ( iter != current->constEnd() ) && ( affected == false ); ++iter ) {
+      affected = isAffected( iter );
+    }
+    if( affected == false ) {
+      continue;
+    }
+    std::shared_ptr<Verdicts> next = std::make_shared<Verdicts>();
+    next->reserve( current->size() );
+    for( Verdicts::const_iterator iter = current->constBegin(); iter != current->constEnd(); ++iter ) {
+      if( isAffected( iter ) == false ) {
+        next->insert( iter.key(), iter.value() );
+      }
+    }
+    CachedSpellCheckerPrivate::publish( shard, std::move( next ) );
+  }
+}
+// --------------------------------------------------
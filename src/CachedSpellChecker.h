@@ -0,0 +1,109 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include "ISpellChecker.h"
+
+#include <memory>
+
+namespace SpellChecker {
+
+class CachedSpellCheckerPrivate;
+/*! \brief The CachedSpellChecker class
+ *
+ * Decorator around an ISpellChecker that caches the result of
+ * isSpellingMistake() for every word that gets checked. The same words get
+ * checked many times over for a project, and most of the time the word is
+ * already in the cache, avoiding the call to the wrapped checker.
+ *
+ * The cache is split into shards. The verdicts of a shard are published as
+ * an immutable snapshot behind an atomic pointer, lookups do not take a lock.
+ * Each thread keeps a reference to the snapshot that it last used for every
+ * shard and only loads the pointer again when the version of the shard
+ * changed, thus the common lookup is an atomic load of the version and a
+ * hash lookup. New verdicts are first collected in a pending list of the
+ * shard, protected by a mutex, that is only searched if the word is not in
+ * the snapshot. Once enough verdicts are pending, a new snapshot is
+ * published with them. The pending list grows with the snapshot so that
+ * the copies made for publishing stay linear in the number of verdicts.
+ *
+ * Results are invalidated when they can change: Adding or ignoring a word
+ * removes the cached mistakes that could now be correct, and the complete
+ * cache is cleared when the wrapped checker emits dictionaryUpdated().
+ * The words of the dictionary are also used to make suggestions, thus the
+ * suggestions are cleared for every change to the words, including the
+ * words added by addWord() and ignoreWord(). Nothing is cached while the
+ * wrapped checker is not ready, its results are not valid yet.
+ *
+ * Suggestions for misspelled words are kept in a SuggestionCache that is
+ * shared between all threads, keyed on the word and the identity of the
+ * dictionary. The least recently used words are removed when the cache is
+ * full. The suggestions can be kept between sessions using
+ * setPersistentSuggestions().
+ *
+ * All other functions are forwarded to the wrapped checker.
+ */
+class CachedSpellChecker
+  : public ISpellChecker
+{
+  Q_OBJECT
+public:
+  /*! \brief Construct the cache around the \a spellChecker.
+   *
+   * The cache takes ownership of the supplied spell checker. */
+  CachedSpellChecker( std::unique_ptr<ISpellChecker> spellChecker );
+  ~CachedSpellChecker() Q_DECL_OVERRIDE;
+
+  QString name() const Q_DECL_OVERRIDE;
+  bool isSpellingMistake( const QString& word ) const Q_DECL_OVERRIDE;
+  QBitArray areSpellingMistakes( const QStringList& words ) const Q_DECL_OVERRIDE;
+  void getSuggestionsForWord( const QString& word, QStringList& suggestions ) const Q_DECL_OVERRIDE;
+  bool addWord( const QString& word ) Q_DECL_OVERRIDE;
+  bool ignoreWord( const QString& word ) Q_DECL_OVERRIDE;
+  QWidget* optionsWidget() Q_DECL_OVERRIDE;
+  QString dictionaryIdentity() const Q_DECL_OVERRIDE;
+  bool isReady() const Q_DECL_OVERRIDE;
+  QStringList knownWords() const Q_DECL_OVERRIDE;
+
+  /*! \brief Keep the cached suggestions between sessions.
+   *
+   * If enabled, the suggestions are loaded from the cache file now, and
+   * saved to the cache file when the object gets destroyed.
+   * \param[in] persistent True to load and save the suggestions. */
+  void setPersistentSuggestions( bool persistent );
+  /*! \brief Get the wrapped spell checker. */
+  ISpellChecker* spellChecker() const;
+  /*! \brief Number of lookups answered by the cache. */
+  quint64 hits() const;
+  /*! \brief Number of lookups that had to go to the wrapped spell checker. */
+  quint64 misses() const;
+
+public slots:
+  /*! \brief Remove all cached results and suggestions. */
+  void clear();
+
+private:
+  /*! \brief Remove the cached mistakes that could be affected by adding the \a word. */
+  void invalidateWord( const QString& word );
+  CachedSpellCheckerPrivate* const d;
+};
+
+} // namespace SpellChecker
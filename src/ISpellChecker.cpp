@@ -23,16 +23,95 @@
 
 // #define BENCH_TIME
 #ifdef BENCH_TIME
+#include <QDebug>
 #include <QElapsedTimer>
+#include <QMultiHash>
 #endif /* BENCH_TIME */
 
 using namespace SpellChecker;
 
-SpellCheckProcessor::SpellCheckProcessor( ISpellChecker* spellChecker, const QString& fileName, const WordList& wordList, const WordList& previousMistakes )
+namespace {
+/*! \brief Number of words that are checked in a single batch.
+ *
+ * Between batches the processor checks if it was cancelled and updates
+ * the progress. */
+const int CHECK_BATCH_SIZE = 256;
+
+#ifdef BENCH_TIME
+/*! \brief Compare the flat WordList against the QMultiHash that was used before.
+ *
+ * Both containers are built from the same words, every word is looked up
+ * by its text and all words are iterated. The times are logged in
+ * nanoseconds. */
+void benchWordList( const QString& fileName, const WordList& words )
+{
+  QElapsedTimer timer;
+  qint64 checksum = 0;
+
+  timer.start();
+  WordList flat;
+  flat.reserve( words.size() );
+  for( const Word& word: words ) {
+    flat.append( word );
+  }
+  const qint64 flatBuild = timer.nsecsElapsed();
+  timer.restart();
+  for( const Word& word: words ) {
+    checksum += ( flat.constFind( word.text ) != flat.constEnd() ) ? 1 : 0;
+  }
+  const qint64 flatLookup = timer.nsecsElapsed();
+  timer.restart();
+  for( const Word& word: qAsConst( flat ) ) {
+    checksum += word.columnNumber;
+  }
+  const qint64 flatIterate = timer.nsecsElapsed();
+
+  timer.restart();
+  QMultiHash<QString, Word> hash;
+  hash.reserve( words.size() );
+  for( const Word& word: words ) {
+    hash.insert( word.text, word );
+  }
+  const qint64 hashBuild = timer.nsecsElapsed();
+  timer.restart();
+  for( const Word& word: words ) {
+    checksum += ( hash.constFind( word.text ) != hash.constEnd() ) ? 1 : 0;
+  }
+  const qint64 hashLookup = timer.nsecsElapsed();
+  timer.restart();
+  for( const Word& word: qAsConst( hash ) ) {
+    checksum += word.columnNumber;
+  }
+  const qint64 hashIterate = timer.nsecsElapsed();
+
+  qDebug() << "WordList: " << fileName << "words:" << words.size()
+           << "\n  - build  : flat" << flatBuild << "hash" << hashBuild
+           << "\n  - lookup : flat" << flatLookup << "hash" << hashLookup
+           << "\n  - iterate: flat" << flatIterate << "hash" << hashIterate
+           << "\n  - check  :" << checksum;
+}
+// --------------------------------------------------
+#endif /* BENCH_TIME */
+} // namespace
+
+QBitArray ISpellChecker::areSpellingMistakes( const QStringList& words ) const
+{
+  QBitArray mistakes( words.size() );
+  for( int index = 0; index < words.size(); ++index ) {
+    if( isSpellingMistake( words.at( index ) ) == true ) {
+      mistakes.setBit( index );
+    }
+  }
+  return mistakes;
+}
+// --------------------------------------------------
+
+SpellCheckProcessor::SpellCheckProcessor( ISpellChecker* spellChecker, const QString& fileName, const WordList& wordList, const WordList& previousMistakes, bool fetchSuggestions )
   : d_spellChecker( spellChecker )
   , d_fileName( fileName )
   , d_wordList( wordList )
   , d_previousMistakes( previousMistakes )
+  , d_fetchSuggestions( fetchSuggestions )
 {}
 // --------------------------------------------------
 
@@ -46,45 +125,83 @@ void SpellCheckProcessor::process( QFutureInterface<WordList>& future )
   QElapsedTimer timer;
   timer.start();
 #endif /* BENCH_TIME */
+  future.setProgressRange( 0, d_wordList.count() + 1 );
+  const WordList misspelledWords = checkWords( d_spellChecker, d_wordList, d_previousMistakes, d_fetchSuggestions, future );
+#ifdef BENCH_TIME
+  qDebug() << "File: " << d_fileName
+           << "\n  - time : " << timer.elapsed()
+           << "\n  - count: " << misspelledWords.size();
+  benchWordList( d_fileName, d_wordList );
+#endif /* BENCH_TIME */
+
+  if( future.isCanceled() == true ) {
+    return;
+  }
+  future.reportResult( misspelledWords );
+}
+// --------------------------------------------------
+
+WordList SpellCheckProcessor::checkWords( ISpellChecker* spellChecker, const WordList& words, const WordList& previousMistakes, bool fetchSuggestions, QFutureInterfaceBase& future )
+{
   WordListConstIter misspelledIter;
   WordListConstIter prevMisspelledIter;
   Word misspelledWord;
   WordList misspelledWords;
-  WordList words             = d_wordList;
   WordListConstIter wordIter = words.constBegin();
-  bool spellingMistake;
-  future.setProgressRange( 0, words.count() + 1 );
-  while( wordIter != d_wordList.constEnd() ) {
-    /* Get the word at the current iterator position.
-     * After this is done, move the iterator to the next position and
-     * increment the progress value. This is done so that one can call
-     * 'continue' anywhere after this in the loop without having to worry
-     * about advancing the iterator since this will already be done and
-     * correct for the next iteration. */
-    misspelledWord = ( *wordIter );
-    ++wordIter;
-    future.setProgressValue( future.progressValue() + 1 );
+  QVector<const Word*> batch;
+  QStringList batchWords;
+  QStringList retryWords;
+  QVector<int> retryIndexes;
+  batch.reserve( CHECK_BATCH_SIZE );
+  batchWords.reserve( CHECK_BATCH_SIZE );
+  while( wordIter != words.constEnd() ) {
+    /* Collect the next batch of words and check all of them with a single
+     * call to the spell checker. */
+    batch.clear();
+    batchWords.clear();
+    while( ( wordIter != words.constEnd() )
+           && ( batch.size() < CHECK_BATCH_SIZE ) ) {
+      batch.append( &( *wordIter ) );
+      batchWords.append( ( *wordIter ).text );
+      ++wordIter;
+    }
+    future.setProgressValue( future.progressValue() + batch.size() );
     /* Check if the future was cancelled */
     if( future.isCanceled() == true ) {
-      return;
+      return {};
     }
-    spellingMistake = d_spellChecker->isSpellingMistake( misspelledWord.text );
+    QBitArray spellingMistakes = spellChecker->areSpellingMistakes( batchWords );
     /* Check to see if the char after the word is a period. If it is,
-     * add the period to the word an see if it passes the checker. */
-    if( ( spellingMistake == true )
-        && ( misspelledWord.charAfter == QLatin1Char( '.' ) ) ) {
-      /* Recheck the word with the period added */
-      spellingMistake = d_spellChecker->isSpellingMistake( misspelledWord.text + QLatin1Char( '.' ) );
+     * add the period to the word an see if it passes the checker. The
+     * words that must be checked again are also checked as a batch. */
+    retryWords.clear();
+    retryIndexes.clear();
+    for( int index = 0; index < batch.size(); ++index ) {
+      if( ( spellingMistakes.testBit( index ) == true )
+          && ( batch.at( index )->charAfter == QLatin1Char( '.' ) ) ) {
+        retryWords.append( batch.at( index )->text + QLatin1Char( '.' ) );
+        retryIndexes.append( index );
+      }
+    }
+    if( retryWords.isEmpty() == false ) {
+      const QBitArray retryMistakes = spellChecker->areSpellingMistakes( retryWords );
+      for( int index = 0; index < retryIndexes.size(); ++index ) {
+        spellingMistakes.setBit( retryIndexes.at( index ), retryMistakes.testBit( index ) );
+      }
     }
 
-    if( spellingMistake == true ) {
+    for( int index = 0; index < batch.size(); ++index ) {
+      if( spellingMistakes.testBit( index ) == false ) {
+        continue;
+      }
+      misspelledWord = *batch.at( index );
       /* The word is a spelling mistake, check if the word was a mistake
        * the previous time that this file was processed. If it was the
        * suggestions can be reused without having to get the suggestions
        * through the spell checker since this is slow compared to the rest
        * of the processing. */
-      prevMisspelledIter = d_previousMistakes.constFind( misspelledWord.text );
-      if( prevMisspelledIter != d_previousMistakes.constEnd() ) {
+      prevMisspelledIter = previousMistakes.constFind( misspelledWord.text );
+      if( prevMisspelledIter != previousMistakes.constEnd() ) {
         misspelledWord.suggestions = ( *prevMisspelledIter ).suggestions;
         misspelledWords.append( misspelledWord );
         continue;
@@ -104,27 +221,23 @@ void SpellCheckProcessor::process( QFutureInterface<WordList>& future )
         continue;
       }
 
+      if( fetchSuggestions == false ) {
+        /* Suggestions are looked up later, when the mistake is visible. */
+        misspelledWords.append( misspelledWord );
+        continue;
+      }
       /* Another checkpoint before we go into the SpellChecker to check for mistakes */
       if( future.isCanceled() == true ) {
-        return;
+        return {};
       }
       /* At this point the word is a mistake for the first time. It was neither
        * a mistake in the previous pass of the file nor did the word occur previously
        * in this file, use the spell checker to get the suggestions for the word. */
-      d_spellChecker->getSuggestionsForWord( misspelledWord.text, misspelledWord.suggestions );
+      spellChecker->getSuggestionsForWord( misspelledWord.text, misspelledWord.suggestions );
       /* Add the word to the local list of misspelled words. */
       misspelledWords.append( misspelledWord );
     }
   }
-#ifdef BENCH_TIME
-  qDebug() << "File: " << d_fileName
-           << "\n  - time : " << timer.elapsed()
-           << "\n  - count: " << misspelledWords.size();
-#endif /* BENCH_TIME */
-
-  if( future.isCanceled() == true ) {
-    return;
-  }
-  future.reportResult( misspelledWords );
+  return misspelledWords;
 }
 // --------------------------------------------------
@@ -22,6 +22,7 @@
 
 #include "Word.h"
 
+#include <QBitArray>
 #include <QFutureInterface>
 #include <QObject>
 #include <QSettings>
@@ -49,6 +50,17 @@ public:
    * \return True if the word is a spelling mistake.
    */
   virtual bool isSpellingMistake( const QString& word ) const = 0;
+  /*! \brief Query which of the given words are spelling mistakes.
+   *
+   * Batch version of isSpellingMistake() that checks all words in one call.
+   * Implementations should override this function if they can check a
+   * number of words more efficiently than one word at a time. The default
+   * implementation calls isSpellingMistake() for each word.
+   * \param[in] words Words that must be checked.
+   * \return Bit array with the same size as \a words. A bit is set if the
+   *          word at the same index is a spelling mistake.
+   */
+  virtual QBitArray areSpellingMistakes( const QStringList& words ) const;
   /*! \brief Get suggestions for a given word.
    * \param[in] word Misspelled word that suggestions for correct spellings
    *                  are required.
@@ -82,6 +94,59 @@ public:
    * \return Pointer to the options widget.
    */
   virtual QWidget* optionsWidget() = 0;
+  /*! \brief Get the identity of the dictionary that is used by the spell checker.
+   *
+   * The identity is used as part of the key when results of the spell checker
+   * get cached, also between sessions. It should change if the dictionary
+   * changes in a way that could give different suggestions. The default
+   * implementation uses the name of the spell checker.
+   * \return String that identifies the current dictionary.
+   */
+  virtual QString dictionaryIdentity() const
+  {
+    return name();
+  }
+  /*! \brief Query if the spell checker can check words.
+   *
+   * A spell checker that loads its dictionary in the background can not
+   * check words until the dictionary is loaded. Until then it must return
+   * false, and the results of isSpellingMistake(), getSuggestionsForWord()
+   * and dictionaryIdentity() must not be used or cached. The signal ready()
+   * is emitted once it can check words. The default implementation is always
+   * ready.
+   * \return True if the spell checker can check words. */
+  virtual bool isReady() const
+  {
+    return true;
+  }
+  /*! \brief Get the words that are spelled correctly as they are.
+   *
+   * Used by the KnownWordsSpellChecker to answer the common words without
+   * asking the spell checker. The list may leave out correct words, but must
+   * not contain words for which isSpellingMistake() returns true. Reading
+   * the words can be slow, this function gets called on a background thread
+   * and must be safe to call from any thread. The default implementation
+   * returns no words.
+   * \return Words known to be correct. */
+  virtual QStringList knownWords() const
+  {
+    return QStringList();
+  }
+
+signals:
+  /*! \brief Signal emitted when the results of the spell checker changed.
+   *
+   * Implementations must emit this signal when a word might get a different
+   * result from isSpellingMistake() than before, for example when the
+   * dictionary changed. This is not needed for words added with addWord() or
+   * ignoreWord() since callers of those functions know which word changed.
+   */
+  void dictionaryUpdated();
+  /*! \brief Signal emitted when a spell checker that was not ready becomes ready.
+   *
+   * This is not a change of the dictionary, nothing was checked with it
+   * before, see isReady(). */
+  void ready();
 };
 
 /*! \brief The SpellCheckProcessor class
@@ -115,16 +180,32 @@ public:
    * \param[in] fileName Name of the file that the given words to be checked belongs to.
    * \param[in] wordList Words that must be checked for possible spelling mistakes.
    * \param[in] previousMistakes List of words that were identified as spelling mistakes in
-   *      the previous processing run of the current file.*/
-  SpellCheckProcessor( ISpellChecker* spellChecker, const QString& fileName, const WordList& wordList, const WordList& previousMistakes );
+   *      the previous processing run of the current file.
+   * \param[in] fetchSuggestions If false, suggestions are not requested from the spell
+   *      checker. Misspelled words only get suggestions if they can be reused from
+   *      the \a previousMistakes or earlier mistakes in the same file. */
+  SpellCheckProcessor( ISpellChecker* spellChecker, const QString& fileName, const WordList& wordList, const WordList& previousMistakes, bool fetchSuggestions = true );
   ~SpellCheckProcessor();
   /*! Function that will run in the background/thread. */
   void process( QFutureInterface<WordList>& future );
+  /*! \brief Check the words for spelling mistakes.
+   *
+   * Does the work of process(), without a processor object, so that it can
+   * also be used by other background tasks, for example parsers that check
+   * the words that they extracted in the same task.
+   * \param[in] spellChecker Spell checker to use, must be thread safe.
+   * \param[in] words Words that must be checked.
+   * \param[in] previousMistakes Mistakes of the previous run, their suggestions are reused.
+   * \param[in] fetchSuggestions If suggestions must be requested for new mistakes.
+   * \param[in] future Future that is checked for cancellation and gets the progress.
+   * \return The misspelled words, empty if the future was cancelled. */
+  static WordList checkWords( ISpellChecker* spellChecker, const WordList& words, const WordList& previousMistakes, bool fetchSuggestions, QFutureInterfaceBase& future );
 protected:
   ISpellChecker* d_spellChecker;
   QString  d_fileName;
   WordList d_wordList;
   WordList d_previousMistakes;
+  bool d_fetchSuggestions;
 };
 
 } // namespace SpellChecker
@@ -0,0 +1,176 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "KnownWordsFilter.h"
+
+#include <cstring>
+
+namespace {
+/*! Number of bits in the Bloom filter for each word, with the number of
+ * hashes below this gives a false positive rate of about 1%. */
+const int BLOOM_BITS_PER_WORD = 10;
+const int BLOOM_HASHES        = 7;
+
+/*! \brief 64 bit hash of the UTF-16 data, FNV-1a with a final mix. */
+inline quint64 hashWord( const ushort* data, int size )
+{
+  quint64 hash = Q_UINT64_C( 14695981039346656037 );
+  for( int index = 0; index < size; ++index ) {
+    hash ^= data[index];
+    hash *= Q_UINT64_C( 1099511628211 );
+  }
+  /* Mix the bits, FNV-1a does not spread the last characters well over
+   * the high bits. */
+  hash ^= hash >> 33;
+  hash *= Q_UINT64_C( 0xff51afd7ed558ccd );
+  hash ^= hash >> 33;
+  return hash;
+}
+// --------------------------------------------------
+
+/*! \brief Smallest power of two that is not less than the value. */
+inline quint64 powerOfTwo( quint64 value )
+{
+  quint64 result = 1;
+  while( result < value ) {
+    result <<= 1;
+  }
+  return result;
+}
+// --------------------------------------------------
+} // namespace
+
+using namespace SpellChecker;
+
+KnownWordsFilter::KnownWordsFilter( const QStringList& words )
+  : d_bloomBitsMask( 0 )
+  , d_tableMask( 0 )
+  , d_size( 0 )
+{
+  if( words.isEmpty() == true ) {
+    return;
+  }
+  const quint64 bloomBits = powerOfTwo( quint64( words.size() ) * BLOOM_BITS_PER_WORD );
+  d_bloom.fill( 0, int( qMax<quint64>( 1, bloomBits / 64 ) ) );
+  d_bloomBitsMask = quint64( d_bloom.size() ) * 64 - 1;
+  /* Keep the load of the table below 75%. */
+  const quint64 tableSize = powerOfTwo( quint64( words.size() ) * 4 / 3 + 1 );
+  d_table.fill( 0, int( tableSize ) );
+  d_fingerprints.fill( 0, int( tableSize ) );
+  d_tableMask = quint32( tableSize - 1 );
+
+  for( const QString& word: words ) {
+    if( ( word.isEmpty() == true )
+        || ( word.size() > 0xFFFF ) ) {
+      /* The size of a word is stored in a single code unit. */
+      continue;
+    }
+    const ushort* data = word.utf16();
+    const int size     = word.size();
+    const quint64 hash = hashWord( data, size );
+    if( setContains( data, size, hash ) == true ) {
+      continue;
+    }
+    /* Add the word to the Bloom filter. */
+    const quint64 step = ( hash >> 32 ) | 1;
+    for( int index = 0; index < BLOOM_HASHES; ++index ) {
+      const quint64 bit = ( hash + index * step ) & d_bloomBitsMask;
+      d_bloom[int( bit >> 6 )] |= Q_UINT64_C( 1 ) << ( bit & 63 );
+    }
+    /* Add the word to the hash set. */
+    quint32 slot = quint32( hash ) & d_tableMask;
+    while( d_table.at( slot ) != 0 ) {
+      slot = ( slot + 1 ) & d_tableMask;
+    }
+    d_table[slot]        = quint32( d_words.size() ) + 1;
+    d_fingerprints[slot] = quint32( hash >> 32 );
+    d_words.append( ushort( size ) );
+    d_words.append( QVector<ushort>( data, data + size ) );
+    ++d_size;
+  }
+  d_words.squeeze();
+}
+// --------------------------------------------------
+
+KnownWordsFilter::~KnownWordsFilter()
+{}
+// --------------------------------------------------
+
+bool KnownWordsFilter::contains( const QString& word ) const
+{
+  if( ( d_size == 0 )
+      || ( word.isEmpty() == true )
+      || ( word.size() > 0xFFFF ) ) {
+    return false;
+  }
+  const ushort* data = word.utf16();
+  const int size     = word.size();
+  const quint64 hash = hashWord( data, size );
+  return ( bloomContains( hash ) == true )
+         && ( setContains( data, size, hash ) == true );
+}
+// --------------------------------------------------
+
+int KnownWordsFilter::size() const
+{
+  return d_size;
+}
+// --------------------------------------------------
+
+qint64 KnownWordsFilter::memoryUsage() const
+{
+  return qint64( sizeof( *this ) )
+         + qint64( d_bloom.capacity() ) * qint64( sizeof( quint64 ) )
+         + qint64( d_words.capacity() ) * qint64( sizeof( ushort ) )
+         + qint64( d_table.capacity() ) * qint64( sizeof( quint32 ) )
+         + qint64( d_fingerprints.capacity() ) * qint64( sizeof( quint32 ) );
+}
+// --------------------------------------------------
+
+bool KnownWordsFilter::bloomContains( quint64 hash ) const
+{
+  const quint64 step = ( hash >> 32 ) | 1;
+  for( int index = 0; index < BLOOM_HASHES; ++index ) {
+    const quint64 bit = ( hash + index * step ) & d_bloomBitsMask;
+    if( ( d_bloom.at( int( bit >> 6 ) ) & ( Q_UINT64_C( 1 ) << ( bit & 63 ) ) ) == 0 ) {
+      return false;
+    }
+  }
+  return true;
+}
+// --------------------------------------------------
+
+bool KnownWordsFilter::setContains( const ushort* data, int size, quint64 hash ) const
+{
+  const quint32 fingerprint = quint32( hash >> 32 );
+  quint32 slot              = quint32( hash ) & d_tableMask;
+  while( d_table.at( slot ) != 0 ) {
+    if( d_fingerprints.at( slot ) == fingerprint ) {
+      const ushort* stored = d_words.constData() + d_table.at( slot ) - 1;
+      if( ( stored[0] == size )
+          && ( std::memcmp( stored + 1, data, size_t( size ) * sizeof( ushort ) ) == 0 ) ) {
+        return true;
+      }
+    }
+    slot = ( slot + 1 ) & d_tableMask;
+  }
+  return false;
+}
+// --------------------------------------------------
@@ -0,0 +1,80 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace SpellChecker {
+
+/*! \brief The KnownWordsFilter class
+ *
+ * Compact set of words that are known to be spelled correctly, used in front
+ * of a spell checker to skip its full analysis of common words.
+ *
+ * A Bloom filter is tested first. If the word is not in the filter it is not
+ * known, and the spell checker must check the word. If it is in the filter,
+ * an exact lookup in a compact hash set confirms that the word is known,
+ * since the Bloom filter can report false positives.
+ *
+ * The hash set stores all words in a single UTF-16 buffer with an open
+ * addressing table of offsets, instead of a QString for every word, to keep
+ * the memory use low.
+ *
+ * The filter can not be changed after it is built, thus it is safe to use
+ * from multiple threads.
+ */
+class KnownWordsFilter
+{
+public:
+  /*! \brief Build the filter for the words.
+   *
+   * Empty words and duplicates are ignored. */
+  explicit KnownWordsFilter( const QStringList& words );
+  ~KnownWordsFilter();
+
+  /*! \brief Check if the word is known to be spelled correctly. */
+  bool contains( const QString& word ) const;
+  /*! \brief Number of words in the filter. */
+  int size() const;
+  /*! \brief Number of bytes used by the filter. */
+  qint64 memoryUsage() const;
+
+private:
+  Q_DISABLE_COPY( KnownWordsFilter )
+  bool bloomContains( quint64 hash ) const;
+  bool setContains( const ushort* data, int size, quint64 hash ) const;
+
+  /*! \brief Bits of the Bloom filter. */
+  QVector<quint64> d_bloom;
+  quint64 d_bloomBitsMask;
+  /*! \brief Words, each stored as its size followed by its UTF-16 data. */
+  QVector<ushort> d_words;
+  /*! \brief Open addressing table, offset + 1 into d_words, 0 if empty. */
+  QVector<quint32> d_table;
+  /*! \brief Part of the hash of the word in the table at the same index. */
+  QVector<quint32> d_fingerprints;
+  quint32 d_tableMask;
+  int d_size;
+};
+
+} // namespace SpellChecker
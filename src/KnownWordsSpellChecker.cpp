@@ -0,0 +1,275 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "KnownWordsSpellChecker.h"
+#include "KnownWordsFilter.h"
+
+#include <utils/runextensions.h>
+
+#include <QFutureWatcher>
+
+#include <atomic>
+
+// #define BENCH_TIME
+#ifdef BENCH_TIME
+#include <QDebug>
+#include <QElapsedTimer>
+#endif /* BENCH_TIME */
+
+namespace SpellChecker {
+
+using KnownWordsFilterPtr = std::shared_ptr<const KnownWordsFilter>;
+
+class KnownWordsSpellCheckerPrivate
+{
+public:
+  std::unique_ptr<ISpellChecker> spellChecker;
+  /*! \brief Filter of the current dictionary.
+   *
+   * The pointer is only read and written using the atomic functions for
+   * shared pointers. It is null while the filter is being built. */
+  KnownWordsFilterPtr filter;
+  /*! \brief Incremented for every build, results of older builds are dropped. */
+  quint64 buildGeneration = 0;
+  /*! \brief Last started build, waited for before the wrapped checker is deleted. */
+  QFuture<KnownWordsFilterPtr> build;
+#ifdef BENCH_TIME
+  mutable std::atomic<quint64> lookups { 0 };
+  mutable std::atomic<quint64> knownWordHits { 0 };
+  mutable std::atomic<qint64> filterNsecs { 0 };
+  mutable std::atomic<qint64> checkerNsecs { 0 };
+  mutable std::atomic<quint64> checkerWords { 0 };
+#endif /* BENCH_TIME */
+
+  KnownWordsSpellCheckerPrivate( std::unique_ptr<ISpellChecker> checker )
+    : spellChecker( std::move( checker ) )
+  {}
+
+  KnownWordsFilterPtr currentFilter() const
+  {
+    return std::atomic_load( &filter );
+  }
+};
+
+} // namespace SpellChecker
+// --------------------------------------------------
+// --------------------------------------------------
+// --------------------------------------------------
+
+using namespace SpellChecker;
+
+KnownWordsSpellChecker::KnownWordsSpellChecker( std::unique_ptr<ISpellChecker> spellChecker )
+  : ISpellChecker()
+  , d( new KnownWordsSpellCheckerPrivate( std::move( spellChecker ) ) )
+{
+  Q_ASSERT( d->spellChecker != nullptr );
+  /* The filter is dropped before the signals are passed on, so that the
+   * words that get checked again do not use the old filter. */
+  connect( d->spellChecker.get(), &ISpellChecker::dictionaryUpdated, this, &KnownWordsSpellChecker::rebuildFilter );
+  connect( d->spellChecker.get(), &ISpellChecker::ready,             this, &KnownWordsSpellChecker::rebuildFilter );
+  connect( d->spellChecker.get(), &ISpellChecker::dictionaryUpdated, this, &ISpellChecker::dictionaryUpdated );
+  connect( d->spellChecker.get(), &ISpellChecker::ready,             this, &ISpellChecker::ready );
+  if( d->spellChecker->isReady() == true ) {
+    rebuildFilter();
+  }
+}
+// --------------------------------------------------
+
+KnownWordsSpellChecker::~KnownWordsSpellChecker()
+{
+#ifdef BENCH_TIME
+  const quint64 lookups      = d->lookups.load();
+  const quint64 checkerWords = d->checkerWords.load();
+  qDebug() << "KnownWordsSpellChecker:"
+           << "\n  - lookups              : " << lookups
+           << "\n  - known words          : " << d->knownWordHits.load()
+           << "\n  - filter (ns/word)     : " << ( ( lookups > 0 ) ? d->filterNsecs.load() / qint64( lookups ) : 0 )
+           << "\n  - wrapped checker words: " << checkerWords
+           << "\n  - wrapped (ns/word)    : " << ( ( checkerWords > 0 ) ? d->checkerNsecs.load() / qint64( checkerWords ) : 0 );
+#endif /* BENCH_TIME */
+  /* A running build uses the wrapped checker. */
+  d->build.waitForFinished();
+  delete d;
+}
+// --------------------------------------------------
+
+QString KnownWordsSpellChecker::name() const
+{
+  return d->spellChecker->name();
+}
+// --------------------------------------------------
+
+bool KnownWordsSpellChecker::isSpellingMistake( const QString& word ) const
+{
+  const KnownWordsFilterPtr filter = d->currentFilter();
+#ifdef BENCH_TIME
+  QElapsedTimer timer;
+  timer.start();
+  ++d->lookups;
+#endif /* BENCH_TIME */
+  if( ( filter != nullptr )
+      && ( filter->contains( word ) == true ) ) {
+#ifdef BENCH_TIME
+    ++d->knownWordHits;
+    d->filterNsecs += timer.nsecsElapsed();
+#endif /* BENCH_TIME */
+    return false;
+  }
+#ifdef BENCH_TIME
+  d->filterNsecs += timer.nsecsElapsed();
+  timer.restart();
+  const bool mistake = d->spellChecker->isSpellingMistake( word );
+  d->checkerNsecs += timer.nsecsElapsed();
+  ++d->checkerWords;
+  return mistake;
+#else
+  return d->spellChecker->isSpellingMistake( word );
+#endif /* BENCH_TIME */
+}
+// --------------------------------------------------
+
+QBitArray KnownWordsSpellChecker::areSpellingMistakes( const QStringList& words ) const
+{
+  const KnownWordsFilterPtr filter = d->currentFilter();
+  if( filter == nullptr ) {
+    return d->spellChecker->areSpellingMistakes( words );
+  }
+#ifdef BENCH_TIME
+  QElapsedTimer timer;
+  timer.start();
+  d->lookups += quint64( words.size() );
+#endif /* BENCH_TIME */
+  /* Only the words that are not known are passed on, as a single batch. */
+  QBitArray mistakes( words.size() );
+  QStringList unknownWords;
+  QVector<int> unknownIndexes;
+  for( int index = 0; index < words.size(); ++index ) {
+    if( filter->contains( words.at( index ) ) == false ) {
+      unknownWords.append( words.at( index ) );
+      unknownIndexes.append( index );
+    }
+  }
+#ifdef BENCH_TIME
+  d->knownWordHits += quint64( words.size() - unknownWords.size() );
+  d->filterNsecs   += timer.nsecsElapsed();
+  timer.restart();
+#endif /* BENCH_TIME */
+  if( unknownWords.isEmpty() == true ) {
+    return mistakes;
+  }
+  const QBitArray unknownMistakes = d->spellChecker->areSpellingMistakes( unknownWords );
+#ifdef BENCH_TIME
+  d->checkerNsecs += timer.nsecsElapsed();
+  d->checkerWords += quint64( unknownWords.size() );
+#endif /* BENCH_TIME */
+  for( int index = 0; index < unknownIndexes.size(); ++index ) {
+    mistakes.setBit( unknownIndexes.at( index ), unknownMistakes.testBit( index ) );
+  }
+  return mistakes;
+}
+// --------------------------------------------------
+
+void KnownWordsSpellChecker::getSuggestionsForWord( const QString& word, QStringList& suggestions ) const
+{
+  d->spellChecker->getSuggestionsForWord( word, suggestions );
+}
+// --------------------------------------------------
+
+bool KnownWordsSpellChecker::addWord( const QString& word )
+{
+  return d->spellChecker->addWord( word );
+}
+// --------------------------------------------------
+
+bool KnownWordsSpellChecker::ignoreWord( const QString& word )
+{
+  return d->spellChecker->ignoreWord( word );
+}
+// --------------------------------------------------
+
+QWidget* KnownWordsSpellChecker::optionsWidget()
+{
+  return d->spellChecker->optionsWidget();
+}
+// --------------------------------------------------
+
+QString KnownWordsSpellChecker::dictionaryIdentity() const
+{
+  return d->spellChecker->dictionaryIdentity();
+}
+// --------------------------------------------------
+
+bool KnownWordsSpellChecker::isReady() const
+{
+  return d->spellChecker->isReady();
+}
+// --------------------------------------------------
+
+QStringList KnownWordsSpellChecker::knownWords() const
+{
+  return d->spellChecker->knownWords();
+}
+// --------------------------------------------------
+
+ISpellChecker* KnownWordsSpellChecker::spellChecker() const
+{
+  return d->spellChecker.get();
+}
+// --------------------------------------------------
+
+void KnownWordsSpellChecker::rebuildFilter()
+{
+  std::atomic_store( &d->filter, KnownWordsFilterPtr() );
+  const quint64 generation = ++d->buildGeneration;
+  ISpellChecker* spellChecker = d->spellChecker.get();
+  QFutureWatcher<KnownWordsFilterPtr>* watcher = new QFutureWatcher<KnownWordsFilterPtr>( this );
+  connect( watcher, &QFutureWatcher<KnownWordsFilterPtr>::finished, this, [this, watcher, generation]() {
+    watcher->deleteLater();
+    if( ( watcher->isCanceled() == true )
+        || ( watcher->future().resultCount() == 0 )
+        || ( generation != d->buildGeneration ) ) {
+      /* A newer build was started in the mean time. */
+      return;
+    }
+    std::atomic_store( &d->filter, watcher->result() );
+  } );
+  /* Reading the words can take a while, the wrapped checker must allow
+   * knownWords() to be called from another thread. */
+  d->build = Utils::runAsync( [spellChecker]( QFutureInterface<KnownWordsFilterPtr>& futureInterface ) {
+#ifdef BENCH_TIME
+    QElapsedTimer timer;
+    timer.start();
+#endif /* BENCH_TIME */
+    const QStringList words = spellChecker->knownWords();
+    if( words.isEmpty() == true ) {
+      return;
+    }
+    KnownWordsFilterPtr filter = std::make_shared<const KnownWordsFilter>( words );
+#ifdef BENCH_TIME
+    qDebug() << "KnownWordsSpellChecker: Built filter"
+             << "\n  - words         : " << filter->size()
+             << "\n  - memory (bytes): " << filter->memoryUsage()
+             << "\n  - time (ms)     : " << timer.elapsed();
+#endif /* BENCH_TIME */
+    futureInterface.reportResult( filter );
+  } );
+  watcher->setFuture( d->build );
+}
+// --------------------------------------------------
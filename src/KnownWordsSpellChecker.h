@@ -0,0 +1,84 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include "ISpellChecker.h"
+
+#include <memory>
+
+namespace SpellChecker {
+
+class KnownWordsSpellCheckerPrivate;
+/*! \brief The KnownWordsSpellChecker class
+ *
+ * Decorator around an ISpellChecker that answers the words that the wrapped
+ * checker accepts as they are from a KnownWordsFilter. Most words of a
+ * project are spelled correctly, and most of those are plain words of the
+ * dictionary, looking them up in the filter is a lot cheaper than the full
+ * analysis of the wrapped checker. Words that are not in the filter are
+ * checked by the wrapped checker.
+ *
+ * The filter is built from ISpellChecker::knownWords() on a background
+ * thread when the wrapped checker becomes ready and every time that it emits
+ * dictionaryUpdated(). The words of the dictionary can be removed, thus the
+ * old filter is dropped as soon as the dictionary changes and all words are
+ * checked by the wrapped checker until the new filter is built. Words added
+ * with addWord() and ignoreWord() are not added to the filter, the wrapped
+ * checker accepts them.
+ *
+ * With BENCH_TIME defined the number of lookups, the words found in the
+ * filter and the time spent in the filter and in the wrapped checker are
+ * logged when the object gets destroyed.
+ *
+ * All other functions are forwarded to the wrapped checker.
+ */
+class KnownWordsSpellChecker
+  : public ISpellChecker
+{
+  Q_OBJECT
+public:
+  /*! \brief Construct the filter around the \a spellChecker.
+   *
+   * The filter takes ownership of the supplied spell checker. */
+  KnownWordsSpellChecker( std::unique_ptr<ISpellChecker> spellChecker );
+  ~KnownWordsSpellChecker() Q_DECL_OVERRIDE;
+
+  QString name() const Q_DECL_OVERRIDE;
+  bool isSpellingMistake( const QString& word ) const Q_DECL_OVERRIDE;
+  QBitArray areSpellingMistakes( const QStringList& words ) const Q_DECL_OVERRIDE;
+  void getSuggestionsForWord( const QString& word, QStringList& suggestions ) const Q_DECL_OVERRIDE;
+  bool addWord( const QString& word ) Q_DECL_OVERRIDE;
+  bool ignoreWord( const QString& word ) Q_DECL_OVERRIDE;
+  QWidget* optionsWidget() Q_DECL_OVERRIDE;
+  QString dictionaryIdentity() const Q_DECL_OVERRIDE;
+  bool isReady() const Q_DECL_OVERRIDE;
+  QStringList knownWords() const Q_DECL_OVERRIDE;
+
+  /*! \brief Get the wrapped spell checker. */
+  ISpellChecker* spellChecker() const;
+
+private:
+  /*! \brief Drop the current filter and build a new one in the background. */
+  void rebuildFilter();
+  KnownWordsSpellCheckerPrivate* const d;
+};
+
+} // namespace SpellChecker
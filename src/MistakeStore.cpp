@@ -0,0 +1,444 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "MistakeStore.h"
+
+#include <QSet>
+
+#include <algorithm>
+
+using namespace SpellChecker::Internal;
+using namespace SpellChecker;
+
+namespace {
+
+/* Layout of the packed location of a mistake, from the lowest bits:
+ * the flags, the length, the column and then the line. Values that do not
+ * fit are stored as the largest value that fits. */
+const int FLAG_BITS   = 4;
+const int LENGTH_BITS = 12;
+const int COLUMN_BITS = 24;
+const int LINE_BITS   = 24;
+
+const int LENGTH_SHIFT = FLAG_BITS;
+const int COLUMN_SHIFT = LENGTH_SHIFT + LENGTH_BITS;
+const int LINE_SHIFT   = COLUMN_SHIFT + COLUMN_BITS;
+
+const quint64 FLAG_MASK   = ( quint64( 1 ) << FLAG_BITS ) - 1;
+const quint64 LENGTH_MASK = ( quint64( 1 ) << LENGTH_BITS ) - 1;
+const quint64 COLUMN_MASK = ( quint64( 1 ) << COLUMN_BITS ) - 1;
+const quint64 LINE_MASK   = ( quint64( 1 ) << LINE_BITS ) - 1;
+
+enum MistakeFlag : quint64 {
+  InComment   = 0x1 /*!< The word is in a comment and not in a String Literal. */,
+  PeriodAfter = 0x2 /*!< The character after the word is a period. */
+};
+
+inline quint64 saturate( int32_t value, quint64 mask )
+{
+  return ( value < 0 ) ? 0 : qMin( quint64( value ), mask );
+}
+// --------------------------------------------------
+
+inline quint64 packLocation( const Word& word )
+{
+  quint64 flags = 0;
+  if( word.inComment == true ) {
+    flags |= InComment;
+  }
+  if( word.charAfter == QLatin1Char( '.' ) ) {
+    flags |= PeriodAfter;
+  }
+  return ( saturate( word.lineNumber, LINE_MASK ) << LINE_SHIFT )
+         | ( saturate( word.columnNumber, COLUMN_MASK ) << COLUMN_SHIFT )
+         | ( saturate( word.length, LENGTH_MASK ) << LENGTH_SHIFT )
+         | flags;
+}
+// --------------------------------------------------
+
+/*! \brief Estimated number of bytes on the heap for the string. */
+inline qint64 stringMemoryUsage( const QString& string )
+{
+  if( string.isNull() == true ) {
+    return 0;
+  }
+  return qint64( sizeof( QArrayData ) ) + ( string.capacity() + 1 ) * qint64( sizeof( QChar ) );
+}
+// --------------------------------------------------
+
+/*! \brief Estimated number of bytes on the heap for the list of strings. */
+inline qint64 stringListMemoryUsage( const QStringList& strings )
+{
+  if( strings.isEmpty() == true ) {
+    return 0;
+  }
+  qint64 bytes = qint64( sizeof( QListData::Data ) ) + strings.size() * qint64( sizeof( void* ) );
+  for( const QString& string: strings ) {
+    bytes += stringMemoryUsage( string );
+  }
+  return bytes;
+}
+// --------------------------------------------------
+
+/*! \brief Estimated number of bytes used by a node in a QHash. */
+template<typename Key, typename Value>
+inline qint64 hashNodeMemoryUsage()
+{
+  return qint64( sizeof( void* ) + sizeof( uint ) + sizeof( Key ) + sizeof( Value ) );
+}
+// --------------------------------------------------
+
+} // namespace
+
+MistakeStore::MistakeStore()
+{}
+// --------------------------------------------------
+
+MistakeStore::~MistakeStore()
+{}
+// --------------------------------------------------
+
+void MistakeStore::setMistakes( const QString& fileName, const WordList& words )
+{
+  if( words.isEmpty() == true ) {
+    removeFile( fileName );
+    return;
+  }
+  const quint32 id = fileId( fileName );
+  QVector<Mistake> mistakes;
+  mistakes.reserve( words.size() );
+  for( const Word& word: words ) {
+    mistakes.append( { id, acquireWord( word ), packLocation( word ) } );
+  }
+  /* The new mistakes are added before the old ones are released, so that
+   * the words in both keep their entries and suggestions. */
+  QVector<Mistake>& fileMistakes = d_mistakes[id];
+  releaseMistakes( fileMistakes );
+  fileMistakes = std::move( mistakes );
+  /* The suggestions of the words can also change for other files. */
+  invalidateCache();
+}
+// --------------------------------------------------
+
+void MistakeStore::removeFile( const QString& fileName )
+{
+  const QHash<QString, quint32>::const_iterator idIter = d_fileIds.constFind( fileName );
+  if( idIter == d_fileIds.constEnd() ) {
+    return;
+  }
+  const QHash<quint32, QVector<Mistake>>::iterator iter = d_mistakes.find( idIter.value() );
+  if( iter != d_mistakes.end() ) {
+    releaseMistakes( iter.value() );
+    d_mistakes.erase( iter );
+  }
+  invalidateCache();
+}
+// --------------------------------------------------
+
+QStringList MistakeStore::removeWord( const QString& wordText )
+{
+  QStringList emptyFiles;
+  const QHash<QString, quint32>::const_iterator wordIter = d_wordIds.constFind( wordText );
+  if( wordIter == d_wordIds.constEnd() ) {
+    return emptyFiles;
+  }
+  const quint32 wordId = wordIter.value();
+  invalidateCache();
+  QHash<quint32, QVector<Mistake>>::iterator iter = d_mistakes.begin();
+  while( iter != d_mistakes.end() ) {
+    QVector<Mistake>& mistakes = iter.value();
+    const auto removedBegin    = std::remove_if( mistakes.begin(), mistakes.end(), [wordId]( const Mistake& mistake ) {
+      return mistake.wordId == wordId;
+    } );
+    if( removedBegin != mistakes.end() ) {
+      d_words[int( wordId )].references -= int( std::distance( removedBegin, mistakes.end() ) );
+      mistakes.erase( removedBegin, mistakes.end() );
+    }
+    if( mistakes.isEmpty() == true ) {
+      emptyFiles.append( d_fileNames.at( int( iter.key() ) ) );
+      iter = d_mistakes.erase( iter );
+    } else {
+      ++iter;
+    }
+  }
+  /* All the references to the word are removed, free its entry. */
+  WordEntry& entry = d_words[int( wordId )];
+  d_wordIds.remove( entry.text );
+  entry = WordEntry();
+  d_freeWordIds.append( wordId );
+  return emptyFiles;
+}
+// --------------------------------------------------
+
+void MistakeStore::clear()
+{
+  d_fileIds.clear();
+  d_fileNames.clear();
+  d_mistakes.clear();
+  d_wordIds.clear();
+  d_words.clear();
+  d_freeWordIds.clear();
+  invalidateCache();
+}
+// --------------------------------------------------
+
+bool MistakeStore::contains( const QString& fileName ) const
+{
+  return d_mistakes.contains( d_fileIds.value( fileName, quint32( -1 ) ) );
+}
+// --------------------------------------------------
+
+WordList MistakeStore::mistakes( const QString& fileName ) const
+{
+  if( ( d_cachedFileName.isNull() == false )
+      && ( d_cachedFileName == fileName ) ) {
+    return d_cachedMistakes;
+  }
+  WordList words;
+  const QVector<Mistake>* mistakes = fileMistakes( fileName );
+  if( mistakes == nullptr ) {
+    return words;
+  }
+  const QString& name = d_fileNames.at( int( mistakes->constFirst().fileId ) );
+  words.reserve( mistakes->size() );
+  for( const Mistake& mistake: *mistakes ) {
+    words.append( toWord( name, mistake ) );
+  }
+  d_cachedFileName = name;
+  d_cachedMistakes = words;
+  return words;
+}
+// --------------------------------------------------
+
+bool MistakeStore::mistakeAt( const QString& fileName, int32_t line, int32_t column, Word& word ) const
+{
+  const QVector<Mistake>* mistakes = fileMistakes( fileName );
+  if( mistakes == nullptr ) {
+    return false;
+  }
+  for( const Mistake& mistake: *mistakes ) {
+    if( int32_t( ( mistake.location >> LINE_SHIFT ) & LINE_MASK ) != line ) {
+      continue;
+    }
+    const int32_t mistakeColumn = int32_t( ( mistake.location >> COLUMN_SHIFT ) & COLUMN_MASK );
+    if( mistakeColumn > column ) {
+      continue;
+    }
+    /* Only convert the mistake once the line and start match, the length
+     * can depend on the text of the word. */
+    Word candidate = toWord( d_fileNames.at( int( mistake.fileId ) ), mistake );
+    if( ( mistakeColumn + candidate.length ) >= column ) {
+      word = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+// --------------------------------------------------
+
+WordList MistakeStore::mistakesOfWord( const QString& fileName, const QString& wordText ) const
+{
+  WordList words;
+  const QVector<Mistake>* mistakes = fileMistakes( fileName );
+  const auto wordIter              = d_wordIds.constFind( wordText );
+  if( ( mistakes == nullptr )
+      || ( wordIter == d_wordIds.constEnd() ) ) {
+    return words;
+  }
+  const quint32 wordId = wordIter.value();
+  const QString& name  = d_fileNames.at( int( mistakes->constFirst().fileId ) );
+  for( const Mistake& mistake: *mistakes ) {
+    if( mistake.wordId == wordId ) {
+      words.append( toWord( name, mistake ) );
+    }
+  }
+  return words;
+}
+// --------------------------------------------------
+
+QStringList MistakeStore::wordsWithoutSuggestions( const QString& fileName ) const
+{
+  QStringList texts;
+  const QVector<Mistake>* mistakes = fileMistakes( fileName );
+  if( mistakes == nullptr ) {
+    return texts;
+  }
+  QSet<quint32> seenWordIds;
+  for( const Mistake& mistake: *mistakes ) {
+    const WordEntry& entry = d_words.at( int( mistake.wordId ) );
+    if( ( entry.suggestions.isEmpty() == true )
+        && ( seenWordIds.contains( mistake.wordId ) == false ) ) {
+      seenWordIds.insert( mistake.wordId );
+      texts.append( entry.text );
+    }
+  }
+  return texts;
+}
+// --------------------------------------------------
+
+int MistakeStore::mistakeCount( const QString& fileName ) const
+{
+  return d_mistakes.value( d_fileIds.value( fileName, quint32( -1 ) ) ).size();
+}
+// --------------------------------------------------
+
+int MistakeStore::literalCount( const QString& fileName ) const
+{
+  const QHash<quint32, QVector<Mistake>>::const_iterator iter = d_mistakes.constFind( d_fileIds.value( fileName, quint32( -1 ) ) );
+  if( iter == d_mistakes.constEnd() ) {
+    return 0;
+  }
+  return int( std::count_if( iter.value().constBegin(), iter.value().constEnd(), []( const Mistake& mistake ) {
+    return ( mistake.location & InComment ) == 0;
+  } ) );
+}
+// --------------------------------------------------
+
+qint64 MistakeStore::memoryUsage() const
+{
+  qint64 bytes = 0;
+  /* File table */
+  bytes += d_fileNames.capacity() * qint64( sizeof( QString ) );
+  for( const QString& fileName: d_fileNames ) {
+    bytes += stringMemoryUsage( fileName );
+  }
+  bytes += d_fileIds.size() * hashNodeMemoryUsage<QString, quint32>() + d_fileIds.capacity() * qint64( sizeof( void* ) );
+  /* Mistakes */
+  bytes += d_mistakes.size() * hashNodeMemoryUsage<quint32, QVector<Mistake>>() + d_mistakes.capacity() * qint64( sizeof( void* ) );
+  for( const QVector<Mistake>& mistakes: d_mistakes ) {
+    bytes += qint64( sizeof( QArrayData ) ) + mistakes.capacity() * qint64( sizeof( Mistake ) );
+  }
+  /* Word table, the texts in the hash are shared with the entries. */
+  bytes += d_words.capacity() * qint64( sizeof( WordEntry ) );
+  for( const WordEntry& entry: d_words ) {
+    bytes += stringMemoryUsage( entry.text ) + stringListMemoryUsage( entry.suggestions );
+  }
+  bytes += d_wordIds.size() * hashNodeMemoryUsage<QString, quint32>() + d_wordIds.capacity() * qint64( sizeof( void* ) );
+  bytes += d_freeWordIds.capacity() * qint64( sizeof( quint32 ) );
+  return bytes;
+}
+// --------------------------------------------------
+
+qint64 MistakeStore::wordListMemoryUsage( const WordList& words )
+{
+  /* The file name is shared by all words. */
+  qint64 bytes = qint64( sizeof( QArrayData ) ) + words.capacity() * qint64( sizeof( Word ) );
+  if( words.isEmpty() == false ) {
+    bytes += stringMemoryUsage( words.constBegin()->fileName );
+  }
+  for( const Word& word: words ) {
+    bytes += stringMemoryUsage( word.text ) + stringListMemoryUsage( word.suggestions );
+  }
+  return bytes;
+}
+// --------------------------------------------------
+
+quint32 MistakeStore::fileId( const QString& fileName )
+{
+  const QHash<QString, quint32>::const_iterator iter = d_fileIds.constFind( fileName );
+  if( iter != d_fileIds.constEnd() ) {
+    return iter.value();
+  }
+  const quint32 id = quint32( d_fileNames.size() );
+  d_fileNames.append( fileName );
+  d_fileIds.insert( fileName, id );
+  return id;
+}
+// --------------------------------------------------
+
+quint32 MistakeStore::acquireWord( const Word& word )
+{
+  quint32 id;
+  const QHash<QString, quint32>::const_iterator iter = d_wordIds.constFind( word.text );
+  if( iter != d_wordIds.constEnd() ) {
+    id = iter.value();
+  } else if( d_freeWordIds.isEmpty() == false ) {
+    id = d_freeWordIds.takeLast();
+    d_words[int( id )].text = word.text;
+    d_wordIds.insert( word.text, id );
+  } else {
+    id = quint32( d_words.size() );
+    d_words.append( WordEntry() );
+    d_words.last().text = word.text;
+    d_wordIds.insert( word.text, id );
+  }
+  WordEntry& entry = d_words[int( id )];
+  ++entry.references;
+  /* The latest suggestions for a word are kept. */
+  if( word.suggestions.isEmpty() == false ) {
+    entry.suggestions = word.suggestions;
+  }
+  return id;
+}
+// --------------------------------------------------
+
+const QVector<MistakeStore::Mistake>* MistakeStore::fileMistakes( const QString& fileName ) const
+{
+  const QHash<quint32, QVector<Mistake>>::const_iterator iter = d_mistakes.constFind( d_fileIds.value( fileName, quint32( -1 ) ) );
+  if( ( iter == d_mistakes.constEnd() )
+      || ( iter.value().isEmpty() == true ) ) {
+    return nullptr;
+  }
+  return &iter.value();
+}
+// --------------------------------------------------
+
+Word MistakeStore::toWord( const QString& fileName, const Mistake& mistake ) const
+{
+  const WordEntry& entry = d_words.at( int( mistake.wordId ) );
+  const quint64 length   = ( mistake.location >> LENGTH_SHIFT ) & LENGTH_MASK;
+  const quint64 flags    = mistake.location & FLAG_MASK;
+  Word word;
+  word.fileName     = fileName;
+  word.text         = entry.text;
+  word.suggestions  = entry.suggestions;
+  word.lineNumber   = int32_t( ( mistake.location >> LINE_SHIFT ) & LINE_MASK );
+  word.columnNumber = int32_t( ( mistake.location >> COLUMN_SHIFT ) & COLUMN_MASK );
+  /* The length of a word is the length of its text, also if it was too
+   * long to store. */
+  word.length    = ( length == LENGTH_MASK ) ? entry.text.length() : int32_t( length );
+  word.start     = 0;
+  word.end       = word.length;
+  word.inComment = ( ( flags & InComment ) != 0 );
+  word.charAfter = ( ( flags & PeriodAfter ) != 0 ) ? QLatin1Char( '.' ) : QLatin1Char( ' ' );
+  return word;
+}
+// --------------------------------------------------
+
+void MistakeStore::invalidateCache()
+{
+  d_cachedFileName.clear();
+  d_cachedMistakes.clear();
+}
+// --------------------------------------------------
+
+void MistakeStore::releaseMistakes( const QVector<Mistake>& mistakes )
+{
+  for( const Mistake& mistake: mistakes ) {
+    WordEntry& entry = d_words[int( mistake.wordId )];
+    --entry.references;
+    if( entry.references == 0 ) {
+      d_wordIds.remove( entry.text );
+      entry = WordEntry();
+      d_freeWordIds.append( mistake.wordId );
+    }
+  }
+}
+// --------------------------------------------------
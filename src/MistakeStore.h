@@ -0,0 +1,138 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include "Word.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace SpellChecker {
+namespace Internal {
+
+/*! \brief The MistakeStore class
+ *
+ * Compact storage for the spelling mistakes of all files in a project.
+ *
+ * Each mistake is stored as a Mistake record with the ID of the file, the ID
+ * of the word and the packed location and flags of the mistake, instead of
+ * a full Word. The file names and the texts of the words are stored once and
+ * the records refer to them by their IDs. The suggestions for a word are
+ * the same for all of its occurrences, thus they are also stored once per
+ * word.
+ *
+ * The mistakes of a file are converted back to a WordList when they are
+ * needed, for example to show them in the output pane. The conversion does
+ * not restore the start and end of a word in its token, those are only used
+ * while a file is parsed and checked. The list of the last file that was
+ * converted is kept until the store changes, since the same file, normally
+ * the one in the current editor, is asked for repeatedly. Lookups that only
+ * need a few mistakes, like the word under the cursor, use mistakeAt() and
+ * mistakesOfWord() which only convert the mistakes that match.
+ */
+class MistakeStore
+{
+public:
+  /*! \brief Compact record of a single mistake. */
+  struct Mistake {
+    quint32 fileId;   /*!< Index of the file name in the file table. */
+    quint32 wordId;   /*!< Index of the word in the word table. */
+    quint64 location; /*!< Packed line, column, length and flags. */
+  };
+
+  MistakeStore();
+  ~MistakeStore();
+
+  /*! \brief Replace the mistakes of the file.
+   *
+   * If the list of words is empty, the file is removed from the store. */
+  void setMistakes( const QString& fileName, const WordList& words );
+  /*! \brief Remove the file and all its mistakes from the store. */
+  void removeFile( const QString& fileName );
+  /*! \brief Remove all the occurrences of the word from all files.
+   * \return Files that do not have any mistakes left after removing the
+   *          word. These files are removed from the store. */
+  QStringList removeWord( const QString& wordText );
+  /*! \brief Remove all mistakes from the store. */
+  void clear();
+
+  /*! \brief Check if the file has mistakes in the store. */
+  bool contains( const QString& fileName ) const;
+  /*! \brief Get the mistakes of the file as a list of words. */
+  WordList mistakes( const QString& fileName ) const;
+  /*! \brief Get the mistake of the file at the position.
+   * \param[in] fileName Name of the file.
+   * \param[in] line Line of the position.
+   * \param[in] column Column of the position, the mistake must contain it
+   *            or end right before it.
+   * \param[out] word The mistake, if one was found.
+   * \return true if there is a mistake at the position. */
+  bool mistakeAt( const QString& fileName, int32_t line, int32_t column, Word& word ) const;
+  /*! \brief Get all occurrences of the word in the file. */
+  WordList mistakesOfWord( const QString& fileName, const QString& wordText ) const;
+  /*! \brief Get the texts of the mistakes of the file that do not have
+   * suggestions, each text once. */
+  QStringList wordsWithoutSuggestions( const QString& fileName ) const;
+  /*! \brief Number of mistakes in the file. */
+  int mistakeCount( const QString& fileName ) const;
+  /*! \brief Number of mistakes in the file that are in String Literals. */
+  int literalCount( const QString& fileName ) const;
+
+  /*! \brief Estimated number of bytes used by the store. */
+  qint64 memoryUsage() const;
+  /*! \brief Estimated number of bytes used to store the mistakes as a WordList.
+   *
+   * This is used to compare the store against keeping a WordList for
+   * every file. */
+  static qint64 wordListMemoryUsage( const WordList& words );
+
+private:
+  Q_DISABLE_COPY( MistakeStore )
+  /*! \brief Entry in the word table. */
+  struct WordEntry {
+    QString text;
+    QStringList suggestions;
+    int references = 0; /*!< Number of mistakes referring to the word. */
+  };
+
+  quint32 fileId( const QString& fileName );
+  quint32 acquireWord( const Word& word );
+  void releaseMistakes( const QVector<Mistake>& mistakes );
+  const QVector<Mistake>* fileMistakes( const QString& fileName ) const;
+  Word toWord( const QString& fileName, const Mistake& mistake ) const;
+  void invalidateCache();
+
+  QHash<QString, quint32> d_fileIds;
+  QVector<QString> d_fileNames;
+  /*! \brief Mistakes of each file, by the ID of the file. */
+  QHash<quint32, QVector<Mistake>> d_mistakes;
+  QHash<QString, quint32> d_wordIds;
+  QVector<WordEntry> d_words;
+  /*! \brief IDs of entries in the word table that are no longer used. */
+  QVector<quint32> d_freeWordIds;
+  /*! \brief File of which the mistakes are in d_cachedMistakes. */
+  mutable QString d_cachedFileName;
+  /*! \brief Last list returned by mistakes(), cleared when the store changes. */
+  mutable WordList d_cachedMistakes;
+};
+
+} // namespace Internal
+} // namespace SpellChecker
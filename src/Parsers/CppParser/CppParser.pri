@@ -3,7 +3,9 @@ SOURCES += \
         $$PWD/cppparsersettings.cpp \
         $$PWD/cppparseroptionspage.cpp \
         $$PWD/cppparseroptionswidget.cpp \
-        $$PWD/cppdocumentprocessor.cpp
+        $$PWD/cppdocumentprocessor.cpp \
+        $$PWD/cppwordscanner.cpp \
+        $$PWD/cppsharedtokencache.cpp
 
 HEADERS +=  \
         $$PWD/cppdocumentparser.h \
@@ -11,7 +13,9 @@ HEADERS +=  \
         $$PWD/cppparseroptionspage.h \
         $$PWD/cppparseroptionswidget.h \
         $$PWD/cppparserconstants.h \
-        $$PWD/cppdocumentprocessor.h
+        $$PWD/cppdocumentprocessor.h \
+        $$PWD/cppwordscanner.h \
+        $$PWD/cppsharedtokencache.h
 
 FORMS += \
         $$PWD/cppparseroptionswidget.ui
@@ -18,19 +18,25 @@
 ** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
 ****************************************************************************/
 
+#include "../../ISpellChecker.h"
 #include "../../spellcheckerconstants.h"
 #include "../../spellcheckercore.h"
 #include "../../spellcheckercoresettings.h"
+#include "../../SpellCheckerThreadPool.h"
 #include "../../Word.h"
 #include "cppdocumentparser.h"
 #include "cppdocumentprocessor.h"
 #include "cppparserconstants.h"
 #include "cppparseroptionspage.h"
 #include "cppparsersettings.h"
+#include "cppsharedtokencache.h"
 
 #include <coreplugin/actionmanager/actioncontainer.h>
 #include <coreplugin/actionmanager/actionmanager.h>
+#include <coreplugin/editormanager/documentmodel.h>
+#include <coreplugin/editormanager/editormanager.h>
 #include <coreplugin/icore.h>
+#include <coreplugin/idocument.h>
 #include <coreplugin/progressmanager/progressmanager.h>
 #include <cppeditor/cppeditorconstants.h>
 #include <cppeditor/cppeditordocument.h>
@@ -43,12 +49,25 @@
 #include <utils/algorithm.h>
 #include <utils/mimetypes/mimedatabase.h>
 #include <utils/runextensions.h>
+#include <utils/textfileformat.h>
 
 #include <QApplication>
+#include <QCache>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
 #include <QFutureWatcher>
-#include <QRegularExpression>
+#include <QHash>
 #include <QTextBlock>
 
+#include <set>
+#include <tuple>
+
+// #define BENCH_TIME
+#ifdef BENCH_TIME
+#include <QDebug>
+#endif /* BENCH_TIME */
+
 /*! \brief Testing assert that should be used during debugging
  * but should not be made part of a release. */
 // #define SP_CHECK( test ) QTC_CHECK( test )
@@ -64,53 +83,444 @@ namespace Internal {
 const char MIME_TYPE_CXX_DOX[] = "text/x-c++dox";
 /*! Task index name for the C++ document parser progress notification. */
 const char TASK_INDEX[] = "SpellChecker.Task.CppParse";
+/*! Maximum number of tokens and words of all files in the token hash cache.
+ * Each word is roughly 100 bytes, keeping the cache in the order of 50 MB
+ * for large projects. */
+const int TOKEN_HASH_CACHE_MAX_COST = 500000;
+/*! Number of files per worker that are in process when parsing starts. */
+const int IN_FLIGHT_INITIAL_PER_WORKER = 2;
+/*! Maximum number of files per worker that can be in process. */
+const int IN_FLIGHT_MAXIMUM_PER_WORKER = 8;
+/*! The latency of a file, from being queued until its words are known, may
+ * be this many times the time that the processor needs for a file before
+ * the number of files in process is reduced. */
+const double IN_FLIGHT_LATENCY_FACTOR = 4.0;
+/*! Lower limit of the latency target in milliseconds, so that very small
+ * files do not shrink the number of files in process to the minimum. */
+const double IN_FLIGHT_MINIMUM_LATENCY_MSECS = 250.0;
+/*! Factor that the number of files in process is multiplied with when the
+ * latency is above the target. */
+const double IN_FLIGHT_DECREASE_FACTOR = 0.5;
+/*! Weight of a new measurement in the moving averages. */
+const double IN_FLIGHT_AVERAGE_WEIGHT = 0.2;
+/*! Files modified less than this number of days ago are parsed before the
+ * other files that are not open in an editor. */
+const int RECENTLY_MODIFIED_DAYS = 7;
 
 // --------------------------------------------------
 // --------------------------------------------------
 // --------------------------------------------------
-/*! \brief Wrapper for HashWords to ensure proper locking.
+/*! \brief Cache of the token hashes of the files that were parsed.
  *
  * Even after a lot of diligence and effort there were still threading
  * issues with some container. For this reason it was decided to add
  * wrappers around some aspects to try and force proper usage.
  *
- * This should allow for better maintainability by removing the burden of
- * locking from the user completely and placing it on the maintainer of this
- * class. */
-class LockedTokenHash
+ * The hashes of the tokens of each file are kept so that unchanged comments
+ * and literals of any file, not only the current editor, do not need to be
+ * processed again when the file is parsed again. The cache is bounded by
+ * the number of tokens and words that it holds, the least recently used
+ * files are removed first.
+ *
+ * The words in the hashes already had the settings applied. When the
+ * settings change the cache is cleared and its generation is incremented.
+ * Hashes produced by a processor that started before the change are then
+ * ignored when they are inserted, since the generation that they were
+ * taken with is no longer the current one. */
+class TokenHashCache
 {
-  LockedTokenHash( const LockedTokenHash& other )      = delete;
-  LockedTokenHash& operator=( const LockedTokenHash& ) = delete;
+  TokenHashCache( const TokenHashCache& other )      = delete;
+  TokenHashCache& operator=( const TokenHashCache& ) = delete;
 public:
   /*! \brief Constructor. */
-  LockedTokenHash() = default;
-  /*! \brief Get a copy of the HashWords. */
-  HashWords get() const
+  TokenHashCache()
+  {
+    d_cache.setMaxCost( TOKEN_HASH_CACHE_MAX_COST );
+  }
+  /*! \brief Get a copy of the hashes of the file.
+   *
+   * \param[in] fileName Name of the file to get the hashes for.
+   * \param[out] generation Generation of the cache, that must be passed to
+   *              insert() along with the new hashes of the file.
+   * \return The hashes of the file, empty if the file is not in the cache. */
+  HashWords get( const QString& fileName, quint32& generation )
   {
     QMutexLocker locker( &d_mutex );
-    HashWords words = d_tokenHashes;
-    return words;
+    generation = d_generation;
+    ++d_lookups;
+    const HashWords* hashes = d_cache.object( fileName );
+    if( hashes == nullptr ) {
+      return {};
+    }
+    ++d_hits;
+    return *hashes;
   }
-  /*! \brief Clear the hash words.
+  /*! \brief Insert the new hashes of the file.
    *
-   * This function can probably be removed since one can clear
-   * the hash using the assignment operator with an empty hash, but
-   * for clearness sake the function is kept. */
+   * The hashes are ignored if the cache was cleared since the \a generation
+   * was obtained using get(). */
+  void insert( const QString& fileName, HashWords&& hashes, quint32 generation )
+  {
+    QMutexLocker locker( &d_mutex );
+    if( generation != d_generation ) {
+      return;
+    }
+    /* The cost of the file is the number of tokens and words that it has. */
+    int cost = hashes.size();
+    for( const TokenWords& tokenWords: qAsConst( hashes ) ) {
+      cost += tokenWords.words.size();
+    }
+    d_cache.insert( fileName, new HashWords( std::move( hashes ) ), qMax( cost, 1 ) );
+  }
+  /*! \brief Remove the hashes of the file. */
+  void remove( const QString& fileName )
+  {
+    QMutexLocker locker( &d_mutex );
+    d_cache.remove( fileName );
+  }
+  /*! \brief Clear the hashes of all files and start a new generation. */
   void clear()
   {
     QMutexLocker locker( &d_mutex );
-    d_tokenHashes.clear();
+    d_cache.clear();
+    ++d_generation;
   }
-  /*! \brief Assign a HashWords to the internal hashes. */
-  void operator=( const HashWords& other )
+  /*! \brief Record how many tokens of a parsed file were found in its hashes. */
+  void recordTokens( int32_t reused, int32_t total )
+  {
+    QMutexLocker locker( &d_mutex );
+    d_reusedTokens += reused;
+    d_totalTokens  += total;
+  }
+  /*! \brief Get the hit rate of the cache as a printable string.
+   *
+   * This includes the hits of files that were found in the cache and of the
+   * tokens that could be reused from the hashes. */
+  QString statistics() const
   {
     QMutexLocker locker( &d_mutex );
-    d_tokenHashes = other;
+    const auto percentage = []( qint64 part, qint64 total ) {
+      return ( total == 0 ) ? 0.0 : ( 100.0 * double( part ) / double( total ) );
+    };
+    return QStringLiteral( "files %1/%2 (%3%), tokens %4/%5 (%6%), cached files %7, cost %8/%9" )
+           .arg( d_hits ).arg( d_lookups ).arg( percentage( d_hits, d_lookups ), 0, 'f', 1 )
+           .arg( d_reusedTokens ).arg( d_totalTokens ).arg( percentage( d_reusedTokens, d_totalTokens ), 0, 'f', 1 )
+           .arg( d_cache.count() ).arg( d_cache.totalCost() ).arg( d_cache.maxCost() );
+  }
+
+private:
+  QCache<QString, HashWords> d_cache; /*!< Hashes of each file, least recently used first out. */
+  quint32 d_generation  = 0;          /*!< Incremented each time that the cache is cleared. */
+  qint64 d_lookups      = 0;          /*!< Number of times that the hashes of a file were asked for. */
+  qint64 d_hits         = 0;          /*!< Number of times that the hashes of a file were found. */
+  qint64 d_reusedTokens = 0;          /*!< Number of tokens that were found in the hashes. */
+  qint64 d_totalTokens  = 0;          /*!< Number of tokens in all files that were parsed. */
+  mutable QMutex d_mutex;             /*!< The lock that guards the cache. */
+};
+
+/*! \brief Number of files that can be in process at the same time.
+ *
+ * Files in process are files that the code model was asked to update, or
+ * that are parsed by a processor. Too few and the workers are idle while
+ * the code model parses the next files, too many and the code model gets
+ * flooded and files wait long before they are checked, which also delays
+ * updates of the files in the editor.
+ *
+ * The size of the window is adapted using additive increase, multiplicative
+ * decrease (AIMD) on the latency of the files: the time from when a file is
+ * queued until its words are known. While the latency is below a target,
+ * the window grows by about one file for each window of files that finish.
+ * When a file is above the target, the window is halved, at most once per
+ * window of files since the files that finish right after a decrease were
+ * queued with the old window.
+ *
+ * The target is a multiple of the average time that the processor needs
+ * for a file, the service time, thus a file may wait for a few others but
+ * not for the whole project. The window is kept between the number of
+ * workers and a multiple of it.
+ *
+ * The window is not thread safe, the parser guards it with the same mutex
+ * as the files in process. */
+class InFlightWindow
+{
+  InFlightWindow( const InFlightWindow& )            = delete;
+  InFlightWindow& operator=( const InFlightWindow& ) = delete;
+public:
+  /*! \brief Constructor. */
+  InFlightWindow()
+  {
+    setWorkerCount( 1 );
+  }
+  /*! \brief Set the number of workers that process the files.
+   *
+   * The limits of the window follow the number of workers. */
+  void setWorkerCount( int workers )
+  {
+    workers = qMax( workers, 1 );
+    if( workers == d_workers ) {
+      return;
+    }
+    d_workers = workers;
+    if( d_window == 0.0 ) {
+      d_window = IN_FLIGHT_INITIAL_PER_WORKER * d_workers;
+    }
+    d_window = qBound( minimum(), d_window, maximum() );
+  }
+  /*! \brief Get the number of files that can be in process. */
+  size_t size() const
+  {
+    return size_t( d_window );
+  }
+  /*! \brief A file was queued, its latency is measured from now. */
+  void started( const QString& fileName )
+  {
+    if( d_started.contains( fileName ) == false ) {
+      d_started[fileName].start();
+    }
+  }
+  /*! \brief A file was removed from the files in process without being parsed. */
+  void cancelled( const QString& fileName )
+  {
+    d_started.remove( fileName );
+  }
+  /*! \brief All files in process were cancelled.
+   *
+   * The window and the averages are kept, they still apply to the next run. */
+  void reset()
+  {
+    d_started.clear();
+    d_finishTimer.invalidate();
+  }
+  /*! \brief A file finished, adapt the window to its latency.
+   * \param[in] fileName File that finished.
+   * \param[in] serviceNsecs Time that the processor took for the file. */
+  void finished( const QString& fileName, qint64 serviceNsecs )
+  {
+    const auto startedIter = d_started.find( fileName );
+    if( startedIter == d_started.end() ) {
+      return;
+    }
+    const double latencyMsecs = double( startedIter.value().nsecsElapsed() ) / 1000000.0;
+    d_started.erase( startedIter );
+    d_latencyMsecs = average( d_latencyMsecs, latencyMsecs );
+    d_serviceMsecs = average( d_serviceMsecs, double( serviceNsecs ) / 1000000.0 );
+    if( d_finishTimer.isValid() == true ) {
+      d_intervalMsecs = average( d_intervalMsecs, double( d_finishTimer.restart() ) );
+    } else {
+      d_finishTimer.start();
+    }
+
+    ++d_finishedSinceDecrease;
+    if( latencyMsecs > latencyTarget() ) {
+      if( d_finishedSinceDecrease >= d_window ) {
+        d_window                = qMax( minimum(), d_window * IN_FLIGHT_DECREASE_FACTOR );
+        d_finishedSinceDecrease = 0;
+      }
+    } else {
+      d_window = qMin( maximum(), d_window + ( 1.0 / d_window ) );
+    }
+  }
+  /*! \brief Get the window and its measurements as a printable string. */
+  QString diagnostics() const
+  {
+    const double throughput = ( d_intervalMsecs > 0.0 ) ? ( 1000.0 / d_intervalMsecs ) : 0.0;
+    return CppDocumentParser::tr( "%1 files in flight, %2 files/s, latency %3 ms" )
+           .arg( size() )
+           .arg( throughput, 0, 'f', 1 )
+           .arg( d_latencyMsecs, 0, 'f', 0 );
   }
 
 private:
-  HashWords d_tokenHashes; /*!< The HashWords that are protected. */
-  mutable QMutex d_mutex;  /*!< The lock that guards the hashes. */
+  double minimum() const
+  {
+    return d_workers;
+  }
+  double maximum() const
+  {
+    return IN_FLIGHT_MAXIMUM_PER_WORKER * d_workers;
+  }
+  double latencyTarget() const
+  {
+    return qMax( IN_FLIGHT_MINIMUM_LATENCY_MSECS, IN_FLIGHT_LATENCY_FACTOR * d_serviceMsecs );
+  }
+  static double average( double current, double sample )
+  {
+    return ( current == 0.0 )
+           ? sample
+           : ( current + ( IN_FLIGHT_AVERAGE_WEIGHT * ( sample - current ) ) );
+  }
+
+  QHash<QString, QElapsedTimer> d_started; /*!< Time since each file in process was queued. */
+  QElapsedTimer d_finishTimer;             /*!< Time since the last file finished. */
+  int d_workers                  = 0;      /*!< Number of workers processing the files. */
+  double d_window                = 0.0;    /*!< Number of files that can be in process. */
+  double d_finishedSinceDecrease = 0.0;    /*!< Files that finished since the last decrease. */
+  double d_latencyMsecs          = 0.0;    /*!< Average latency of the files. */
+  double d_serviceMsecs          = 0.0;    /*!< Average time that the processor took for a file. */
+  double d_intervalMsecs         = 0.0;    /*!< Average time between files that finished. */
+};
+
+/*! \brief Queue of the files that must still be parsed, in order of priority.
+ *
+ * On large projects it can take minutes before all files were parsed, the
+ * files that the user is looking at should not wait for all other files. The
+ * files are taken from the queue in this order:
+ * -# The file of the current editor.
+ * -# Files open in other editors.
+ * -# Files modified recently, the most recently modified first. These are
+ *    likely the files that are being worked on.
+ * -# All other files, in alphabetical order.
+ *
+ * The editors are updated with setEditors() when the current editor changes,
+ * the files in the queue are then moved to their new priority so that the
+ * pending work is reordered while the project is being parsed.
+ *
+ * The modification times are read by rankFiles() before the files are added,
+ * so that the disk is not accessed while the queue is locked. The priority of
+ * a file that is not open in an editor does not change while it is in the
+ * queue. The modification time is returned along with the file by
+ * takeFirst(), so that the parser does not have to read it again while the
+ * queue is locked.
+ *
+ * The queue is not thread safe, the parser guards it with the same mutex as
+ * the files in process. */
+class PriorityFileQueue
+{
+  PriorityFileQueue( const PriorityFileQueue& )            = delete;
+  PriorityFileQueue& operator=( const PriorityFileQueue& ) = delete;
+public:
+  /*! \brief Constructor. */
+  PriorityFileQueue() = default;
+  /*! \brief Set the editors and reorder the files in the queue.
+   * \param[in] currentEditor File of the current editor.
+   * \param[in] openEditors Files open in editors. */
+  void setEditors( const QString& currentEditor, const QStringSet& openEditors )
+  {
+    /* Only the files of the previous and the new editors can change priority. */
+    QStringSet affected = d_openEditors + openEditors;
+    affected << d_currentEditor << currentEditor;
+    QStringList moved;
+    for( const QString& fileName: qAsConst( affected ) ) {
+      const auto fileIter = d_files.constFind( fileName );
+      if( fileIter != d_files.constEnd() ) {
+        d_queue.erase( key( fileName, fileIter.value().rank ) );
+        moved << fileName;
+      }
+    }
+    d_currentEditor = currentEditor;
+    d_openEditors   = openEditors;
+    for( const QString& fileName: qAsConst( moved ) ) {
+      d_queue.insert( key( fileName, d_files.value( fileName ).rank ) );
+    }
+  }
+  /*! \brief Rank of a file among the recently modified files. */
+  struct RankedFile
+  {
+    qint64 rank;        /*!< Negated modification time, 0 if not modified recently. */
+    QDateTime modified; /*!< Modification time when the file was ranked. */
+  };
+  /*! \brief Files with their rank among the recently modified files. */
+  using RankedFiles = QHash<QString, RankedFile>;
+  /*! \brief Rank the files by their modification time.
+   *
+   * This reads the modification time of every file, call it before the
+   * queue is locked. Recently modified files are ranked by their negated
+   * modification time so that the most recent one comes first, other files
+   * get 0. */
+  static RankedFiles rankFiles( const QStringSet& fileNames )
+  {
+    const qint64 since = recentSince();
+    RankedFiles rankedFiles;
+    rankedFiles.reserve( fileNames.size() );
+    for( const QString& fileName: fileNames ) {
+      const QDateTime modified = QFileInfo( fileName ).lastModified();
+      const qint64 msecs       = modified.toMSecsSinceEpoch();
+      rankedFiles.insert( fileName, { ( msecs >= since ) ? -msecs : 0, modified } );
+    }
+    return rankedFiles;
+  }
+  /*! \brief Add the files that were ranked by rankFiles() to the queue.
+   *
+   * Files that are already queued keep their place. */
+  void insert( const RankedFiles& rankedFiles )
+  {
+    for( RankedFiles::const_iterator iter = rankedFiles.constBegin(); iter != rankedFiles.constEnd(); ++iter ) {
+      if( d_files.contains( iter.key() ) == false ) {
+        d_files.insert( iter.key(), iter.value() );
+        d_queue.insert( key( iter.key(), iter.value().rank ) );
+      }
+    }
+  }
+  /*! \brief Remove the file from the queue, if it is queued. */
+  void remove( const QString& fileName )
+  {
+    const auto fileIter = d_files.find( fileName );
+    if( fileIter != d_files.end() ) {
+      d_queue.erase( key( fileName, fileIter.value().rank ) );
+      d_files.erase( fileIter );
+    }
+  }
+  /*! \brief Remove the file with the highest priority from the queue and return it.
+   *
+   * The queue must not be empty.
+   * \param[out] modified Modification time of the file when it was ranked. */
+  QString takeFirst( QDateTime& modified )
+  {
+    const QString fileName = std::get<QString>( *d_queue.begin() );
+    d_queue.erase( d_queue.begin() );
+    modified = d_files.take( fileName ).modified;
+    return fileName;
+  }
+  /*! \brief Remove all files from the queue, the editors are kept. */
+  void clear()
+  {
+    d_queue.clear();
+    d_files.clear();
+  }
+  /*! \brief Check if there are no files in the queue. */
+  bool empty() const
+  {
+    return d_queue.empty();
+  }
+  /*! \brief Get the number of files in the queue. */
+  size_t size() const
+  {
+    return d_queue.size();
+  }
+
+private:
+  enum class Priority {
+    CurrentEditor = 0,
+    OpenEditor,
+    RecentlyModified,
+    Other
+  };
+  using Key = std::tuple<Priority, qint64, QString>;
+
+  Key key( const QString& fileName, qint64 rank ) const
+  {
+    if( fileName == d_currentEditor ) {
+      return Key( Priority::CurrentEditor, 0, fileName );
+    }
+    if( d_openEditors.contains( fileName ) == true ) {
+      return Key( Priority::OpenEditor, 0, fileName );
+    }
+    if( rank != 0 ) {
+      return Key( Priority::RecentlyModified, rank, fileName );
+    }
+    return Key( Priority::Other, 0, fileName );
+  }
+  static qint64 recentSince()
+  {
+    return QDateTime::currentDateTime().addDays( -RECENTLY_MODIFIED_DAYS ).toMSecsSinceEpoch();
+  }
+
+  std::set<Key> d_queue;                /*!< Files in order of priority. */
+  QHash<QString, RankedFile> d_files;   /*!< Rank and modification time of
+                                         * each queued file, the rank is 0 if
+                                         * it was not modified recently. */
+  QString d_currentEditor;              /*!< File of the current editor. */
+  QStringSet d_openEditors;             /*!< Files open in editors. */
 };
 
 /*! \brief The ProgressNotification Wrapper.
@@ -152,8 +562,9 @@ public:
    *
    * \param filesInProject Total files that must be processed.
    * \param outstanding Number of files that must still be processed.
-   * \param inProcess Number of files that are currently in process. */
-  void update( int32_t filesInProject, int32_t outstanding, int32_t inProcess )
+   * \param inProcess Number of files that are currently in process.
+   * \param status Text shown along with the progress. */
+  void update( int32_t filesInProject, int32_t outstanding, int32_t inProcess, const QString& status = QString() )
   {
     /* Thumb-suck value to decide when the future should be created and
      * when it should be destroyed. */
@@ -172,14 +583,14 @@ public:
       /* Update the progress here and return immediately.
        * This is done to prevent the check below that should be unnecessary
        * since the object will be valid and should not be deleted. */
-      d_progressObject->setProgressValue( filesInProject - outstanding - inProcess );
+      d_progressObject->setProgressValueAndText( filesInProject - outstanding - inProcess, status );
       return;
     }
 
     /* If there is a progress notification, update it */
     if( d_progressObject != nullptr ) {
       d_progressObject->setProgressRange( 0, filesInProject );
-      d_progressObject->setProgressValue( filesInProject - outstanding - inProcess );
+      d_progressObject->setProgressValueAndText( filesInProject - outstanding - inProcess, status );
       if( ( outstanding + inProcess ) < cFILE_OUT_COUNT ) {
         /* All done, remove the progress notification. */
         d_progressObject->reportFinished();
@@ -219,7 +630,13 @@ class FutureWatchers
 {
   /* Using declarations to simplify the code a bit. */
   using FutureWatcher        = CppDocumentProcessor::WatcherPtr;
-  using FutureWatcherMap     = QMap<FutureWatcher, QString>;
+  /*! \brief File of a watcher and the generation of its token hashes. */
+  struct WatchedFile
+  {
+    QString fileName;
+    quint32 hashGeneration;
+  };
+  using FutureWatcherMap     = QMap<FutureWatcher, WatchedFile>;
   using FutureWatcherMapIter = FutureWatcherMap::Iterator;
   /* Prevent copy and assignment */
   FutureWatchers( const FutureWatchers& )            = delete;
@@ -227,32 +644,51 @@ class FutureWatchers
 public:
   /*! \brief Constructor. */
   FutureWatchers() = default;
-  /*! \brief Add a new \a watcher and with its \a fileName. */
-  void add( CppDocumentProcessor::WatcherPtr watcher, const QString& fileName )
+  /*! \brief Add a new \a watcher and with its \a fileName.
+   *
+   * The \a hashGeneration is the generation of the token hash cache that
+   * the processor got its hashes from.
+   *
+   * A watcher that is still processing an older revision of the file is
+   * superseded by the new one. Its future is cancelled, the processor checks
+   * for cancellation between its steps, and it is removed from the watchers
+   * so that its result gets dropped by remove() if it already finished. */
+  void add( CppDocumentProcessor::WatcherPtr watcher, const QString& fileName, quint32 hashGeneration )
   {
     QMutexLocker locker( &d_mutex );
-    d_futureWatchers.insert( watcher, fileName );
+    FutureWatcherMapIter iter = d_futureWatchers.begin();
+    while( iter != d_futureWatchers.end() ) {
+      if( iter.value().fileName == fileName ) {
+        iter.key()->cancel();
+        iter = d_futureWatchers.erase( iter );
+      } else {
+        ++iter;
+      }
+    }
+    d_futureWatchers.insert( watcher, { fileName, hashGeneration } );
   }
   /*! \brief Remove a watcher.
    *
    * This function will remove the watcher if it is in the list of
    * watchers. If it was found, the name of the associated file
    * will be returned. If it was not found, the name will be empty.
+   * A watcher is not found if it was cancelled or superseded by a
+   * watcher of a newer revision of the same file, see add().
    *
    * The reason for returning the name is due to the way that this
    * object is used. This is probably bad design, but good for speed
    * compared to first getting the associated name and then calling
    * remove */
-  QString remove( CppDocumentProcessor::WatcherPtr watcher )
+  QString remove( CppDocumentProcessor::WatcherPtr watcher, quint32& hashGeneration )
   {
     QMutexLocker locker( &d_mutex );
     QString fileName;
     /* Get the file name associated with this future and the misspelled
      * words. */
     FutureWatcherMapIter iter = d_futureWatchers.find( watcher );
-    SP_CHECK( iter != d_futureWatchers.end() );
     if( iter != d_futureWatchers.end() ) {
-      fileName = iter.value();
+      fileName       = iter.value().fileName;
+      hashGeneration = iter.value().hashGeneration;
       d_futureWatchers.erase( iter );
     }
     return fileName;
@@ -293,29 +729,62 @@ public:
   QMutex fileQeueMutex;                /*!< Mutex protecting the filesToUpdate and filesInProcess
                                         * sets. This should also be added to a wrapper, but for
                                         * now this will be skipped. */
-  std::set<QString> filesToUpdate;     /*!< Files added to the waiting queue
+  PriorityFileQueue filesToUpdate;     /*!< Files added to the waiting queue
                                         * that must still be parsed. The
                                         * CppModelManager must still be instructed
                                         * to parse these files. The idea is not to
                                         * instruct too many at a time since this
                                         * can be an issue for large projects.
-                                        * A std::set was used to make threading
-                                        * issues clear, compared to a QSet with
-                                        * COW that hides this (and introduces
-                                        * confusion). */
+                                        * The files are taken in order of
+                                        * priority, see PriorityFileQueue. */
   std::set<QString> filesInProcess;    /*!< Files that are in process of being
                                         * parsed. Either the CppModelManager was
                                         * instructed to parse the file or there is
                                         * already a future parsing the file.
-                                        * See above for why a std::set was used. */
-  LockedTokenHash tokenHashes;         /*!< Tokens and their hashes that are
+                                        * A std::set was used to make threading
+                                        * issues clear, compared to a QSet with
+                                        * COW that hides this (and introduces
+                                        * confusion). */
+  InFlightWindow inFlight;             /*!< Number of files that can be in
+                                        * process, adapted to how fast they
+                                        * are done. Protected by the
+                                        * fileQeueMutex. */
+  QList<QFuture<void>> snapshotFutures; /*!< Futures reading documents from
+                                        * the snapshot of the code model, see
+                                        * parseSnapshotDocument(). Protected by
+                                        * the fileQeueMutex. */
+  QTextCodec* defaultCodec;            /*!< Codec used to read files that are
+                                        * not UTF-8, the same as the code
+                                        * model uses. */
+#ifdef BENCH_TIME
+  QHash<QString, QElapsedTimer> updateTimers; /*!< Time since the code model
+                                        * updated each file in process, used
+                                        * to measure the latency until the
+                                        * mistakes are shown. Protected by the
+                                        * fileQeueMutex. */
+  QHash<QString, QElapsedTimer> shownTimers; /*!< Timers of the files of the
+                                        * current editor of which the words
+                                        * were given to the core, stopped when
+                                        * the core shows the mistakes. Only
+                                        * used in the main thread. */
+#endif /* BENCH_TIME */
+  QHash<QString, QDateTime> filesUpToDate; /*!< Files of which the core restored
+                                        * the results of a previous session,
+                                        * along with their modification time.
+                                        * These are not parsed again until they
+                                        * change. Protected by the fileQeueMutex. */
+  TokenHashCache tokenHashes;          /*!< Tokens and their hashes that are
                                         * used to speed up processing the
-                                        * current file. The hashes of tokens
+                                        * files. The hashes of tokens
                                         * (comments, literals, etc.) and their
-                                        * words are kept so that if the same token
-                                        * is encountered, the words can be reused
-                                        * without needing to process the token
-                                        * again. */
+                                        * words are kept for each file so that
+                                        * if the same token is encountered, the
+                                        * words can be reused without needing to
+                                        * process the token again. */
+  SharedTokenCache sharedTokens;       /*!< Tokens of all files, so that tokens
+                                        * that appear in many files, such as
+                                        * license headers, are only processed
+                                        * once. */
   FutureWatchers futureWatchers;       /*!< List of future watchers created. This
                                         * list is used to cancel the futures as needed
                                         * for example when the application closes down,
@@ -331,6 +800,7 @@ public:
     , optionsPage( nullptr )
     , settings( nullptr )
     , filesInStartupProject()
+    , defaultCodec( nullptr )
     , progressObject()
   {}
 
@@ -379,6 +849,73 @@ public:
     }
   }
   // ------------------------------------------
+
+  /*! \brief Check if the results of the \a file are still up to date.
+   *
+   * Once the file changed on disk it is removed from the files that are up
+   * to date, so that it gets parsed from then on. The modification time is
+   * read by the caller, so that the disk is not accessed while the mutex is
+   * locked.
+   * \note The fileQeueMutex must be locked when calling this function.
+   * \param[in] file File to check.
+   * \param[in] modified Modification time of the \a file. */
+  bool isUpToDate( const QString& file, const QDateTime& modified )
+  {
+    const auto fileIter = filesUpToDate.find( file );
+    if( fileIter == filesUpToDate.end() ) {
+      return false;
+    }
+    if( modified == fileIter.value() ) {
+      return true;
+    }
+    filesUpToDate.erase( fileIter );
+    return false;
+  }
+  // ------------------------------------------
+
+  /*! \brief Check if the \a file can be read from the \a snapshot.
+   *
+   * Files that are open in an editor are kept up to date by the editor, for
+   * other files the document in the snapshot must be from the file as it is
+   * on disk, given by its \a modified time. */
+  static bool isCurrentInSnapshot( const CPlusPlus::Snapshot& snapshot, const QString& file, const QDateTime& modified )
+  {
+    static CppTools::CppModelManager* modelManager = CppTools::CppModelManager::instance();
+    const CPlusPlus::Document::Ptr document        = snapshot.document( Utils::FilePath::fromString( file ) );
+    if( ( document.isNull() == true )
+        || ( modelManager->cppEditorDocument( file ) != nullptr ) ) {
+      return false;
+    }
+    return ( document->lastModified() == modified );
+  }
+  // ------------------------------------------
+
+  /*! \brief Cancel the futures reading documents from the snapshot and wait
+   * for them to finish.
+   *
+   * Futures that finish can queue more files, thus this is repeated until
+   * no futures are left. The mutex can not be locked while waiting since
+   * the futures lock it when they finish. */
+  void cancelSnapshotFutures()
+  {
+    forever {
+      QList<QFuture<void>> futures;
+      {
+        QMutexLocker locker( &fileQeueMutex );
+        futures.swap( snapshotFutures );
+      }
+      if( futures.isEmpty() == true ) {
+        return;
+      }
+      for( QFuture<void>& future: futures ) {
+        future.cancel();
+      }
+      for( QFuture<void>& future: futures ) {
+        future.waitForFinished();
+      }
+    }
+  }
+  // ------------------------------------------
 };
 // --------------------------------------------------
 // --------------------------------------------------
@@ -393,11 +930,23 @@ CppDocumentParser::CppDocumentParser( QObject* parent )
   d->settings->loadFromSettings( Core::ICore::settings() );
   connect(                d->settings,               &CppParserSettings::settingsChanged,                                this, &CppDocumentParser::settingsChanged );
   connect( SpellCheckerCore::instance()->settings(), &SpellChecker::Internal::SpellCheckerCoreSettings::settingsChanged, this, &CppDocumentParser::settingsChanged );
+  d->defaultCodec = Core::EditorManager::defaultTextCodec();
   /* Crete the options page for the parser */
   d->optionsPage = new CppParserOptionsPage( d->settings, this );
 
   CppTools::CppModelManager* modelManager = CppTools::CppModelManager::instance();
   connect( modelManager, &CppTools::CppModelManager::documentUpdated, this, &CppDocumentParser::parseCppDocumentOnUpdate, Qt::DirectConnection );
+#ifdef BENCH_TIME
+  /* The latency is measured until the core underlined the mistakes, that
+   * is when the user sees them. */
+  connect( SpellCheckerCore::instance(), &SpellCheckerCore::mistakesShown, this, [this]( const QString& fileName ) {
+    const QElapsedTimer shownTimer = d->shownTimers.take( fileName );
+    if( shownTimer.isValid() == true ) {
+      qDebug() << "Update to mistakes shown: " << fileName
+               << "\n  - latency (ms): " << shownTimer.elapsed();
+    }
+  } );
+#endif /* BENCH_TIME */
   connect(         qApp, &QApplication::aboutToQuit,                  this, [=]() {
           /* Disconnect any signals that might still get emitted. */
           modelManager->disconnect( this );
@@ -435,10 +984,21 @@ Core::IOptionsPage* CppDocumentParser::optionsPage()
 }
 // --------------------------------------------------
 
+QString CppDocumentParser::settingsIdentity()
+{
+  return displayName() + QLatin1Char( ':' ) + d->settings->identity();
+}
+// --------------------------------------------------
+
 void CppDocumentParser::setActiveProject( ProjectExplorer::Project* activeProject )
 {
   d->activeProject = activeProject;
   d->filesInStartupProject.clear();
+  {
+    /* Restored results of the previous project no longer apply. */
+    QMutexLocker locker( &d->fileQeueMutex );
+    d->filesUpToDate.clear();
+  }
 
   /* Call reparseProject() to reset and clean up properly.
    * The logic inside will ensure that parsing is not started again
@@ -449,12 +1009,19 @@ void CppDocumentParser::setActiveProject( ProjectExplorer::Project* activeProjec
 
 void CppDocumentParser::updateProjectFiles( QStringSet filesAdded, QStringSet filesRemoved )
 {
-  Q_UNUSED( filesRemoved )
+  /* The hashes of removed files will not be used again. */
+  for( const QString& file: qAsConst( filesRemoved ) ) {
+    d->tokenHashes.remove( file );
+  }
   const QStringSet fileSet = d->getCppFiles( filesAdded );
   d->filesInStartupProject.unite( fileSet );
+  const PriorityFileQueue::RankedFiles rankedFiles = PriorityFileQueue::rankFiles( fileSet );
   {
     QMutexLocker locker( &d->fileQeueMutex );
-    d->filesToUpdate.insert( fileSet.cbegin(), fileSet.cend() );
+    for( const QString& file: qAsConst( filesRemoved ) ) {
+      d->filesUpToDate.remove( file );
+    }
+    d->filesToUpdate.insert( rankedFiles );
   }
   queueFilesForUpdate();
 }
@@ -463,6 +1030,56 @@ void CppDocumentParser::updateProjectFiles( QStringSet filesAdded, QStringSet fi
 void CppDocumentParser::setCurrentEditor( const QString& editorFilePath )
 {
   d->currentEditorFileName = editorFilePath;
+  /* Parse the files of the editors before the other files that are still
+   * waiting. */
+  updateEditorPriorities();
+}
+// --------------------------------------------------
+
+void CppDocumentParser::updateEditorPriorities()
+{
+  QStringSet openEditors;
+  const QList<Core::IDocument*> documents = Core::DocumentModel::openedDocuments();
+  for( const Core::IDocument* document: documents ) {
+    openEditors.insert( document->filePath().toString() );
+  }
+
+  QMutexLocker locker( &d->fileQeueMutex );
+  d->filesToUpdate.setEditors( d->currentEditorFileName, openEditors );
+}
+// --------------------------------------------------
+
+void CppDocumentParser::addFilesUpToDate( const QStringSet& files )
+{
+  /* Read the modification times before taking the lock, the workers that
+   * get updates from the code model need it. */
+  QHash<QString, QDateTime> modified;
+  modified.reserve( files.size() );
+  for( const QString& file: files ) {
+    modified.insert( file, QFileInfo( file ).lastModified() );
+  }
+  QMutexLocker locker( &d->fileQeueMutex );
+  d->filesUpToDate.unite( modified );
+}
+// --------------------------------------------------
+
+void CppDocumentParser::reparseFiles( const QStringSet& files )
+{
+  const QStringSet fileSet = d->getCppFiles( files );
+  if( fileSet.isEmpty() == true ) {
+    return;
+  }
+  const PriorityFileQueue::RankedFiles rankedFiles = PriorityFileQueue::rankFiles( fileSet );
+  {
+    /* The restored results were checked against the previous dictionary,
+     * thus the files are no longer up to date. */
+    QMutexLocker locker( &d->fileQeueMutex );
+    for( const QString& file: fileSet ) {
+      d->filesUpToDate.remove( file );
+    }
+    d->filesToUpdate.insert( rankedFiles );
+  }
+  queueFilesForUpdate();
 }
 // --------------------------------------------------
 
@@ -473,13 +1090,22 @@ void CppDocumentParser::parseCppDocumentOnUpdate( CPlusPlus::Document::Ptr docPt
   }
 
   const QString fileName = docPtr->fileName();
-  const bool shouldParse = shouldParseDocument( fileName );
+  bool shouldParse       = shouldParseDocument( fileName );
 
   bool queueMore;
   {
     QMutexLocker locker( &d->fileQeueMutex );
+    /* The code model parses all files of a project when it is opened. Files
+     * of which the results were restored do not have to be parsed again,
+     * unless the update comes from an editor that changed the document. The
+     * document has the modification time of the file that it was read from. */
+    if( ( shouldParse == true )
+        && ( docPtr->editorRevision() == 0 )
+        && ( d->isUpToDate( fileName, docPtr->lastModified() ) == true ) ) {
+      shouldParse = false;
+    }
     /* Remove from the list to update since it will be updated now */
-    d->eraseIfFound( d->filesToUpdate, fileName );
+    d->filesToUpdate.remove( fileName );
     /* Always try to queue more if there are more files to update.
      * The logic inside queueFilesForUpdate() will ensure that there
      * are no more added than what is desired. */
@@ -493,8 +1119,13 @@ void CppDocumentParser::parseCppDocumentOnUpdate( CPlusPlus::Document::Ptr docPt
      * processed at the same time. */
     if( shouldParse == false ) {
       d->eraseIfFound( d->filesInProcess, fileName );
+      d->inFlight.cancelled( fileName );
     } else {
       d->filesInProcess.insert( fileName );
+      d->inFlight.started( fileName );
+#ifdef BENCH_TIME
+      d->updateTimers[fileName].start();
+#endif /* BENCH_TIME */
     }
   }
 
@@ -512,6 +1143,12 @@ void CppDocumentParser::settingsChanged()
 {
   /* Clear the hashes since all comments must be re parsed. */
   d->tokenHashes.clear();
+  d->sharedTokens.clear();
+  {
+    /* Restored results were extracted with the old settings. */
+    QMutexLocker locker( &d->fileQeueMutex );
+    d->filesUpToDate.clear();
+  }
   /* Re parse the project */
   reparseProject();
 }
@@ -520,7 +1157,10 @@ void CppDocumentParser::settingsChanged()
 void CppDocumentParser::reparseProject()
 {
   /* Need to cancel all futures in process.
-   * This function call will block until all are cancelled and done. */
+   * This function call will block until all are cancelled and done.
+   * The documents that are read from the snapshot are cancelled first since
+   * they can still start new futures. */
+  d->cancelSnapshotFutures();
   d->futureWatchers.cancell();
   /* Clear other members. */
   d->filesInStartupProject.clear();
@@ -537,12 +1177,15 @@ void CppDocumentParser::reparseProject()
   const QStringSet fileSet = d->getCppFiles( fileList.toSet() );
   d->filesInStartupProject = fileSet;
 
+  updateEditorPriorities();
+  const PriorityFileQueue::RankedFiles rankedFiles = PriorityFileQueue::rankFiles( fileSet );
   {
     /* Add the files to the waiting queue and then process the queue */
     QMutexLocker locker( &d->fileQeueMutex );
     d->filesInProcess.clear();
+    d->inFlight.reset();
     d->filesToUpdate.clear();
-    d->filesToUpdate = Utils::transform<std::set<QString>>( fileSet, []( const QString& string ) { return string; } );
+    d->filesToUpdate.insert( rankedFiles );
   }
 
   queueFilesForUpdate();
@@ -557,30 +1200,90 @@ void CppDocumentParser::queueFilesForUpdate()
   QStringSet filesToUpdate;
   size_t filesOutstanding;
   size_t filesInProcess;
+  QString status;
+  /* Files that the code model already parsed do not have to be parsed again
+   * by the code model, they are read from its snapshot. Asking the code model
+   * to update them would parse them a second time only to get the
+   * documentUpdated() signal. */
+  const bool useSnapshot             = d->settings->useCodeModelSnapshot;
+  const CPlusPlus::Snapshot snapshot = ( useSnapshot == true ) ? modelManager->snapshot() : CPlusPlus::Snapshot();
 
   {
     QMutexLocker locker( &d->fileQeueMutex );
-    auto fileIter = d->filesToUpdate.begin();
-    while( ( d->filesInProcess.size() < 10 )
+    /* The number of files in process adapts to how fast files are done, see
+     * InFlightWindow. */
+    d->inFlight.setWorkerCount( SpellCheckerCore::instance()->threadPool()->workerCount() );
+    while( ( d->filesInProcess.size() < d->inFlight.size() )
            && ( d->filesToUpdate.empty() == false ) ) {
-      const QString file = ( *fileIter );
-      fileIter = d->filesToUpdate.erase( fileIter );
-      if( shouldParseDocument( file ) == true ) {
+      QDateTime modified;
+      const QString file = d->filesToUpdate.takeFirst( modified );
+      if( ( shouldParseDocument( file ) == true )
+          && ( d->isUpToDate( file, modified ) == false ) ) {
         d->filesInProcess.insert( file );
-        filesToUpdate.insert( file );
+        d->inFlight.started( file );
+        if( ( useSnapshot == true )
+            && ( d->isCurrentInSnapshot( snapshot, file, modified ) == true ) ) {
+          QThreadPool* pool = SpellCheckerCore::instance()->threadPool()->pool( SpellCheckerThreadPool::Lane::Bulk );
+          d->snapshotFutures.append( Utils::runAsync( pool, QThread::LowPriority, &CppDocumentParser::parseSnapshotDocument, this, snapshot, file ) );
+        } else {
+          filesToUpdate.insert( file );
+        }
       }
     }
+    /* Only keep the futures that can still be cancelled. */
+    d->snapshotFutures.erase( std::remove_if( d->snapshotFutures.begin(), d->snapshotFutures.end(), []( const QFuture<void>& future ) {
+      return future.isFinished();
+    } ), d->snapshotFutures.end() );
 
     filesOutstanding = d->filesToUpdate.size();
     filesInProcess   = d->filesInProcess.size();
+    status           = d->inFlight.diagnostics();
   }
 
-  d->progressObject.update( d->filesInStartupProject.count(), int32_t( filesOutstanding ), int32_t( filesInProcess ) );
+  d->progressObject.update( d->filesInStartupProject.count(), int32_t( filesOutstanding ), int32_t( filesInProcess ), status );
 
   modelManager->updateSourceFiles( filesToUpdate );
 }
 // --------------------------------------------------
 
+void CppDocumentParser::parseSnapshotDocument( QFutureInterface<void>& future, const CPlusPlus::Snapshot& snapshot, const QString& fileName )
+{
+  if( future.isCanceled() == true ) {
+    return;
+  }
+  /* The documents in the snapshot do not keep their source and tokens. The
+   * source is read again and preprocessed with the macros from the
+   * snapshot, which is a lot less work than the code model parsing the
+   * file again. */
+  QByteArray source;
+  QString error;
+  if( Utils::TextFileFormat::readFileUTF8( fileName, d->defaultCodec, &source, &error ) != Utils::TextFileFormat::ReadSuccess ) {
+    /* Let the code model try, it will report the error if there is one. */
+    static CppTools::CppModelManager* modelManager = CppTools::CppModelManager::instance();
+    modelManager->updateSourceFiles( { fileName } );
+    return;
+  }
+  const Utils::FilePath filePath  = Utils::FilePath::fromString( fileName );
+  CPlusPlus::Document::Ptr docPtr = snapshot.preprocessedDocument( source, filePath );
+  /* Keep the modification time of the document that the snapshot has, it
+   * was compared with the file when it was queued. */
+  docPtr->setLastModified( snapshot.document( filePath )->lastModified() );
+  /* The words that appear in the source are taken from the symbols of the
+   * document, like the code model does they need a parse and a check. Only
+   * the tokens are needed otherwise. */
+  if( d->settings->removeWordsThatAppearInSource == true ) {
+    docPtr->parse();
+    docPtr->check( CPlusPlus::Document::FastCheck );
+  } else {
+    docPtr->tokenize();
+  }
+  if( future.isCanceled() == true ) {
+    return;
+  }
+  parseCppDocumentOnUpdate( std::move( docPtr ) );
+}
+// --------------------------------------------------
+
 bool CppDocumentParser::shouldParseDocument( const QString& fileName )
 {
   SpellChecker::Internal::SpellCheckerCoreSettings* settings = SpellCheckerCore::instance()->settings();
@@ -608,32 +1311,71 @@ void CppDocumentParser::futureFinished()
    * classes since the template class does not have the Q_OBJECT macro. */
   auto watcher = reinterpret_cast<CppDocumentProcessor::WatcherPtr>( sender() );
   SP_CHECK( watcher != nullptr );
+  watcher->deleteLater();
   if( watcher->isCanceled() == true ) {
-    /* Application is shutting down or settings changed etc.
+    /* Application is shutting down, settings changed or a newer revision
+     * of the file is processed etc.
      * If a watcher was cancelled, it would already be removed out of
      * the list of watchers, thus no need to do anything more. */
     return;
   }
-  const CppDocumentProcessor::ResultType result = watcher->result();
 
-  const QString fileName = d->futureWatchers.remove( watcher );
-  if( fileName == d->currentEditorFileName ) {
-    /* Move the new list of hashes to the member data so that
-     * it can be used the next time around. Move is made explicit since
-     * the LHS can be removed and the RHS will not be used again from
-     * here on. */
-    d->tokenHashes = std::move( result.wordHashes );
+  quint32 hashGeneration = 0;
+  const QString fileName = d->futureWatchers.remove( watcher, hashGeneration );
+  if( fileName.isEmpty() == true ) {
+    /* The processor finished before it could be cancelled when a newer
+     * revision of the file was given to another processor. Its words no
+     * longer match the file, the newer processor will report the words
+     * and keeps the file in process. */
+    return;
   }
-
+  CppDocumentProcessor::ResultType result = watcher->result();
+  /* Move the new list of hashes to the cache so that it can be used the
+   * next time that the file is parsed. Move is made explicit since the
+   * hashes will not be used again from here on. */
+  d->tokenHashes.recordTokens( result.reusedTokens, result.wordHashes.size() );
+  d->tokenHashes.insert( fileName, std::move( result.wordHashes ), hashGeneration );
+
+#ifdef BENCH_TIME
+  QElapsedTimer updateTimer;
+#endif /* BENCH_TIME */
   {
     QMutexLocker locker( &d->fileQeueMutex );
     d->eraseIfFound( d->filesInProcess, fileName );
+    d->inFlight.finished( fileName, result.serviceNsecs );
+#ifdef BENCH_TIME
+    updateTimer = d->updateTimers.take( fileName );
+    if( ( d->filesInProcess.empty() == true )
+        && ( d->filesToUpdate.empty() == true ) ) {
+      qDebug() << "Token hash cache:" << d->tokenHashes.statistics()
+               << "\nShared tokens:" << d->sharedTokens.statistics()
+               << "\nIn flight:" << d->inFlight.diagnostics();
+    }
+#endif /* BENCH_TIME */
   }
   queueFilesForUpdate();
 
   /* Now that we have all of the words from the parser, emit the signal
-   * so that they will get spell checked. */
-  emit spellcheckWordsParsed( fileName, result.words );
+   * so that they will get spell checked. If the processor already checked
+   * them, the mistakes are passed along and the core only has to show them. */
+  if( result.checked == true ) {
+    emit spellcheckWordsChecked( fileName, result.words, result.mistakes, result.dictionaryRevision );
+  } else {
+    emit spellcheckWordsParsed( fileName, result.words );
+  }
+#ifdef BENCH_TIME
+  /* Only the mistakes of the current editor are shown, the core stops the
+   * timer when it shows them. The time taken up to here is logged as well
+   * to see how much of the latency is spent in the core. */
+  if( updateTimer.isValid() == true ) {
+    qDebug() << "Update to words given to core: " << fileName
+             << "\n  - latency (ms): " << updateTimer.elapsed()
+             << "\n  - checked     : " << result.checked;
+    if( fileName == d->currentEditorFileName ) {
+      d->shownTimers.insert( fileName, updateTimer );
+    }
+  }
+#endif /* BENCH_TIME */
 }
 // --------------------------------------------------
 
@@ -649,14 +1391,30 @@ void CppDocumentParser::parseCppDocument( CPlusPlus::Document::Ptr docPtr )
   using WatcherPtr = CppDocumentProcessor::WatcherPtr;
   using ResultType = CppDocumentProcessor::ResultType;
   const QString fileName = docPtr->fileName();
-  HashWords hashes;
-  if( fileName == d->currentEditorFileName ) {
-    hashes = d->tokenHashes.get();
-  }
+  quint32 hashGeneration = 0;
+  const HashWords hashes = d->tokenHashes.get( fileName, hashGeneration );
+  /* Get the generation of the shared tokens before the settings are copied,
+   * tokens processed with settings from before a change are then ignored. */
+  const quint32 sharedGeneration = d->sharedTokens.generation();
   /* Create a document parser and move it to the main thread.
    * Not sure if this is required but it seemed like a good
    * idea since this will be in a QThreadPool thread. */
-  CppDocumentProcessor* parser = new CppDocumentProcessor( docPtr, hashes, *d->settings );
+  CppDocumentProcessor* parser = new CppDocumentProcessor( docPtr, hashes, *d->settings, &d->sharedTokens, sharedGeneration );
+  /* Let the processor check the words as well, so that the file only needs a
+   * single task. The revision is taken before the spell checker so that a
+   * change in between causes the words to be checked again. */
+  SpellCheckerCore* core           = SpellCheckerCore::instance();
+  const quint32 dictionaryRevision = core->dictionaryRevision();
+  ISpellChecker* spellChecker      = core->spellChecker();
+  /* A spell checker that is not ready is left to the core, which checks
+   * the words once it is ready. */
+  if( ( spellChecker != nullptr )
+      && ( spellChecker->isReady() == true ) ) {
+    /* See SpellCheckerCore::spellcheckWordsFromParser() for the suggestions. */
+    const bool fetchSuggestions = ( ( fileName == d->currentEditorFileName )
+                                    || ( core->settings()->lazySuggestions == false ) );
+    parser->setSpellChecker( spellChecker, dictionaryRevision, fetchSuggestions );
+  }
   parser->moveToThread( qApp->thread() );
   /* Reset the document pointer so that it can be released as soon as it is
    * done in the processor. The processor makes its own copy to keep it
@@ -673,58 +1431,332 @@ void CppDocumentParser::parseCppDocument( CPlusPlus::Document::Ptr docPtr )
   connect( watcher, &Watcher::finished, this,   &CppDocumentParser::futureFinished, Qt::QueuedConnection );
   connect( watcher, &Watcher::finished, parser, &CppDocumentProcessor::deleteLater );
   /* Keep track of the watchers so that they can be cancelled as needed. */
-  d->futureWatchers.add( watcher, fileName );
+  d->futureWatchers.add( watcher, fileName, hashGeneration );
   /* Create a future to process the file.
-   * If the file to process is the current open editor, it is parsed in a new
-   * thread with high priority.
-   * If it is not the current file, it is added to the global thread pool
-   * since it can get processed in its own time.
-   * The current one gets a new thread so that it can get processed as
+   * If the file to process is the current open editor, it is parsed in the
+   * interactive lane with high priority.
+   * If it is not the current file, it is added to the bulk lane since it can
+   * get processed in its own time.
+   * The current one gets its own lane so that it can get processed as
    * soon as possible and it does not need to get queued along with all other
-   * futures added to the global thread pool. */
+   * futures of the project. */
+  SpellCheckerThreadPool* threadPool = core->threadPool();
   if( fileName == d->currentEditorFileName ) {
-    QFuture<ResultType> future = Utils::runAsync( QThread::HighPriority, &CppDocumentProcessor::process, parser );
+    QFuture<ResultType> future = Utils::runAsync( threadPool->pool( SpellCheckerThreadPool::Lane::Interactive ), QThread::HighPriority, &CppDocumentProcessor::process, parser );
     watcher->setFuture( future );
   } else {
-    QFuture<ResultType> future = Utils::runAsync( QThreadPool::globalInstance(), QThread::NormalPriority, &CppDocumentProcessor::process, parser );
+    QFuture<ResultType> future = Utils::runAsync( threadPool->pool( SpellCheckerThreadPool::Lane::Bulk ), QThread::NormalPriority, &CppDocumentProcessor::process, parser );
     watcher->setFuture( future );
   }
 }
 // --------------------------------------------------
 
-void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings, const QString& string, const QStringSet& wordsInSource, WordList& words )
+namespace {
+
+/*! \brief Features of the characters in a word.
+ *
+ * The features are collected in a single pass over the word by
+ * classifyWord(). The settings are then applied to the word by testing
+ * the features instead of matching regular expressions against the word.
+ * Unless stated otherwise the features only look at ASCII characters, the
+ * same as the character classes in the regular expressions used before. */
+enum WordFeature : quint32 {
+  HasDigit        = 0x0001 /*!< Contains a digit, [0-9]. */,
+  HasLower        = 0x0002 /*!< Contains a lower case letter, [a-z]. */,
+  HasUpper        = 0x0004 /*!< Contains an upper case letter, [A-Z]. */,
+  HasUnderscore   = 0x0008 /*!< Contains an underscore. */,
+  HasDot          = 0x0010 /*!< Contains a '.'. */,
+  HasAt           = 0x0020 /*!< Contains a '@'. */,
+  HasWebsiteChar  = 0x0040 /*!< Contains a website character, [/:?=#%-]. */,
+  HasOther        = 0x0080 /*!< Contains any other ASCII character. */,
+  HasNonAscii     = 0x0100 /*!< Contains a character that is not ASCII. */,
+  HasNonHex       = 0x0200 /*!< Contains a character that is not a hex digit. */,
+  HasCamelCase    = 0x0400 /*!< Contains [a-z]+[A-Z]+[a-z]. */,
+  HasWebsiteDot   = 0x0800 /*!< Contains \w\.[0-9A-z./?=#%-], the website address pattern. */
+};
+
+/*! \brief Character that can follow the dot in a website address, [0-9A-z./?=#%-]. */
+inline bool isWebsiteAddressChar( ushort character )
+{
+  return ( ( character >= '0' ) && ( character <= '9' ) )
+         || ( ( character >= 'A' ) && ( character <= 'z' ) )
+         || ( character == '.' ) || ( character == '/' ) || ( character == '?' ) || ( character == '=' )
+         || ( character == '#' ) || ( character == '%' ) || ( character == '-' );
+}
+// --------------------------------------------------
+
+/*! \brief Character that is a website character, [/:?=#%-]. */
+inline bool isWebsiteChar( ushort character )
+{
+  return ( character == '/' ) || ( character == ':' ) || ( character == '?' ) || ( character == '=' )
+         || ( character == '#' ) || ( character == '%' ) || ( character == '-' );
+}
+// --------------------------------------------------
+
+/*! \brief ASCII word character, \w without Unicode properties. */
+inline bool isAsciiWordChar( ushort character )
+{
+  return ( ( character >= 'a' ) && ( character <= 'z' ) )
+         || ( ( character >= 'A' ) && ( character <= 'Z' ) )
+         || ( ( character >= '0' ) && ( character <= '9' ) )
+         || ( character == '_' );
+}
+// --------------------------------------------------
+
+inline bool isAsciiLetter( ushort character )
+{
+  return ( ( character >= 'a' ) && ( character <= 'z' ) )
+         || ( ( character >= 'A' ) && ( character <= 'Z' ) );
+}
+// --------------------------------------------------
+
+/*! \brief Collect the WordFeature flags of the word in a single pass. */
+quint32 classifyWord( const QString& word )
+{
+  const ushort* data = word.utf16();
+  const int length   = word.length();
+  quint32 features   = 0;
+  /* State for the camelCase pattern: 0 if nothing matched, 1 after lower case
+   * letters, 2 after lower case letters followed by upper case letters. */
+  int camelCaseState = 0;
+  for( int idx = 0; idx < length; ++idx ) {
+    const ushort character = data[idx];
+    if( ( character >= 'a' ) && ( character <= 'z' ) ) {
+      features |= HasLower;
+      if( character > 'f' ) {
+        features |= HasNonHex;
+      }
+      if( camelCaseState == 2 ) {
+        features |= HasCamelCase;
+      }
+      camelCaseState = 1;
+      continue;
+    }
+    if( ( character >= 'A' ) && ( character <= 'Z' ) ) {
+      features |= HasUpper;
+      if( character > 'F' ) {
+        features |= HasNonHex;
+      }
+      camelCaseState = ( camelCaseState != 0 ) ? 2 : 0;
+      continue;
+    }
+    camelCaseState = 0;
+    if( ( character >= '0' ) && ( character <= '9' ) ) {
+      features |= HasDigit;
+      continue;
+    }
+    features |= HasNonHex;
+    if( character == '_' ) {
+      features |= HasUnderscore;
+    } else if( character == '.' ) {
+      features |= HasDot;
+      if( ( idx > 0 ) && ( idx + 1 < length )
+          && ( isAsciiWordChar( data[idx - 1] ) == true )
+          && ( isWebsiteAddressChar( data[idx + 1] ) == true ) ) {
+        features |= HasWebsiteDot;
+      }
+    } else if( character == '@' ) {
+      features |= HasAt;
+    } else if( isWebsiteChar( character ) == true ) {
+      features |= HasWebsiteChar;
+    } else if( character < 128 ) {
+      features |= HasOther;
+    } else {
+      features |= HasNonAscii;
+    }
+  }
+  return features;
+}
+// --------------------------------------------------
+
+/*! \brief Check if the word is a number, \A\d+(\.\d+)?\z.
+ *
+ * The word must only have digits and dots in it. */
+bool isNumber( const QString& word )
+{
+  const int dot = word.indexOf( QLatin1Char( '.' ) );
+  if( dot == -1 ) {
+    return word.isEmpty() == false;
+  }
+  return ( dot > 0 )
+         && ( dot < word.length() - 1 )
+         && ( word.indexOf( QLatin1Char( '.' ), dot + 1 ) == -1 );
+}
+// --------------------------------------------------
+
+/*! \brief Check if the word is an email address.
+ *
+ * This is the same as matching the whole word against the
+ * EMAIL_ADDRESS_REGEXP_PATTERN: [\w\-\.]+@((?:[\w]+\.)+)[a-zA-Z]{2,4} */
+bool isEmailAddress( const QString& word )
 {
-  using namespace SpellChecker::Parsers::CppParser;
+  const ushort* data = word.utf16();
+  const int length   = word.length();
+  int idx            = 0;
+  /* Name part, up to the '@'. */
+  while( ( idx < length )
+         && ( ( isAsciiWordChar( data[idx] ) == true )
+              || ( data[idx] == '-' )
+              || ( data[idx] == '.' ) ) ) {
+    ++idx;
+  }
+  if( ( idx == 0 ) || ( idx == length ) || ( data[idx] != '@' ) ) {
+    return false;
+  }
+  ++idx;
+  /* Domain parts, each ending in a '.', followed by 2 to 4 letters. */
+  int domainParts = 0;
+  int partLength  = 0;
+  for( ; idx < length; ++idx ) {
+    if( data[idx] == '.' ) {
+      if( partLength == 0 ) {
+        return false;
+      }
+      ++domainParts;
+      partLength = 0;
+    } else if( isAsciiWordChar( data[idx] ) == true ) {
+      ++partLength;
+    } else {
+      return false;
+    }
+  }
+  if( ( domainParts == 0 ) || ( partLength < 2 ) || ( partLength > 4 ) ) {
+    return false;
+  }
+  for( idx = length - partLength; idx < length; ++idx ) {
+    if( isAsciiLetter( data[idx] ) == false ) {
+      return false;
+    }
+  }
+  return true;
+}
+// --------------------------------------------------
 
+/*! \brief Check if the word is a hex number, \A0x[0-9A-Fa-f]+\z. */
+bool isHexNumber( const QString& word )
+{
+  const ushort* data = word.utf16();
+  const int length   = word.length();
+  if( ( length < 3 ) || ( data[0] != '0' ) || ( data[1] != 'x' ) ) {
+    return false;
+  }
+  for( int idx = 2; idx < length; ++idx ) {
+    const ushort character = data[idx];
+    if( ( ( character >= '0' ) && ( character <= '9' ) )
+        || ( ( character >= 'a' ) && ( character <= 'f' ) )
+        || ( ( character >= 'A' ) && ( character <= 'F' ) ) ) {
+      continue;
+    }
+    return false;
+  }
+  return true;
+}
+// --------------------------------------------------
+
+/*! \brief Add the part of the word as a new word to the list.
+ *
+ * The new word gets the same location information as the word, offset
+ * by the position of the part in the word. */
+void appendPartOfWord( const Word& word, int offset, int length, WordList& wordList )
+{
+  Word newWord;
+  newWord.text         = word.text.mid( offset, length );
+  newWord.fileName     = word.fileName;
+  newWord.columnNumber = word.columnNumber + offset;
+  newWord.lineNumber   = word.lineNumber;
+  newWord.length       = length;
+  newWord.start        = word.start + offset;
+  newWord.end          = newWord.start + length;
+  newWord.inComment    = word.inComment;
+  wordList.append( newWord );
+}
+// --------------------------------------------------
+
+/*! \brief Split the word on the separator characters.
+ *
+ * Runs of separators are removed from the word and the parts between them
+ * are added to the list, the same as QString::split() with
+ * QString::SkipEmptyParts. */
+template<typename IsSeparator>
+void splitWord( const Word& word, IsSeparator isSeparator, WordList& wordList )
+{
+  const ushort* data = word.text.utf16();
+  const int length   = word.text.length();
+  int idx            = 0;
+  while( idx < length ) {
+    while( ( idx < length ) && ( isSeparator( data[idx] ) == true ) ) {
+      ++idx;
+    }
+    const int partStart = idx;
+    while( ( idx < length ) && ( isSeparator( data[idx] ) == false ) ) {
+      ++idx;
+    }
+    if( idx > partStart ) {
+      appendPartOfWord( word, partStart, idx - partStart, wordList );
+    }
+  }
+}
+// --------------------------------------------------
+
+/*! \brief Split the word in camelCase on each lower case letter followed
+ * by an upper case letter. */
+void splitWordOnCamelCase( const Word& word, WordList& wordList )
+{
+  const ushort* data = word.text.utf16();
+  const int length   = word.text.length();
+  int partStart      = 0;
+  for( int idx = 1; idx < length; ++idx ) {
+    if( ( data[idx - 1] >= 'a' ) && ( data[idx - 1] <= 'z' )
+        && ( data[idx] >= 'A' ) && ( data[idx] <= 'Z' ) ) {
+      appendPartOfWord( word, partStart, idx - partStart, wordList );
+      partStart = idx;
+    }
+  }
+  appendPartOfWord( word, partStart, length - partStart, wordList );
+}
+// --------------------------------------------------
+
+} // namespace
+
+void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings, const QString& string, const QStringSet& wordsInSource, WordList& words, QStringList* checkedWords )
+{
+  if( checkedWords != nullptr ) {
+    for( const Word& word: qAsConst( words ) ) {
+      checkedWords->append( word.text );
+    }
+  }
   /* Filter out words that appears in the source. They are checked against the list
    * of words parsed from the file before the for loop. */
   if( settings.removeWordsThatAppearInSource == true ) {
     removeWordsThatAppearInSource( wordsInSource, words );
   }
 
-  /* Regular Expressions that might be used, defined here so that it does not get cleared in the
-   * loop. They are made static const because they will be re-used a lot and will never be changed.
-   * This way the construction of the objects can be done once and then be re-used. */
-  static const QRegularExpression doubleRe( QStringLiteral( "\\A\\d+(\\.\\d+)?\\z" ), QRegularExpression::DontCaptureOption );
-  static const QRegularExpression hexRe( QStringLiteral( "\\A0x[0-9A-Fa-f]+\\z" ) );
-  static const QRegularExpression colorRe( QStringLiteral( "\\A([0-9A-Fa-f]{2}){3,4}\\z" ), QRegularExpression::DontCaptureOption );
-  static const QRegularExpression emailRe( QStringLiteral( "\\A" ) + QLatin1String( SpellChecker::Parsers::CppParser::Constants::EMAIL_ADDRESS_REGEXP_PATTERN ) + QStringLiteral( "\\z" ) );
-  static const QRegularExpression websiteRe( QString() + QLatin1String( SpellChecker::Parsers::CppParser::Constants::WEBSITE_ADDRESS_REGEXP_PATTERN ) );
-  static const QRegularExpression websiteCharsRe( QString() + QLatin1String( SpellChecker::Parsers::CppParser::Constants::WEBSITE_CHARS_REGEXP_PATTERN ) );
-
   /* Word list that can be added to in the case that a word is split up into different words
    * due to some setting or rule. These words can also be checked against the settings using
    * recursion or not. It depends on the implementation that did the splitting of the
    * original word. It is done in this way so that the iterator that is currently operating
    * on the list of words does not break when new words get added during iteration */
   WordList wordsToAddInTheEnd;
+  /* Words that came from splitting the current word. The split words are checked against
+   * the settings before they are added to the words that should be added in the end. */
+  WordList wordsFromSplit;
+  /* Words that are not removed by the settings. The words are moved to this list in
+   * the same order instead of erasing the removed words from the middle of the list. */
+  WordList keptWords;
+  keptWords.reserve( words.size() );
   /* Iterate through the list of words using an iterator and remove words according to settings */
-  WordList::Iterator iter = words.begin();
-  while( iter != words.end() ) {
-    const Word& word        = ( *iter );
-    QString currentWord     = word.text;
-    QString currentWordCaps = currentWord.toUpper();
-    bool removeCurrentWord  = false;
+  const WordList::Iterator wordsEnd = words.end();
+  for( WordList::Iterator iter = words.begin(); iter != wordsEnd; ++iter ) {
+    const Word& word           = ( *iter );
+    const QString& currentWord = word.text;
+    /* Classify the characters in the word once. The settings below then only need to
+     * test the features of the word. */
+    const quint32 features = classifyWord( currentWord );
+    /* Only lower case and non ASCII letters can change when converting the word to upper
+     * case. For all other words the upper case word is the word itself. */
+    const bool caseCanChange = ( features & ( HasLower | HasNonAscii ) ) != 0;
+    bool removeCurrentWord   = false;
+    bool splitCurrentWord    = false;
 
     /* Remove reserved words first. Although this does not depend on settings, this
      * is done here to prevent multiple iterations through the word list where possible */
@@ -734,18 +1766,26 @@ void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings,
       /* Remove the word if it is a number, checking for floats and doubles as well.
        * Or if it is a hex number
        * Or if it can be a color and it starts with a #, then it is a color.*/
-      removeCurrentWord = ( doubleRe.match( currentWord ).hasMatch() == true )
-                          || ( hexRe.match( currentWord ).hasMatch() == true )
-                          || ( ( colorRe.match( currentWord ).hasMatch() == true )
+      const int length  = currentWord.length();
+      removeCurrentWord = ( ( ( features & HasDigit ) != 0 )
+                            && ( ( features & ( HasLower | HasUpper | HasUnderscore | HasAt | HasWebsiteChar | HasOther | HasNonAscii ) ) == 0 )
+                            && ( isNumber( currentWord ) == true ) )
+                          || ( ( ( features & HasDigit ) != 0 )
+                               && ( isHexNumber( currentWord ) == true ) )
+                          || ( ( ( features & HasNonHex ) == 0 )
+                               && ( ( length == 6 ) || ( length == 8 ) )
                                && ( string.at( word.start - 1 ) == QLatin1Char( '#' ) ) );
-
     }
 
     if( ( removeCurrentWord == false ) && ( settings.checkQtKeywords == false ) ) {
       /* Remove the basic Qt Keywords using the isQtKeyword() function in the CppTools */
-      if( ( CppTools::isQtKeyword( QStringRef( &currentWord ) ) == true )
-          || ( CppTools::isQtKeyword( QStringRef( &currentWordCaps ) ) == true ) ) {
+      if( CppTools::isQtKeyword( QStringRef( &currentWord ) ) == true ) {
         removeCurrentWord = true;
+      } else if( caseCanChange == true ) {
+        const QString currentWordCaps = currentWord.toUpper();
+        if( CppTools::isQtKeyword( QStringRef( &currentWordCaps ) ) == true ) {
+          removeCurrentWord = true;
+        }
       }
       /* Remove words that Start with capital Q and the next char is also capital letter. This would
        * only apply to words longer than 2 characters long. This check is also to ensure that we do
@@ -768,34 +1808,29 @@ void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings,
     }
 
     if( ( settings.removeEmailAddresses == true ) && ( removeCurrentWord == false ) ) {
-      if( emailRe.match( currentWord ).hasMatch() == true ) {
+      if( ( ( features & HasAt ) != 0 )
+          && ( isEmailAddress( currentWord ) == true ) ) {
         removeCurrentWord = true;
       }
     }
 
-    /* Attempt to remove website addresses using the websiteRe Regular Expression. */
+    /* Attempt to remove website addresses. A word is a website address if it contains
+     * a word character followed by a dot and a character that can be part of an address. */
     if( ( settings.removeWebsites == true ) && ( removeCurrentWord == false ) ) {
-      if( websiteRe.match( currentWord ).hasMatch() == true ) {
+      if( ( features & HasWebsiteDot ) != 0 ) {
         removeCurrentWord = true;
-      } else if( currentWord.contains( websiteCharsRe ) == true ) {
-        QStringList wordsSplitOnWebChars = currentWord.split( websiteCharsRe, QString::SkipEmptyParts );
-        if( wordsSplitOnWebChars.isEmpty() == false ) {
-          /* String is not a website, check each component now */
-          removeCurrentWord = true;
-          WordList wordsFromSplit;
-          IDocumentParser::getWordsFromSplitString( wordsSplitOnWebChars, word, wordsFromSplit );
-          /* Apply the settings to the words that came from the split to filter out words that does
-           * not belong due to settings. After they have passed the settings, add the words that
-           * survived to the list of words that should be added in the end */
-          applySettingsToWords( settings, string, wordsInSource, wordsFromSplit );
-          wordsToAddInTheEnd.append( wordsFromSplit );
-        }
+      } else if( ( features & HasWebsiteChar ) != 0 ) {
+        splitWord( word, isWebsiteChar, wordsFromSplit );
+        /* If the word only consists of website characters, there is nothing to split. */
+        removeCurrentWord = ( wordsFromSplit.isEmpty() == false );
+        splitCurrentWord  = removeCurrentWord;
       }
     }
 
     if( ( settings.checkAllCapsWords == false ) && ( removeCurrentWord == false ) ) {
       /* Remove words that are all caps */
-      if( currentWord == currentWordCaps ) {
+      if( ( ( features & HasLower ) == 0 )
+          && ( ( caseCanChange == false ) || ( currentWord == currentWord.toUpper() ) ) ) {
         removeCurrentWord = true;
       }
     }
@@ -803,22 +1838,14 @@ void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings,
     if( ( settings.wordsWithNumberOption != CppParserSettings::LeaveWordsWithNumbers ) && ( removeCurrentWord == false ) ) {
       /* Before doing anything, check if the word contains any numbers. If it does then we can go to
        * the settings to handle the word differently */
-      static const QRegularExpression numberContainRe( QStringLiteral( "[0-9]" ) );
-      static const QRegularExpression numberSplitRe( QStringLiteral( "[0-9]+" ) );
-      if( currentWord.contains( numberContainRe ) == true ) {
+      if( ( features & HasDigit ) != 0 ) {
         /* Handle words with numbers based on the setting that is set for them */
         if( settings.wordsWithNumberOption == CppParserSettings::RemoveWordsWithNumbers ) {
           removeCurrentWord = true;
         } else if( settings.wordsWithNumberOption == CppParserSettings::SplitWordsOnNumbers ) {
           removeCurrentWord = true;
-          QStringList wordsSplitOnNumbers = currentWord.split( numberSplitRe, QString::SkipEmptyParts );
-          WordList wordsFromSplit;
-          IDocumentParser::getWordsFromSplitString( wordsSplitOnNumbers, word, wordsFromSplit );
-          /* Apply the settings to the words that came from the split to filter out words that does
-           * not belong due to settings. After they have passed the settings, add the words that
-           * survived to the list of words that should be added in the end */
-          applySettingsToWords( settings, string, wordsInSource, wordsFromSplit );
-          wordsToAddInTheEnd.append( wordsFromSplit );
+          splitCurrentWord  = true;
+          splitWord( word, []( ushort character ) { return ( character >= '0' ) && ( character <= '9' ); }, wordsFromSplit );
         } else {
           /* Should never get here */
           QTC_CHECK( false );
@@ -829,20 +1856,13 @@ void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings,
     if( ( settings.wordsWithUnderscoresOption != CppParserSettings::LeaveWordsWithUnderscores ) && ( removeCurrentWord == false ) ) {
       /* Check to see if the word has underscores in it. If it does then handle according to the
        * settings */
-      if( currentWord.contains( QLatin1Char( '_' ) ) == true ) {
+      if( ( features & HasUnderscore ) != 0 ) {
         if( settings.wordsWithUnderscoresOption == CppParserSettings::RemoveWordsWithUnderscores ) {
           removeCurrentWord = true;
         } else if( settings.wordsWithUnderscoresOption == CppParserSettings::SplitWordsOnUnderscores ) {
           removeCurrentWord = true;
-          static const QRegularExpression underscoreSplitRe( QStringLiteral( "_+" ) );
-          QStringList wordsSplitOnUnderScores = currentWord.split( underscoreSplitRe, QString::SkipEmptyParts );
-          WordList wordsFromSplit;
-          IDocumentParser::getWordsFromSplitString( wordsSplitOnUnderScores, word, wordsFromSplit );
-          /* Apply the settings to the words that came from the split to filter out words that does
-           * not belong due to settings. After they have passed the settings, add the words that
-           * survived to the list of words that should be added in the end */
-          applySettingsToWords( settings, string, wordsInSource, wordsFromSplit );
-          wordsToAddInTheEnd.append( wordsFromSplit );
+          splitCurrentWord  = true;
+          splitWord( word, []( ushort character ) { return character == '_'; }, wordsFromSplit );
         } else {
           /* Should never get here */
           QTC_CHECK( false );
@@ -858,50 +1878,15 @@ void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings,
        * camelCase. This will probably be updated as this gets tested. The current check checks for
        * one or more lower case letters,
        * followed by one or more upper-case letter, followed by a lower case letter */
-      static const QRegularExpression camelCaseContainsRe( QStringLiteral( "[a-z]{1,}[A-Z]{1,}[a-z]{1,}" ) );
-      static const QRegularExpression camelCaseIndexRe( QStringLiteral( "[a-z][A-Z]" ) );
-      if( currentWord.contains( camelCaseContainsRe ) == true ) {
+      if( ( features & HasCamelCase ) != 0 ) {
         if( settings.camelCaseWordOption == CppParserSettings::RemoveWordsInCamelCase ) {
           removeCurrentWord = true;
         } else if( settings.camelCaseWordOption == CppParserSettings::SplitWordsOnCamelCase ) {
           removeCurrentWord = true;
-          QStringList wordsSplitOnCamelCase;
-          /* Search the word for all indexes where there is a lower case letter followed by an upper
-           * case letter. This indexes are then later used to split the current word into a list of
-           * new words. 0 is added as the starting index, since the first word will start at 0. At
-           * the end the length
-           * of the word is also added, since the last word will stop at the end */
-          QList<int> indexes;
-          indexes << 0;
-          int currentIdx = 0;
-          int lastIdx    = 0;
-          bool finished  = false;
-          while( finished == false ) {
-            currentIdx = currentWord.indexOf( camelCaseIndexRe, lastIdx );
-            if( currentIdx == -1 ) {
-              finished = true;
-              indexes << currentWord.length();
-            } else {
-              lastIdx = currentIdx + 1;
-              indexes << lastIdx;
-            }
-          }
-          /* Now split the word on the indexes */
-          for( int idx = 0; idx < indexes.count() - 1; ++idx ) {
-            /* Get the word starting at the current index, up to the difference between the
-             * different index and the current index, since the second argument of QString::mid() is
-             * the length to extract and not the index of the last position */
-            QString word = currentWord.mid( indexes.at( idx ), indexes.at( idx + 1 ) - indexes.at( idx ) );
-            wordsSplitOnCamelCase << word;
-          }
-          WordList wordsFromSplit;
-          /* Get the proper word structures for the words extracted during the split */
-          IDocumentParser::getWordsFromSplitString( wordsSplitOnCamelCase, word, wordsFromSplit );
-          /* Apply the settings to the words that came from the split to filter out words that does
-           * not belong due to settings. After they have passed the settings, add the words that
-           * survived to the list of words that should be added in the end */
-          applySettingsToWords( settings, string, wordsInSource, wordsFromSplit );
-          wordsToAddInTheEnd.append( wordsFromSplit );
+          splitCurrentWord  = true;
+          /* Split the word at all indexes where there is a lower case letter followed by an upper
+           * case letter. */
+          splitWordOnCamelCase( word, wordsFromSplit );
         } else {
           /* Should never get here */
           QTC_CHECK( false );
@@ -913,20 +1898,13 @@ void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings,
     if( ( settings.wordsWithDotsOption != CppParserSettings::LeaveWordsWithDots ) && ( removeCurrentWord == false ) ) {
       /* Check to see if the word has dots in it.
        * If it does then handle according to the settings */
-      if( currentWord.contains( QLatin1Char( '.' ) ) == true ) {
+      if( ( features & HasDot ) != 0 ) {
         if( settings.wordsWithDotsOption == CppParserSettings::RemoveWordsWithDots ) {
           removeCurrentWord = true;
         } else if( settings.wordsWithDotsOption == CppParserSettings::SplitWordsOnDots ) {
           removeCurrentWord = true;
-          static const QRegularExpression dotsSplitRe( QStringLiteral( "\\.+" ) );
-          QStringList wordsSplitOnDots = currentWord.split( dotsSplitRe, QString::SkipEmptyParts );
-          WordList wordsFromSplit;
-          IDocumentParser::getWordsFromSplitString( wordsSplitOnDots, word, wordsFromSplit );
-          /* Apply the settings to the words that came from the split to filter out words that does
-           * not belong due to settings. After they have passed the settings, add the words that
-           * survived to the list of words that should be added in the end */
-          applySettingsToWords( settings, string, wordsInSource, wordsFromSplit );
-          wordsToAddInTheEnd.append( wordsFromSplit );
+          splitCurrentWord  = true;
+          splitWord( word, []( ushort character ) { return character == '.'; }, wordsFromSplit );
         } else {
           /* Should never get here */
           QTC_CHECK( false );
@@ -934,18 +1912,23 @@ void CppDocumentParser::applySettingsToWords( const CppParserSettings& settings,
       }
     }
 
-    /* Remove the current word if it should be removed. The word will get removed in place. The
-     * erase() function on the list will return an iterator to the next element. In this case,
-     * the iterator should not be incremented and the while loop should continue to the next
-     * element. */
-    if( removeCurrentWord == true ) {
-      iter = words.erase( iter );
-    } else {
-      ++iter;
+    if( splitCurrentWord == true ) {
+      /* Apply the settings to the words that came from the split to filter out words that does
+       * not belong due to settings. After they have passed the settings, add the words that
+       * survived to the list of words that should be added in the end */
+      applySettingsToWords( settings, string, wordsInSource, wordsFromSplit, checkedWords );
+      wordsToAddInTheEnd.append( wordsFromSplit );
+    }
+    wordsFromSplit.clear();
+
+    /* Keep the current word if it should not be removed. */
+    if( removeCurrentWord == false ) {
+      keptWords.append( std::move( *iter ) );
     }
   }
   /* Add the words that should be added in the end to the list of words */
-  words.append( wordsToAddInTheEnd );
+  keptWords.append( wordsToAddInTheEnd );
+  words = std::move( keptWords );
 }
 // --------------------------------------------------
 
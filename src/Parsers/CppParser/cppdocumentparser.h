@@ -25,6 +25,7 @@
 #include <cplusplus/CppDocument.h>
 #include <projectexplorer/projectexplorer.h>
 
+#include <QFutureInterface>
 #include <QObject>
 
 namespace CPlusPlus {
@@ -47,11 +48,14 @@ public:
   ~CppDocumentParser() Q_DECL_OVERRIDE;
   QString displayName() Q_DECL_OVERRIDE;
   Core::IOptionsPage* optionsPage() Q_DECL_OVERRIDE;
+  QString settingsIdentity() Q_DECL_OVERRIDE;
 
 protected:
   void setCurrentEditor( const QString& editorFilePath ) Q_DECL_OVERRIDE;
   void setActiveProject( ProjectExplorer::Project* activeProject ) Q_DECL_OVERRIDE;
   void updateProjectFiles( QStringSet filesAdded, QStringSet filesRemoved ) Q_DECL_OVERRIDE;
+  void addFilesUpToDate( const QStringSet& files ) Q_DECL_OVERRIDE;
+  void reparseFiles( const QStringSet& files ) Q_DECL_OVERRIDE;
 
 private:
   /*! \brief Queue files to be updated.
@@ -68,6 +72,20 @@ private:
    * If there are more than a set number of files that should still be parsed,
    * this function will create a progress notification. */
   void queueFilesForUpdate();
+  /*! \brief Parse a file of which the code model snapshot has a current document.
+   *
+   * Runs in a future started by queueFilesForUpdate(). The source of the file
+   * is preprocessed with the snapshot instead of asking the code model to
+   * parse the file again.
+   * \param[in] future Future interface used to check if the future was cancelled.
+   * \param[in] snapshot Snapshot of the code model that has the document.
+   * \param[in] fileName Name of the file. */
+  void parseSnapshotDocument( QFutureInterface<void>& future, const CPlusPlus::Snapshot& snapshot, const QString& fileName );
+  /*! \brief Give the files of the open editors priority over the other files
+   * that must still be parsed.
+   *
+   * Must be called from the GUI thread since it reads the open documents. */
+  void updateEditorPriorities();
 
 protected slots:
   void parseCppDocumentOnUpdate( CPlusPlus::Document::Ptr docPtr );
@@ -98,8 +116,11 @@ public:
    *                  setting words that appear in this list will be removed from the
    *                  final list of \a words.
    * \param[inout] words words that should be parsed. Words will be removed from this list
-   *                  based on the user settings.  */
-  static void applySettingsToWords( const CppParserSettings& settings, const QString& string, const QStringSet& wordsInSource, WordList& words );
+   *                  based on the user settings.
+   * \param[out] checkedWords If not null, the texts of all words that the settings were
+   *                  applied to, including the words that came from splitting a word,
+   *                  are appended to this list. */
+  static void applySettingsToWords( const CppParserSettings& settings, const QString& string, const QStringSet& wordsInSource, WordList& words, QStringList* checkedWords = nullptr );
 
 private:
   friend CppDocumentParserPrivate;
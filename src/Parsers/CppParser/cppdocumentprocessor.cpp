@@ -18,14 +18,28 @@
 ** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
 ****************************************************************************/
 
+#include "../../ISpellChecker.h"
 #include "cppdocumentparser.h"
 #include "cppdocumentprocessor.h"
 #include "cppparserconstants.h"
+#include "cppsharedtokencache.h"
+#include "cppwordscanner.h"
 
 #include <cplusplus/Overview.h>
 #include <cppeditor/cppeditordocument.h>
 #include <cpptools/cppdoxygen.h>
 
+#include <algorithm>
+
+#include <QElapsedTimer>
+
+// #define BENCH_TIME
+#ifdef BENCH_TIME
+#include <utils/qtcassert.h>
+
+#include <QDebug>
+#endif /* BENCH_TIME */
+
 using namespace SpellChecker;
 using namespace SpellChecker::CppSpellChecker::Internal;
 
@@ -34,6 +48,50 @@ using namespace SpellChecker::CppSpellChecker::Internal;
 // #define SP_CHECK( test ) QTC_CHECK( test )
 #define SP_CHECK( test )
 
+namespace {
+/*! \brief Get the offsets where the lines in the string start.
+ *
+ * A line starts after every line feed. The first line, that starts at
+ * offset 0, is not part of the list. */
+QVector<int32_t> lineStartsOf( const QChar* data, int32_t size )
+{
+  QVector<int32_t> lineStarts;
+  for( int32_t index = 0; index < size; ++index ) {
+    if( data[index].unicode() == '\n' ) {
+      lineStarts.append( index + 1 );
+    }
+  }
+  return lineStarts;
+}
+// --------------------------------------------------
+
+/*! \brief Move the words of a token to a new position of the token.
+ *
+ * The lines of the words move by the amount that the token moved. The
+ * columns only move for words on the first line of the token, the other
+ * lines of the token start at the same column wherever the token is. */
+WordList moveWords( const WordList& words, int32_t fromLine, int32_t fromColumn, int32_t toLine, int32_t toColumn )
+{
+  if( ( fromLine == toLine )
+      && ( fromColumn == toColumn ) ) {
+    return words;
+  }
+  WordList movedWords;
+  movedWords.reserve( words.size() );
+  const int32_t lineDiff = fromLine - toLine;
+  const int32_t colDiff  = fromColumn - toColumn;
+  for( Word word: words ) {
+    word.lineNumber = word.lineNumber - lineDiff;
+    if( word.lineNumber == toLine ) {
+      word.columnNumber = word.columnNumber - colDiff;
+    }
+    movedWords.append( std::move( word ) );
+  }
+  return movedWords;
+}
+// --------------------------------------------------
+} // namespace
+
 class SpellChecker::CppSpellChecker::Internal::CppDocumentProcessorPrivate
 {
 public:
@@ -42,32 +100,274 @@ public:
   CppParserSettings settings;
   CPlusPlus::TranslationUnit* trUnit;
   QString fileName;
+  CppWordScanner wordScanner;
+  /*! \brief UTF-16 source of the document.
+   *
+   * The document is converted once and the tokens are views into this
+   * string using the UTF-16 offsets of the tokens. */
+  QString source;
+  /*! \brief Texts of the words extracted from the document.
+   *
+   * Words that appear more than once share the same text. The key is a view
+   * on the text stored as the value, thus it stays valid as long as the
+   * entry is in the hash. */
+  QHash<QStringView, QString> wordTexts;
+  /*! \brief Offsets in the source where the lines start, after the first line.
+   *
+   * Built once for the document so that the lines of the words in a token
+   * can be found in a single sweep over the words. */
+  QVector<int32_t> lineStarts;
+  /*! \brief Index in \a lineStarts where the previous search ended.
+   *
+   * The tokens are mostly visited in the order of the source, thus the next
+   * search normally only has to move forward a few lines from here. */
+  int32_t lineStartHint = 0;
+  /*! \brief Words that appear in the source, if they must be removed. */
+  QStringSet wordsInSource;
+  /*! \brief Cache of the tokens of all files, can be null. */
+  SharedTokenCache* sharedTokens;
+  /*! \brief Generation of the \a sharedTokens when the settings were copied. */
+  quint32 sharedGeneration;
+  /*! \brief Spell checker used to check the words, if null the words are not checked. */
+  SpellChecker::ISpellChecker* spellChecker = nullptr;
+  /*! \brief Revision of the dictionary when the spell checker was set. */
+  quint32 dictionaryRevision = 0;
+  /*! \brief If suggestions must be looked up for new mistakes. */
+  bool fetchSuggestions = true;
+#ifdef BENCH_TIME
+  qint64 scannerNsecs = 0;
+  qint64 perCharacterNsecs = 0;
+  qint64 scannedCharacters = 0;
+  qint64 lineSweepNsecs = 0;
+  qint64 getPositionNsecs = 0;
+  qint64 sharedLookupNsecs = 0;    /*!< Time looking up tokens in the shared tokens. */
+  qint64 sharedMissNsecs = 0;      /*!< Time processing tokens that were not shared. */
+  qint64 sharedMissCharacters = 0; /*!< Characters of the tokens that were not shared. */
+#endif /* BENCH_TIME */
 
-  CppDocumentProcessorPrivate( CPlusPlus::Document::Ptr documentPointer, const HashWords& hashWords, const CppParserSettings& cppSettings );
+  CppDocumentProcessorPrivate( CPlusPlus::Document::Ptr documentPointer, const HashWords& hashWords, const CppParserSettings& cppSettings, SharedTokenCache* sharedTokenCache, quint32 sharedTokenGeneration );
+  /*! \brief Get the text of a word, shared with all previous words with the same text. */
+  QString wordText( QStringView text );
+  /*! \brief Get the string of the token from the UTF-16 source of the document.
+   *
+   * The string does not own its characters, it refers to the source and
+   * must not be used after the source is cleared. Leading and trailing
+   * whitespace are not part of the string. */
+  QString tokenString( const CPlusPlus::Token& token ) const;
+  /*! \brief Get the index of the first line in \a lineStarts that starts after the offset. */
+  int32_t nextLineStart( int32_t offset );
+  /*! \brief Check if the shared tokens can be used for the token.
+   *
+   * Tokens that are too short are never shared. If words that appear in the
+   * source are removed, the words of a token can only be shared if none of
+   * the words that the settings were applied to appear in the source. */
+  bool canShareToken( const QString& string, const QStringList& checkedWords ) const;
+  /*! \brief Get the words of the token from the shared tokens.
+   *
+   * The words are moved to the position of the token.
+   * \return True if the token was found and its words can be used. */
+  bool findSharedToken( WordTokens& tokens );
+  /*! \brief Add a new token, with the settings applied to its words, to the shared tokens.
+   * \return True if the token was added. */
+  bool shareToken( const WordTokens& tokens, const WordList& words, const QStringList& checkedWords );
+  /*! \brief Mark the shared tokens that have none of the \a mistakes in their words. */
+  void markTokensWithoutMistakes( const QVector<WordTokens>& tokens, const WordList& mistakes );
 };
 // --------------------------------------------------
 // --------------------------------------------------
 // --------------------------------------------------
 
-CppDocumentProcessorPrivate::CppDocumentProcessorPrivate( CPlusPlus::Document::Ptr documentPointer, const HashWords& hashWords, const CppParserSettings& cppSettings )
+CppDocumentProcessorPrivate::CppDocumentProcessorPrivate( CPlusPlus::Document::Ptr documentPointer, const HashWords& hashWords, const CppParserSettings& cppSettings, SharedTokenCache* sharedTokenCache, quint32 sharedTokenGeneration )
   : docPtr( documentPointer )
   , tokenHashes( hashWords )
   , settings( cppSettings )
   , trUnit( documentPointer->translationUnit() )
   , fileName( documentPointer->fileName() )
+  , wordScanner( cppSettings.removeWebsites )
+  , sharedTokens( sharedTokenCache )
+  , sharedGeneration( sharedTokenGeneration )
 {}
 // --------------------------------------------------
 
-CppDocumentProcessor::CppDocumentProcessor( CPlusPlus::Document::Ptr documentPointer, const HashWords& hashWords, const CppParserSettings& cppSettings )
+QString CppDocumentProcessorPrivate::wordText( QStringView text )
+{
+  const QHash<QStringView, QString>::const_iterator iter = wordTexts.constFind( text );
+  if( iter != wordTexts.constEnd() ) {
+    return iter.value();
+  }
+  const QString word = text.toString();
+  wordTexts.insert( QStringView( word ), word );
+  return word;
+}
+// --------------------------------------------------
+
+QString CppDocumentProcessorPrivate::tokenString( const CPlusPlus::Token& token ) const
+{
+  int32_t begin = int32_t( token.utf16charsBegin() );
+  int32_t end   = int32_t( token.utf16charsEnd() );
+  /* The offsets of the token are only valid for the source if the source
+   * could be converted without errors. This is checked by comparing the
+   * first character of the token, that is always ASCII for comments and
+   * literals. If it does not match, fall back to converting the token on
+   * its own. */
+  const QByteArray& utf8Source = docPtr->utf8Source();
+  if( ( end > source.size() )
+      || ( begin >= end )
+      || ( source.at( begin ) != QLatin1Char( utf8Source.at( int32_t( token.bytesBegin() ) ) ) ) ) {
+    return QString::fromUtf8( utf8Source.mid( int32_t( token.bytesBegin() ), int32_t( token.bytes() ) ).trimmed() );
+  }
+  /* Trim the same whitespace as QByteArray::trimmed(). */
+  const auto isSpace = []( QChar character ) {
+    const ushort unicode = character.unicode();
+    return ( unicode == ' ' ) || ( ( unicode >= '\t' ) && ( unicode <= '\r' ) );
+  };
+  while( ( begin < end ) && ( isSpace( source.at( begin ) ) == true ) ) {
+    ++begin;
+  }
+  while( ( end > begin ) && ( isSpace( source.at( end - 1 ) ) == true ) ) {
+    --end;
+  }
+  return QString::fromRawData( source.constData() + begin, end - begin );
+}
+// --------------------------------------------------
+
+int32_t CppDocumentProcessorPrivate::nextLineStart( int32_t offset )
+{
+  const int32_t count = lineStarts.size();
+  if( ( lineStartHint > count )
+      || ( ( lineStartHint > 0 ) && ( lineStarts.at( lineStartHint - 1 ) > offset ) ) ) {
+    /* The offset is before the previous search, start over with a binary
+     * search. This happens when going from the literals to the comments. */
+    lineStartHint = int32_t( std::upper_bound( lineStarts.constBegin(), lineStarts.constEnd(), offset ) - lineStarts.constBegin() );
+    return lineStartHint;
+  }
+  while( ( lineStartHint < count ) && ( lineStarts.at( lineStartHint ) <= offset ) ) {
+    ++lineStartHint;
+  }
+  return lineStartHint;
+}
+// --------------------------------------------------
+
+bool CppDocumentProcessorPrivate::canShareToken( const QString& string, const QStringList& checkedWords ) const
+{
+  if( ( sharedTokens == nullptr )
+      || ( string.size() < SharedTokenCache::MINIMUM_TOKEN_LENGTH ) ) {
+    return false;
+  }
+  if( settings.removeWordsThatAppearInSource == true ) {
+    for( const QString& word: checkedWords ) {
+      if( wordsInSource.contains( word ) == true ) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+// --------------------------------------------------
+
+bool CppDocumentProcessorPrivate::findSharedToken( WordTokens& tokens )
+{
+  if( ( sharedTokens == nullptr )
+      || ( tokens.string.size() < SharedTokenCache::MINIMUM_TOKEN_LENGTH ) ) {
+    return false;
+  }
+  SharedTokenCache::Entry entry;
+  if( sharedTokens->find( tokens.string, tokens.type, entry ) == false ) {
+    return false;
+  }
+  const bool canUse = canShareToken( tokens.string, entry.checkedWords );
+  /* The verdict of the token is only known for the dictionary that it was
+   * checked against. */
+  tokens.noMistakes = ( canUse == true )
+                      && ( spellChecker != nullptr )
+                      && ( entry.noMistakes == true )
+                      && ( entry.dictionaryRevision == dictionaryRevision );
+  sharedTokens->recordUse( entry, canUse, tokens.noMistakes );
+  if( canUse == false ) {
+    return false;
+  }
+  tokens.words = moveWords( entry.words, entry.line, entry.column, tokens.line, tokens.column );
+  for( Word& word: tokens.words ) {
+    word.fileName = fileName;
+  }
+  tokens.newHash = false;
+  return true;
+}
+// --------------------------------------------------
+
+bool CppDocumentProcessorPrivate::shareToken( const WordTokens& tokens, const WordList& words, const QStringList& checkedWords )
+{
+  if( canShareToken( tokens.string, checkedWords ) == false ) {
+    /* The words depend on the words in the source of this file. */
+    return false;
+  }
+  SharedTokenCache::Entry entry;
+  entry.string       = tokens.string;
+  entry.type         = tokens.type;
+  entry.line         = tokens.line;
+  entry.column       = tokens.column;
+  entry.words        = words;
+  entry.checkedWords = checkedWords;
+  sharedTokens->insert( sharedGeneration, std::move( entry ) );
+  return true;
+}
+// --------------------------------------------------
+
+void CppDocumentProcessorPrivate::markTokensWithoutMistakes( const QVector<WordTokens>& tokens, const WordList& mistakes )
+{
+  if( tokens.isEmpty() == true ) {
+    return;
+  }
+  /* A word is identified by its position in the file. */
+  const auto position = []( const Word& word ) {
+    return ( quint64( quint32( word.lineNumber ) ) << 32 ) | quint64( quint32( word.columnNumber ) );
+  };
+  QSet<quint64> mistakePositions;
+  mistakePositions.reserve( mistakes.size() );
+  for( const Word& word: mistakes ) {
+    mistakePositions.insert( position( word ) );
+  }
+  for( const WordTokens& token: tokens ) {
+    const bool noMistakes = std::none_of( token.words.begin(), token.words.end(), [&]( const Word& word ) {
+      return mistakePositions.contains( position( word ) );
+    } );
+    if( noMistakes == true ) {
+      sharedTokens->setNoMistakes( sharedGeneration, token.string, token.type, dictionaryRevision );
+    }
+  }
+}
+// --------------------------------------------------
+
+CppDocumentProcessor::CppDocumentProcessor( CPlusPlus::Document::Ptr documentPointer, const HashWords& hashWords, const CppParserSettings& cppSettings, SharedTokenCache* sharedTokens, quint32 sharedGeneration )
   : QObject( nullptr )
-  , d( new CppDocumentProcessorPrivate( documentPointer, hashWords, cppSettings ) )
+  , d( new CppDocumentProcessorPrivate( documentPointer, hashWords, cppSettings, sharedTokens, sharedGeneration ) )
 {
   d->docPtr->keepSourceAndAST();
 }
 // --------------------------------------------------
 
+void CppDocumentProcessor::setSpellChecker( SpellChecker::ISpellChecker* spellChecker, quint32 dictionaryRevision, bool fetchSuggestions )
+{
+  d->spellChecker       = spellChecker;
+  d->dictionaryRevision = dictionaryRevision;
+  d->fetchSuggestions   = fetchSuggestions;
+}
+// --------------------------------------------------
+
 CppDocumentProcessor::~CppDocumentProcessor()
 {
+#ifdef BENCH_TIME
+  qDebug() << "Tokenized: " << d->fileName
+           << "\n  - characters   : " << d->scannedCharacters
+           << "\n  - scanner (ns) : " << d->scannerNsecs
+           << "\n  - per char (ns): " << d->perCharacterNsecs
+           << "\n  - unique words : " << d->wordTexts.size()
+           << "\n  - lines (ns)   : " << d->lineSweepNsecs
+           << "\n  - position (ns): " << d->getPositionNsecs;
+  if( d->sharedTokens != nullptr ) {
+    d->sharedTokens->recordTimes( d->sharedLookupNsecs, d->sharedMissNsecs, d->sharedMissCharacters );
+  }
+#endif /* BENCH_TIME */
   if( d->docPtr != nullptr ) {
     d->docPtr->releaseSourceAndAST();
   }
@@ -78,7 +378,9 @@ void CppDocumentProcessor::process( CppDocumentProcessor::FutureIF& future )
 {
   SP_CHECK( docPtr.isNull() == false );
   SP_CHECK( trUnit != nullptr );
-  QStringSet wordsInSource;
+  QElapsedTimer serviceTimer;
+  serviceTimer.start();
+  const QStringSet& wordsInSource = d->wordsInSource;
   QVector<WordTokens> wordTokens;
   /* If the setting is set to remove words from the list based on words found in the source,
    * parse the source file and then remove all words found in the source files from the list
@@ -86,7 +388,7 @@ void CppDocumentProcessor::process( CppDocumentProcessor::FutureIF& future )
   if( d->settings.removeWordsThatAppearInSource == true ) {
     /* First get all words that does appear in the current source file. These words only
      * include variables and their types */
-    wordsInSource = getWordsThatAppearInSource();
+    d->wordsInSource = getWordsThatAppearInSource();
   }
 
   if( future.isCanceled() == true ) {
@@ -94,6 +396,12 @@ void CppDocumentProcessor::process( CppDocumentProcessor::FutureIF& future )
     return;
   }
 
+  /* Convert the source once, the comments and literals are taken from the
+   * converted source instead of converting each of them. */
+  d->source        = QString::fromUtf8( d->docPtr->utf8Source() );
+  d->lineStarts    = lineStartsOf( d->source.constData(), d->source.size() );
+  d->lineStartHint = 0;
+
   if( d->settings.whatToCheck.testFlag( CppParserSettings::CheckStringLiterals ) == true ) {
     /* Parse string literals */
     unsigned int tokenCount = d->trUnit->tokenCount();
@@ -165,37 +473,96 @@ void CppDocumentProcessor::process( CppDocumentProcessor::FutureIF& future )
    * tokenize function. If this is not done the list of hashes can grow forever
    * and cause a huge increase in memory. Doing it this way ensure that the
    * list only contains hashes of tokens that are present in during the last run
-   * and will not contain old and invalid hashes. It will cause the parsing of a
-   * different file than the previous run to be less efficient but if a file is
-   * parsed multiple times, one after the other, it will result in a large speed up
-   * and this will mostly be the case when editing a file. For this reason the initial
-   * project parse on start up can be slower. */
+   * and will not contain old and invalid hashes. The parser keeps the hashes of
+   * each file, thus if a file is parsed again, while editing it or when the
+   * project is parsed again, only tokens that changed must be processed. For
+   * this reason the initial project parse on start up can be slower. */
 
   /* Populate the list of hashes from the tokens that was processed. */
   HashWords newHashesOut;
   WordList  newSettingsApplied;
+  int32_t   reusedTokens = 0;
+  /* Words that must be checked by the spell checker, the words of shared
+   * tokens that have no mistakes are left out. */
+  const bool checkMistakes = ( d->spellChecker != nullptr );
+  WordList wordsToCheck;
+  /* Tokens that were added to the shared tokens, with the settings applied
+   * to their words. Once checked, the ones without mistakes are marked. */
+  QVector<WordTokens> newSharedTokens;
   for( const WordTokens& token: qAsConst( wordTokens ) ) {
     WordList words = token.words;
-    if( token.newHash == true ) {
+    if( token.newHash == false ) {
+      ++reusedTokens;
+    } else {
       /* The words are new, they were not known in a previous hash
        * thus the settings must now be applied.
        * Only words that have already been checked against the settings
        * gets added to the hash, thus there is no need to apply the settings
        * again, since this will only waste time. */
-      CppDocumentParser::applySettingsToWords( d->settings, token.string, wordsInSource, words );
+      /* Tokens that can be shared with other files also keep the words
+       * that the settings were applied to. */
+      const bool share = ( d->sharedTokens != nullptr )
+                         && ( token.string.size() >= SharedTokenCache::MINIMUM_TOKEN_LENGTH );
+      QStringList checkedWords;
+      QStringList* checkedWordsPtr = ( ( share == true ) && ( d->settings.removeWordsThatAppearInSource == true ) )
+                                     ? &checkedWords
+                                     : nullptr;
+#ifdef BENCH_TIME
+      QElapsedTimer settingsTimer;
+      settingsTimer.start();
+#endif /* BENCH_TIME */
+      CppDocumentParser::applySettingsToWords( d->settings, token.string, wordsInSource, words, checkedWordsPtr );
+#ifdef BENCH_TIME
+      if( share == true ) {
+        d->sharedMissNsecs += settingsTimer.nsecsElapsed();
+      }
+#endif /* BENCH_TIME */
+      if( ( share == true )
+          && ( d->shareToken( token, words, checkedWords ) == true )
+          && ( checkMistakes == true ) ) {
+        WordTokens sharedToken = token;
+        sharedToken.words      = words;
+        newSharedTokens.append( sharedToken );
+      }
+    }
+    if( ( checkMistakes == true )
+        && ( token.noMistakes == false ) ) {
+      wordsToCheck.append( words );
     }
     newSettingsApplied.append( words );
     SP_CHECK( token.hash != 0x00 );
     newHashesOut[token.hash] = { token.line, token.column, words };
   }
 
+  /* The words were collected per token, literals before comments. Sort them
+   * so that they are in the order that they appear in the file. */
+  newSettingsApplied.sortByPosition();
+
   if( future.isCanceled() == true ) {
     future.reportCanceled();
     return;
   }
 
-  /* Done, report the words that should be spellchecked */
-  future.reportResult( ResultType{ std::move( newHashesOut ), std::move( newSettingsApplied ) } );
+  ResultType result{ std::move( newHashesOut ), std::move( newSettingsApplied ), reusedTokens };
+  if( checkMistakes == true ) {
+    /* Check the words in this task as well, instead of handing them over to
+     * the core that would start another task to check them. The suggestions
+     * of repeated mistakes come from the cache of the spell checker, thus
+     * no previous mistakes are needed. */
+    wordsToCheck.sortByPosition();
+    result.mistakes           = SpellCheckProcessor::checkWords( d->spellChecker, wordsToCheck, WordList(), d->fetchSuggestions, future );
+    result.checked            = true;
+    result.dictionaryRevision = d->dictionaryRevision;
+    if( future.isCanceled() == true ) {
+      future.reportCanceled();
+      return;
+    }
+    d->markTokensWithoutMistakes( newSharedTokens, result.mistakes );
+  }
+
+  /* Done, report the words, and the mistakes if they were checked. */
+  result.serviceNsecs = serviceTimer.nsecsElapsed();
+  future.reportResult( result );
 }
 // --------------------------------------------------
 
@@ -274,7 +641,7 @@ WordTokens CppDocumentProcessor::parseToken( const CPlusPlus::Token& token, Word
     return {};
   }
   /* Get the token string */
-  const QString tokenString = QString::fromUtf8( d->docPtr->utf8Source().mid( token.bytesBegin(), token.bytes() ).trimmed() );
+  const QString tokenString = d->tokenString( token );
   /* Calculate the hash of the token string */
   const uint32_t hash = qHash( tokenString );
 
@@ -292,78 +659,176 @@ WordTokens CppDocumentProcessor::parseToken( const CPlusPlus::Token& token, Word
     return wordOpt.second;
   }
 
+  /* Token was not in the list of hashes of this file. If another file had
+   * the same token, its words are moved to this token. */
+#ifdef BENCH_TIME
+  QElapsedTimer timer;
+  timer.start();
+  const bool shareable = ( d->sharedTokens != nullptr )
+                         && ( tokenString.size() >= SharedTokenCache::MINIMUM_TOKEN_LENGTH );
+#endif /* BENCH_TIME */
+  const bool shared = d->findSharedToken( tokens );
+#ifdef BENCH_TIME
+  if( shareable == true ) {
+    d->sharedLookupNsecs += timer.nsecsElapsed();
+  }
+#endif /* BENCH_TIME */
+  if( shared == true ) {
+    return tokens;
+  }
+
   /* Token was not in the list of hashes.
    * Tokenize the string to extract words that should be checked. */
-  tokens.words   = extractWordsFromString( tokenString, tokenBegin, type );
+#ifdef BENCH_TIME
+  timer.restart();
+#endif /* BENCH_TIME */
+  tokens.words   = extractWordsFromString( tokenString, tokenBegin, line, col, type );
   tokens.newHash = true;
+#ifdef BENCH_TIME
+  if( shareable == true ) {
+    d->sharedMissNsecs      += timer.nsecsElapsed();
+    d->sharedMissCharacters += tokenString.size();
+  }
+#endif /* BENCH_TIME */
   return tokens;
 }
 // --------------------------------------------------
 
-WordList CppDocumentProcessor::extractWordsFromString( const QString& string, int32_t stringStart, WordTokens::Type type ) const
+WordList CppDocumentProcessor::extractWordsFromString( const QString& string, int32_t stringStart, int32_t line, int32_t column, WordTokens::Type type ) const
 {
   WordList wordTokens;
   const int32_t strLength = string.length();
-  bool busyWithWord       = false;
+  const QChar* data       = string.constData();
+  int32_t position        = 0;
   int32_t wordStartPos    = 0;
-  bool endOfWord          = false;
+  int32_t wordEndPos      = 0;
 
-  /* Iterate through all of the characters in the comment and extract words from them.
-   * Words are split up by non-word characters and is checked using the isEndOfCurrentWord()
-   * function. The end condition is deliberately set to continue past the length of the
-   * comment so that a word in progress is stopped and extracted when the comment ends */
+#ifdef BENCH_TIME
+  /* Compare the scanner against the per character check on the same string.
+   * Both must find exactly the same words. */
+  QElapsedTimer timer;
+  timer.start();
+  QVector<QPair<int32_t, int32_t>> perCharacterWords;
+  bool busyWithWord = false;
   for( int currentPos = 0; currentPos <= strLength; ++currentPos ) {
-    /* Check if the current character is the end of a word character. */
-    endOfWord = isEndOfCurrentWord( string, currentPos );
+    const bool endOfWord = isEndOfCurrentWord( string, currentPos );
     if( ( endOfWord == false ) && ( busyWithWord == false ) ) {
       wordStartPos = currentPos;
       busyWithWord = true;
     }
-
     if( ( busyWithWord == true ) && ( endOfWord == true ) ) {
-      /* Pre-condition sanity checks for debugging. The wordStartPos
-       * can not be 0 or negative. A comment or literal always starts
-       * with either a slash-star or slash-slash (comment) or inverted
-       * comma (literal), thus there must always be something else before
-       * the word starts.
-       *
-       * currentPos on the other hand can be at the end of the string
-       * for example with a single line comment (slash-slash).
-       */
-      SP_CHECK( wordStartPos > 0 );
-      Word word;
-      word.fileName  = d->fileName;
-      word.text      = string.mid( wordStartPos, currentPos - wordStartPos );
-      word.start     = wordStartPos;
-      word.end       = currentPos;
-      word.length    = currentPos - wordStartPos;
-      word.charAfter = ( currentPos < strLength )
-                       ? string.at( currentPos )
-                       : QLatin1Char( ' ' );
-      word.inComment = ( type != WordTokens::Type::Literal );
-      bool isDoxygenTag = false;
-      if( type == WordTokens::Type::Doxygen ) {
-        const QChar charBeforeStart = string.at( wordStartPos - 1 );
-        if( ( charBeforeStart == QLatin1Char( '\\' ) )
-            || ( charBeforeStart == QLatin1Char( '@' ) ) ) {
-          const QString& currentWord = word.text;
-          /* Classify it */
-          const int32_t doxyClass = CppTools::classifyDoxygenTag( currentWord.unicode(), currentWord.size() );
-          if( doxyClass != CppTools::T_DOXY_IDENTIFIER ) {
-            /* It is a doxygen tag, mark it as such so that it does not end up
-             * in the list of words from this string. */
-            isDoxygenTag = true;
-          }
+      perCharacterWords.append( qMakePair( wordStartPos, int32_t( currentPos ) ) );
+      busyWithWord = false;
+    }
+  }
+  d->perCharacterNsecs += timer.nsecsElapsed();
+  timer.restart();
+  QVector<QPair<int32_t, int32_t>> scannerWords;
+  while( d->wordScanner.nextWord( data, strLength, position, wordStartPos, wordEndPos ) == true ) {
+    scannerWords.append( qMakePair( wordStartPos, wordEndPos ) );
+  }
+  d->scannerNsecs      += timer.nsecsElapsed();
+  d->scannedCharacters += strLength;
+  QTC_CHECK( scannerWords == perCharacterWords );
+  position = 0;
+  /* Compare the line sweep against getting the position of each word from
+   * the translation unit. */
+  QVector<QPair<int32_t, int32_t>> unitPositions;
+  if( ( stringStart >= 0 )
+      && ( string.constData() == d->source.constData() + stringStart ) ) {
+    timer.restart();
+    for( const QPair<int32_t, int32_t>& scannerWord: qAsConst( scannerWords ) ) {
+      int32_t wordLine;
+      int32_t wordColumn;
+      d->trUnit->getPosition( stringStart + scannerWord.first, &wordLine, &wordColumn );
+      unitPositions.append( qMakePair( wordLine, wordColumn ) );
+    }
+    d->getPositionNsecs += timer.nsecsElapsed();
+  }
+  QVector<QPair<int32_t, int32_t>> sweepPositions;
+  timer.restart();
+#endif /* BENCH_TIME */
+
+  /* The positions of the words are found relative to the start of the
+   * string. If the string is part of the source of the document, the line
+   * table of the document is used. Otherwise, for example for the literals
+   * of macros, a table is made for the string alone. Since the words are
+   * found in order, the lines only have to be swept forward once. */
+  QVector<int32_t> stringLineStarts;
+  const QVector<int32_t>* lineStarts = &d->lineStarts;
+  int32_t lineOffset                 = stringStart;
+  int32_t nextLine                   = 0;
+  if( ( stringStart >= 0 )
+      && ( string.constData() == d->source.constData() + stringStart ) ) {
+    nextLine = d->nextLineStart( stringStart );
+  } else {
+    stringLineStarts = lineStartsOf( data, strLength );
+    lineStarts       = &stringLineStarts;
+    lineOffset       = 0;
+  }
+  const int32_t lineCount  = lineStarts->size();
+  int32_t wordLine         = line;
+  int32_t currentLineStart = 0;
+
+  /* Find the words in the comment using the word scanner. The scanner splits
+   * up words on the same characters as the isEndOfCurrentWord() function, but
+   * skips over runs of plain characters instead of checking them one by one. */
+  while( d->wordScanner.nextWord( data, strLength, position, wordStartPos, wordEndPos ) == true ) {
+    /* Pre-condition sanity checks for debugging. The wordStartPos
+     * can not be 0 or negative. A comment or literal always starts
+     * with either a slash-star or slash-slash (comment) or inverted
+     * comma (literal), thus there must always be something else before
+     * the word starts.
+     *
+     * wordEndPos on the other hand can be at the end of the string
+     * for example with a single line comment (slash-slash).
+     */
+    SP_CHECK( wordStartPos > 0 );
+    const int32_t wordLength = wordEndPos - wordStartPos;
+    if( type == WordTokens::Type::Doxygen ) {
+      const QChar charBeforeStart = string.at( wordStartPos - 1 );
+      if( ( charBeforeStart == QLatin1Char( '\\' ) )
+          || ( charBeforeStart == QLatin1Char( '@' ) ) ) {
+        /* Classify it */
+        const int32_t doxyClass = CppTools::classifyDoxygenTag( data + wordStartPos, wordLength );
+        if( doxyClass != CppTools::T_DOXY_IDENTIFIER ) {
+          /* It is a doxygen tag, it should not end up in the list of
+           * words from this string. */
+          continue;
         }
       }
-      if( isDoxygenTag == false ) {
-        d->trUnit->getPosition( stringStart + uint32_t( wordStartPos ), &word.lineNumber, &word.columnNumber );
-        wordTokens.append( std::move( word ) );
-      }
-      busyWithWord = false;
-      wordStartPos = 0;
     }
+    Word word;
+    word.fileName  = d->fileName;
+    word.text      = d->wordText( QStringView( data + wordStartPos, wordLength ) );
+    word.start     = wordStartPos;
+    word.end       = wordEndPos;
+    word.length    = wordLength;
+    word.charAfter = ( wordEndPos < strLength )
+                     ? string.at( wordEndPos )
+                     : QLatin1Char( ' ' );
+    word.inComment = ( type != WordTokens::Type::Literal );
+    /* Move to the line of the word. Words on the first line are relative
+     * to the column of the string, the others to the start of their line. */
+    const int32_t wordOffset = lineOffset + wordStartPos;
+    while( ( nextLine < lineCount ) && ( lineStarts->at( nextLine ) <= wordOffset ) ) {
+      currentLineStart = lineStarts->at( nextLine );
+      ++nextLine;
+      ++wordLine;
+    }
+    word.lineNumber   = wordLine;
+    word.columnNumber = ( wordLine == line )
+                        ? column + wordStartPos
+                        : wordOffset - currentLineStart + 1;
+#ifdef BENCH_TIME
+    sweepPositions.append( qMakePair( word.lineNumber, word.columnNumber ) );
+#endif /* BENCH_TIME */
+    wordTokens.append( std::move( word ) );
   }
+#ifdef BENCH_TIME
+  d->lineSweepNsecs += timer.nsecsElapsed();
+  QTC_CHECK( ( unitPositions.isEmpty() == true ) || ( unitPositions == sweepPositions ) );
+#endif /* BENCH_TIME */
   return wordTokens;
 }
 // --------------------------------------------------
@@ -569,12 +1034,9 @@ QVector<WordTokens> CppDocumentProcessor::parseMacros() const
         lineBreak = lineIndexes.takeFirst();
       }
       /* Get the words from the extracted literal */
-      WordList words = extractWordsFromString( tokenString, 0, WordTokens::Type::Literal );
-      for( Word& word: words ) {
-        /* Apply the offsets to the words */
-        word.columnNumber += capStart - colOffset;
-        word.lineNumber    = line;
-      }
+      /* Get the words from the extracted literal, relative to the
+       * start of the literal in the macro. */
+      WordList words = extractWordsFromString( tokenString, -1, int32_t( line ), int32_t( capStart - colOffset ), WordTokens::Type::Literal );
       tokens.words.append( words );
       /* Get the words from the extracted literal */
     }
@@ -609,29 +1071,16 @@ CppDocumentProcessor::TmpOptional CppDocumentProcessor::checkHash( WordTokens to
       tokens.newHash = false;
       return std::make_pair( true, tokens );
     } else {
-      WordList words;
       /* Token moved, adjust.
        * This will even work for lines that are copied because the
-       * hash will be the same but the start will just be different. */
-      const qint32 lineDiff    = int32_t( tokenWords.line ) - int32_t( tokens.line );
-      const qint32 colDiff     = int32_t( tokenWords.col ) - int32_t( tokens.column );
-      const uint32_t firstLine = tokens.line;
-      /* Move the line according to the difference between the
-       * known position and the position from the hash.
+       * hash will be the same but the start will just be different.
        * The column is also moved, but only if on the first line
        * since a column move is only possible on the first line.
        * If a column moved that are not on the first line, the hash
        * would be new and it would be regarded as a new hash. A move
        * on the column will not cause this, but will also not move the
        * words below it, thus they should not be updated. */
-      for( Word word: qAsConst( tokenWords.words ) ) {
-        word.lineNumber = uint32_t( int32_t( word.lineNumber ) - lineDiff );
-        if( word.lineNumber == firstLine ) {
-          word.columnNumber = uint32_t( int32_t( word.columnNumber ) - colDiff );
-        }
-        words.append( word );
-      }
-      tokens.words   = words;
+      tokens.words   = moveWords( tokenWords.words, tokenWords.line, tokenWords.col, tokens.line, tokens.column );
       tokens.newHash = false;
       return std::make_pair( true, tokens );
     }
@@ -32,6 +32,7 @@ class Overview;
 } // namespace CPlusPlus
 
 namespace SpellChecker {
+class ISpellChecker;
 namespace CppSpellChecker {
 namespace Internal {
 
@@ -50,7 +51,14 @@ namespace Internal {
  *
  * The \a newHash flag keeps track if the words were extracted in a
  * previous pass or not, meaning that they were already processed and does not
- * need to be processed further. */
+ * need to be processed further.
+ *
+ * The \a noMistakes flag is set if the words were taken from a shared token
+ * that has no mistakes with the current dictionary, they do not have to be
+ * checked by the spell checker.
+ *
+ * The \a string of a comment or literal refers to the source of the
+ * document that is kept by the processor, it is not a copy. */
 struct WordTokens
 {
   enum class Type {
@@ -64,11 +72,13 @@ struct WordTokens
   int32_t column = 0;
   QString string;
   WordList words;
-  bool newHash = true;
+  bool newHash    = true;
+  bool noMistakes = false;
   Type type;
 };
 
 class CppDocumentProcessorPrivate;
+class SharedTokenCache;
 /*! \brief The C++ Document Processor class.
  *
  * This processor class use QtConcurrent to process a CPlusPlus::Document::Ptr
@@ -91,8 +101,15 @@ public:
   /*! \brief Structure for the result type that the future will return. */
   struct ResultType
   {
-    HashWords wordHashes; /*!< List of hashes extracted along with words from the hash. */
-    WordList words;       /*!< Word tokens that were extracted by the processor. */
+    HashWords wordHashes;     /*!< List of hashes extracted along with words from the hash. */
+    WordList words;           /*!< Word tokens that were extracted by the processor. */
+    int32_t reusedTokens = 0; /*!< Number of tokens whose words were taken from the
+                               * hashes passed to the processor. */
+    WordList mistakes;        /*!< Misspelled words, if the words were checked. */
+    bool checked = false;     /*!< If the words were checked, see setSpellChecker(). */
+    quint32 dictionaryRevision = 0; /*!< Revision of the dictionary that the words
+                                     * were checked against. */
+    qint64 serviceNsecs = 0;  /*!< Time that the processor took to process the document. */
   };
   /*! \brief Alias for the Watcher type. */
   using Watcher = QFutureWatcher<ResultType>;
@@ -108,10 +125,22 @@ public:
    * \param documentPointer Shared ownership of the document pointer to prevent
    *    it from getting deleted while the processor still runs.
    * \param hashWords List of hashes that should be used to optimise the parsing.
-   * \param cppSettings Settings that should be applied. */
-  CppDocumentProcessor( CPlusPlus::Document::Ptr documentPointer, const HashWords& hashWords, const CppParserSettings& cppSettings );
+   * \param cppSettings Settings that should be applied.
+   * \param sharedTokens Cache of the tokens of all files, can be null.
+   * \param sharedGeneration Generation of the \a sharedTokens, obtained before
+   *    the \a cppSettings were copied. */
+  CppDocumentProcessor( CPlusPlus::Document::Ptr documentPointer, const HashWords& hashWords, const CppParserSettings& cppSettings, SharedTokenCache* sharedTokens = nullptr, quint32 sharedGeneration = 0 );
   /*! Destructor. */
   ~CppDocumentProcessor();
+  /*! \brief Check the extracted words with the spell checker in the same task.
+   *
+   * Must be called before the processor is started. If no spell checker is
+   * set, only the words are reported.
+   * \param spellChecker Spell checker to use, must be thread safe.
+   * \param dictionaryRevision SpellCheckerCore::dictionaryRevision() from
+   *    before the spell checker was obtained.
+   * \param fetchSuggestions If suggestions must be looked up for new mistakes. */
+  void setSpellChecker( SpellChecker::ISpellChecker* spellChecker, quint32 dictionaryRevision, bool fetchSuggestions );
   /*! \brief Process function that the thread will run with the future that will
    * report the result. */
   void process( FutureIF& future );
@@ -155,8 +184,16 @@ private:
    * This function takes a string, either a comment or a string literal and
    * breaks the string into words or tokens that should later be checked
    * for spelling mistakes.
+   * The line and column of each word are found from the start of the string
+   * with a single forward sweep over the lines of the string, instead of
+   * looking up the position of each word in the translation unit.
    * \param[in] string String that must be broken up into words.
-   * \param[in] stringStart Start of the string.
+   * \param[in] stringStart Offset of the string in the source of the document.
+   *              The lines of the string are then taken from the line table
+   *              of the document. Use -1 if the string is not part of the
+   *              source.
+   * \param[in] line Line of the first character of the string.
+   * \param[in] column Column of the first character of the string.
    * \param[in] type If the string is a Comment, Doxygen Documentation or a
    *              String Literal. If the string is Doxygen docs then the
    *              function will also try to remove doxygen tags from the words
@@ -164,7 +201,7 @@ private:
    *              gets handled later on, and it does not rely on a setting,
    *              it must be done always to remove noise.
    * \return Words that were extracted from the string. */
-  WordList extractWordsFromString(const QString& string, int32_t stringStart, WordTokens::Type type ) const;
+  WordList extractWordsFromString( const QString& string, int32_t stringStart, int32_t line, int32_t column, WordTokens::Type type ) const;
   /*! \brief Check if the end of a possible word was reached.
    *
    * Utility function to check if the character at the given position is the
@@ -172,9 +209,10 @@ private:
    * are some handling of dots and other characters that determine if the
    * position is the end of the word.
    *
-   * \todo Check if isEndOfCurrentWord can not be re-implemented
-   * using an iterator instead of an index. This would possibly require
-   * rework in the calling function as well, but might be cleaner. */
+   * Words are extracted using the CppWordScanner that implements the same
+   * rules without checking every character. This function is kept as the
+   * reference for the scanner and is compared against it when BENCH_TIME
+   * is defined. */
   bool isEndOfCurrentWord( const QString& comment, int currentPos ) const;
   /*! \brief Parse all macros in the document and extract string literals.
    *
@@ -97,6 +97,7 @@ const CppParserSettings& CppParserOptionsWidget::settings()
   m_settings.removeWordsThatAppearInSource = ui->checkBoxWordsInSource->isChecked();
   m_settings.removeWebsites                = ui->checkBoxWebsiteAddresses->isChecked();
   m_settings.removeFirstComment            = ui->checkBoxRemoveFirstComment->isChecked();
+  m_settings.useCodeModelSnapshot          = ui->checkBoxUseCodeModelSnapshot->isChecked();
   return m_settings;
 }
 // --------------------------------------------------
@@ -169,6 +170,7 @@ void CppParserOptionsWidget::updateWithSettings( const CppParserSettings* const
   dotsButtons[settings->wordsWithDotsOption]->setChecked( true );
   ui->checkBoxWebsiteAddresses->setChecked( settings->removeWebsites );
   ui->checkBoxRemoveFirstComment->setChecked( settings->removeFirstComment );
+  ui->checkBoxUseCodeModelSnapshot->setChecked( settings->useCodeModelSnapshot );
 }
 // --------------------------------------------------
 
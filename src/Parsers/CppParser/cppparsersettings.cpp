@@ -49,6 +49,7 @@ CppParserSettings::CppParserSettings( const CppParserSettings& settings )
   wordsWithDotsOption           = settings.wordsWithDotsOption;
   removeWebsites                = settings.removeWebsites;
   removeFirstComment            = settings.removeFirstComment;
+  useCodeModelSnapshot          = settings.useCodeModelSnapshot;
 }
 // --------------------------------------------------
 
@@ -76,6 +77,7 @@ void CppParserSettings::loadFromSettings( QSettings* settings )
   wordsWithDotsOption           = static_cast<WordsWithDotsOption>( settings->value( QLatin1String( Parsers::CppParser::Constants::CHECK_DOTS ), wordsWithDotsOption ).toInt() );
   removeWebsites                = settings->value( QLatin1String( Parsers::CppParser::Constants::REMOVE_WEBSITES ), removeWebsites ).toBool();
   removeFirstComment            = settings->value( QLatin1String( Parsers::CppParser::Constants::REMOVE_FIRST_COMMENT ), removeFirstComment ).toBool();
+  useCodeModelSnapshot          = settings->value( QLatin1String( Parsers::CppParser::Constants::USE_CODE_MODEL_SNAPSHOT ), useCodeModelSnapshot ).toBool();
 
   settings->endGroup(); /* CPP_PARSER_GROUP */
   settings->endGroup(); /* CORE_PARSERS_GROUP */
@@ -103,6 +105,7 @@ void CppParserSettings::saveToSetting( QSettings* settings ) const
   settings->setValue( QLatin1String( Parsers::CppParser::Constants::CHECK_DOTS ),             wordsWithDotsOption );
   settings->setValue( QLatin1String( Parsers::CppParser::Constants::REMOVE_WEBSITES ),        removeWebsites );
   settings->setValue( QLatin1String( Parsers::CppParser::Constants::REMOVE_FIRST_COMMENT ),   removeFirstComment );
+  settings->setValue( QLatin1String( Parsers::CppParser::Constants::USE_CODE_MODEL_SNAPSHOT ), useCodeModelSnapshot );
 
   settings->endGroup(); /* CPP_PARSER_GROUP */
   settings->endGroup(); /* CORE_PARSERS_GROUP */
@@ -125,6 +128,7 @@ void CppParserSettings::setDefaults()
   wordsWithDotsOption           = SplitWordsOnDots;
   removeWebsites                = false;
   removeFirstComment            = false;
+  useCodeModelSnapshot          = true;
 }
 // --------------------------------------------------
 
@@ -144,6 +148,7 @@ CppParserSettings& CppParserSettings::operator=( const CppParserSettings& other
     this->wordsWithDotsOption           = other.wordsWithDotsOption;
     this->removeWebsites                = other.removeWebsites;
     this->removeFirstComment            = other.removeFirstComment;
+    this->useCodeModelSnapshot          = other.useCodeModelSnapshot;
     emit settingsChanged();
   }
 
@@ -166,6 +171,27 @@ bool CppParserSettings::operator==( const CppParserSettings& other ) const
   different = different | ( wordsWithDotsOption != other.wordsWithDotsOption );
   different = different | ( removeWebsites != other.removeWebsites );
   different = different | ( removeFirstComment != other.removeFirstComment );
+  different = different | ( useCodeModelSnapshot != other.useCodeModelSnapshot );
   return ( different == false );
 }
 // --------------------------------------------------
+
+QString CppParserSettings::identity() const
+{
+  const QStringList values = {
+    QString::number( int(whatToCheck) ),
+    QString::number( int(commentsToCheck) ),
+    QString::number( checkQtKeywords ),
+    QString::number( checkAllCapsWords ),
+    QString::number( wordsWithNumberOption ),
+    QString::number( wordsWithUnderscoresOption ),
+    QString::number( camelCaseWordOption ),
+    QString::number( removeWordsThatAppearInSource ),
+    QString::number( removeEmailAddresses ),
+    QString::number( wordsWithDotsOption ),
+    QString::number( removeWebsites ),
+    QString::number( removeFirstComment )
+  };
+  return values.join( QLatin1Char( ',' ) );
+}
+// --------------------------------------------------
@@ -146,12 +146,22 @@ public:
                                            * Doxygen comments that are the first comment in a file
                                            * will not be ignored. This is to handle pure doxygen
                                            * docs files that might start without a file header. */
+  bool useCodeModelSnapshot;              /*!< Read files that are already in the snapshot of the
+                                           * code model from the snapshot, instead of asking the
+                                           * code model to update them. Only files that are not in
+                                           * the snapshot, or that changed since, are updated by the
+                                           * code model. */
 
   void loadFromSettings( QSettings* settings );
   void saveToSetting( QSettings* settings ) const;
 
   CppParserSettings& operator=( const CppParserSettings& other );
   bool operator==( const CppParserSettings& other ) const;
+  /*! \brief Get a string that is only the same for settings that are the same.
+   *
+   * Used to detect if words that were extracted in a previous session were
+   * extracted with the same settings. */
+  QString identity() const;
 
 signals:
   void settingsChanged();
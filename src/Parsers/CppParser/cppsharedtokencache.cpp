@@ -0,0 +1,176 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "cppsharedtokencache.h"
+
+using namespace SpellChecker;
+using namespace SpellChecker::CppSpellChecker::Internal;
+
+namespace {
+/*! \brief Maximum estimated memory of all entries in the cache, in bytes. */
+const int MAX_COST = 32 * 1024 * 1024;
+} // namespace
+
+SharedTokenCache::SharedTokenCache()
+  : d_generation( 0 )
+  , d_lookups( 0 )
+  , d_hits( 0 )
+  , d_rejected( 0 )
+  , d_reusedWords( 0 )
+  , d_reusedCharacters( 0 )
+  , d_uncheckedWords( 0 )
+  , d_lookupNsecs( 0 )
+  , d_missNsecs( 0 )
+  , d_missCharacters( 0 )
+{
+  d_cache.setMaxCost( MAX_COST );
+}
+// --------------------------------------------------
+
+SharedTokenCache::~SharedTokenCache()
+{}
+// --------------------------------------------------
+
+quint32 SharedTokenCache::generation() const
+{
+  QMutexLocker locker( &d_mutex );
+  return d_generation;
+}
+// --------------------------------------------------
+
+bool SharedTokenCache::find( const QString& string, WordTokens::Type type, Entry& entry )
+{
+  const quint64 hash = key( string, type );
+  QMutexLocker locker( &d_mutex );
+  ++d_lookups;
+  const Entry* cached = d_cache.object( hash );
+  if( ( cached == nullptr )
+      || ( cached->type != type )
+      || ( cached->string != string ) ) {
+    return false;
+  }
+  entry = *cached;
+  return true;
+}
+// --------------------------------------------------
+
+void SharedTokenCache::insert( quint32 generation, Entry&& entry )
+{
+  /* Make a deep copy of the text, the token is normally a view on the
+   * source of the document that will be released. */
+  entry.string = QString( entry.string.constData(), entry.string.size() );
+  const quint64 hash = key( entry.string, entry.type );
+  /* Estimate the memory of the entry. The texts of the words are shared
+   * with the documents, they are not counted. */
+  const int cost = int( sizeof( Entry ) )
+                   + ( entry.string.size() * int( sizeof( QChar ) ) )
+                   + ( entry.words.capacity() * int( sizeof( Word ) ) )
+                   + ( entry.checkedWords.size() * int( sizeof( QString ) ) );
+  QMutexLocker locker( &d_mutex );
+  if( generation != d_generation ) {
+    return;
+  }
+  d_cache.insert( hash, new Entry( std::move( entry ) ), cost );
+}
+// --------------------------------------------------
+
+void SharedTokenCache::setNoMistakes( quint32 generation, const QString& string, WordTokens::Type type, quint32 dictionaryRevision )
+{
+  const quint64 hash = key( string, type );
+  QMutexLocker locker( &d_mutex );
+  if( generation != d_generation ) {
+    return;
+  }
+  Entry* cached = d_cache.object( hash );
+  if( ( cached == nullptr )
+      || ( cached->type != type )
+      || ( cached->string != string ) ) {
+    return;
+  }
+  cached->noMistakes         = true;
+  cached->dictionaryRevision = dictionaryRevision;
+}
+// --------------------------------------------------
+
+void SharedTokenCache::clear()
+{
+  QMutexLocker locker( &d_mutex );
+  d_cache.clear();
+  ++d_generation;
+}
+// --------------------------------------------------
+
+void SharedTokenCache::recordUse( const Entry& entry, bool used, bool checkSkipped )
+{
+  QMutexLocker locker( &d_mutex );
+  if( used == false ) {
+    ++d_rejected;
+    return;
+  }
+  ++d_hits;
+  d_reusedWords      += entry.words.size();
+  d_reusedCharacters += entry.string.size();
+  if( checkSkipped == true ) {
+    d_uncheckedWords += entry.words.size();
+  }
+}
+// --------------------------------------------------
+
+void SharedTokenCache::recordTimes( qint64 lookupNsecs, qint64 missNsecs, qint64 missCharacters )
+{
+  QMutexLocker locker( &d_mutex );
+  d_lookupNsecs    += lookupNsecs;
+  d_missNsecs      += missNsecs;
+  d_missCharacters += missCharacters;
+}
+// --------------------------------------------------
+
+QString SharedTokenCache::statistics() const
+{
+  QMutexLocker locker( &d_mutex );
+  QString statistics = QStringLiteral( "tokens %1/%2 (rejected %3), characters not scanned %4, words not filtered %5, words not checked %6, cached tokens %7, cost %8/%9" )
+                       .arg( d_hits ).arg( d_lookups ).arg( d_rejected )
+                       .arg( d_reusedCharacters ).arg( d_reusedWords ).arg( d_uncheckedWords )
+                       .arg( d_cache.count() ).arg( d_cache.totalCost() ).arg( d_cache.maxCost() );
+  if( d_missCharacters > 0 ) {
+    /* The reused characters would have been processed at the same rate as
+     * the characters of the tokens that were not found. */
+    const double nsecsPerCharacter = double( d_missNsecs ) / double( d_missCharacters );
+    const qint64 savedNsecs        = qint64( nsecsPerCharacter * double( d_reusedCharacters ) ) - d_lookupNsecs;
+    statistics += QStringLiteral( ", processing %1 ns/char, lookups %2 ns, estimated time saved %3 ns" )
+                  .arg( nsecsPerCharacter, 0, 'f', 1 ).arg( d_lookupNsecs ).arg( savedNsecs );
+  }
+  return statistics;
+}
+// --------------------------------------------------
+
+quint64 SharedTokenCache::key( const QString& string, WordTokens::Type type )
+{
+  /* 64 bit FNV-1a over the UTF-16 characters, starting from the type. */
+  quint64 hash = 14695981039346656037ULL ^ quint64( type );
+  const ushort* data = reinterpret_cast<const ushort*>( string.constData() );
+  const int size     = string.size();
+  for( int index = 0; index < size; ++index ) {
+    hash ^= data[index];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+// --------------------------------------------------
@@ -0,0 +1,151 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include "../../Word.h"
+#include "cppdocumentprocessor.h"
+
+#include <QCache>
+#include <QMutex>
+
+namespace SpellChecker {
+namespace CppSpellChecker {
+namespace Internal {
+
+/*! \brief The C++ Shared Token Cache class
+ *
+ * Content addressed cache of the words of comments and literals, shared by
+ * the processors of all files. Files often contain the same tokens, such as
+ * license headers and Doxygen boilerplate. When a processor finds a token
+ * that another file already processed, it only needs to move the cached
+ * words to the position of the token instead of extracting the words and
+ * applying the settings to them.
+ *
+ * The words are cached with the settings applied, but without removing the
+ * words that appear in the source, since these are different for every
+ * file. Along with the words, the texts of all words that the settings were
+ * applied to are kept. If one of them appears in the source of a file, the
+ * cached words can not be used for that file.
+ *
+ * The key is a 64 bit hash of the token and its type. The text of the token
+ * is kept in the entry and compared to rule out collisions. The cache is
+ * bounded by the estimated memory of the entries, the least recently used
+ * entries are removed first.
+ *
+ * Processors that also check the words record which tokens have no
+ * mistakes, along with the revision of the dictionary that they were
+ * checked against, see setNoMistakes(). The words of such a token do not
+ * have to be checked again while the dictionary does not change. Tokens
+ * with mistakes are checked again, so that their mistakes get suggestions
+ * the same way as the mistakes of other tokens.
+ *
+ * When the settings change the cache must be cleared. This starts a new
+ * generation, entries made by processors that started before the change
+ * are then ignored. */
+class SharedTokenCache
+{
+public:
+  /*! \brief A cached token. */
+  struct Entry
+  {
+    QString string;           /*!< Text of the token. */
+    WordTokens::Type type;    /*!< Type of the token. */
+    int32_t line   = 0;       /*!< Line of the token that the words are relative to. */
+    int32_t column = 0;       /*!< Column of the token that the words are relative to. */
+    WordList words;           /*!< Words of the token, with the settings applied. */
+    QStringList checkedWords; /*!< Texts of all words that the settings were applied to,
+                               * only kept if words that appear in the source are removed. */
+    bool noMistakes = false;  /*!< None of the words are mistakes, see dictionaryRevision. */
+    quint32 dictionaryRevision = 0; /*!< Revision of the dictionary that the words
+                                     * were checked against if noMistakes is set. */
+  };
+
+  /*! \brief Tokens shorter than this are not cached, they are cheap to process. */
+  static constexpr int MINIMUM_TOKEN_LENGTH = 24;
+
+  SharedTokenCache();
+  ~SharedTokenCache();
+
+  /*! \brief Current generation of the cache. */
+  quint32 generation() const;
+  /*! \brief Find the cached token with the same text and type.
+   * \param[in] string Text of the token.
+   * \param[in] type Type of the token.
+   * \param[out] entry The cached token if it was found.
+   * \return True if the token was found. */
+  bool find( const QString& string, WordTokens::Type type, Entry& entry );
+  /*! \brief Add a token to the cache.
+   *
+   * The token is ignored if the cache was cleared since the \a generation
+   * was obtained. The text of the token is copied, it can be a view on the
+   * source of a document. */
+  void insert( quint32 generation, Entry&& entry );
+  /*! \brief Record that the words of a token are not spelling mistakes.
+   *
+   * Ignored if the cache was cleared since the \a generation was obtained,
+   * or if the token is no longer in the cache.
+   * \param[in] generation Generation of the cache when the token was inserted.
+   * \param[in] string Text of the token.
+   * \param[in] type Type of the token.
+   * \param[in] dictionaryRevision Revision of the dictionary that the words were checked against. */
+  void setNoMistakes( quint32 generation, const QString& string, WordTokens::Type type, quint32 dictionaryRevision );
+  /*! \brief Clear the cache and start a new generation. */
+  void clear();
+  /*! \brief Record the use of a token that was found in the cache.
+   * \param[in] used False if the cached words could not be used, since some
+   *              of the checked words appear in the source of the file.
+   * \param[in] checkSkipped True if the words did not have to be checked
+   *              since the token has no mistakes. */
+  void recordUse( const Entry& entry, bool used, bool checkSkipped = false );
+  /*! \brief Record the time that a processor spent on the tokens that can be shared.
+   *
+   * Only recorded by processors built with BENCH_TIME defined. The time
+   * saved by the cache is estimated from the time per character of the
+   * tokens that were processed, minus the time of the lookups.
+   * \param[in] lookupNsecs Time spent looking up tokens, hits and misses.
+   * \param[in] missNsecs Time spent extracting and filtering the words of
+   *              tokens that were not found.
+   * \param[in] missCharacters Characters of the tokens that were not found. */
+  void recordTimes( qint64 lookupNsecs, qint64 missNsecs, qint64 missCharacters );
+  /*! \brief Get the work that the cache saved as a printable string. */
+  QString statistics() const;
+
+private:
+  Q_DISABLE_COPY( SharedTokenCache )
+  static quint64 key( const QString& string, WordTokens::Type type );
+
+  QCache<quint64, Entry> d_cache;
+  quint32 d_generation;
+  qint64 d_lookups;
+  qint64 d_hits;
+  qint64 d_rejected;
+  qint64 d_reusedWords;
+  qint64 d_reusedCharacters;
+  qint64 d_uncheckedWords;
+  qint64 d_lookupNsecs;
+  qint64 d_missNsecs;
+  qint64 d_missCharacters;
+  mutable QMutex d_mutex;
+};
+
+} // namespace Internal
+} // namespace CppSpellChecker
+} // namespace SpellChecker
@@ -0,0 +1,305 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "cppwordscanner.h"
+
+#if defined( __AVX2__ )
+#define SPELLCHECKER_AVX2
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#define SPELLCHECKER_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined( _MSC_VER ) && ( defined( SPELLCHECKER_AVX2 ) || defined( SPELLCHECKER_SSE2 ) )
+#include <intrin.h>
+#endif
+
+using namespace SpellChecker::CppSpellChecker::Internal;
+
+namespace {
+
+/*! \brief Classes of ASCII characters, as bits in the lookup table. */
+enum CharClass : quint8 {
+  ClassWord       = 0x01 /*!< Letter, number or underscore, ASCII \w. */,
+  ClassApostrophe = 0x02 /*!< Part of a word between two letters. */,
+  ClassDotAt      = 0x04 /*!< '.' or '@', part of a word between two ASCII word characters. */,
+  ClassWebsite    = 0x08 /*!< Website character, part of a word between website characters. */
+};
+
+/*! \brief Lookup table with the CharClass of the ASCII characters. */
+struct AsciiTable {
+  quint8 classes[128];
+
+  constexpr AsciiTable()
+    : classes()
+  {
+    for( int character = 0; character < 128; ++character ) {
+      quint8 value = 0;
+      if( ( ( character >= 'a' ) && ( character <= 'z' ) )
+          || ( ( character >= 'A' ) && ( character <= 'Z' ) )
+          || ( ( character >= '0' ) && ( character <= '9' ) )
+          || ( character == '_' ) ) {
+        value = ClassWord;
+      } else if( character == '\'' ) {
+        value = ClassApostrophe;
+      } else if( ( character == '.' ) || ( character == '@' ) ) {
+        value = ClassDotAt;
+      } else if( ( character == '/' ) || ( character == ':' ) || ( character == '?' ) || ( character == '=' )
+                 || ( character == '#' ) || ( character == '%' ) || ( character == '-' ) ) {
+        value = ClassWebsite;
+      }
+      classes[character] = value;
+    }
+  }
+};
+constexpr AsciiTable ASCII_TABLE;
+
+inline quint8 asciiClass( ushort character )
+{
+  return ( character < 128 ) ? ASCII_TABLE.classes[character] : quint8( 0 );
+}
+// --------------------------------------------------
+
+inline bool isAsciiWordChar( ushort character )
+{
+  return ( asciiClass( character ) & ClassWord ) != 0;
+}
+// --------------------------------------------------
+
+inline bool isWebsiteChar( ushort character )
+{
+  return ( asciiClass( character ) & ( ClassWord | ClassWebsite ) ) != 0;
+}
+// --------------------------------------------------
+
+inline int countTrailingZeros( quint32 value )
+{
+#if defined( _MSC_VER )
+  unsigned long index;
+  _BitScanForward( &index, value );
+  return int( index );
+#else
+  return __builtin_ctz( value );
+#endif
+}
+// --------------------------------------------------
+
+#if defined( SPELLCHECKER_AVX2 )
+inline __m256i inRange( __m256i units, short low, short high )
+{
+  return _mm256_and_si256( _mm256_cmpgt_epi16( units, _mm256_set1_epi16( short( low - 1 ) ) ),
+                           _mm256_cmpgt_epi16( _mm256_set1_epi16( short( high + 1 ) ), units ) );
+}
+
+/*! \brief Mask of the ASCII word characters in the units. */
+inline __m256i wordCharMask( __m256i units )
+{
+  __m256i mask = inRange( units, 'a', 'z' );
+  mask = _mm256_or_si256( mask, inRange( units, 'A', 'Z' ) );
+  mask = _mm256_or_si256( mask, inRange( units, '0', '9' ) );
+  mask = _mm256_or_si256( mask, _mm256_cmpeq_epi16( units, _mm256_set1_epi16( '_' ) ) );
+  return mask;
+}
+
+/*! \brief Mask of the units that might be part of a word, all but ASCII separators. */
+inline __m256i candidateMask( __m256i units )
+{
+  /* Units from 0x8000 and up are negative as signed values, the rest of the
+   * non ASCII units are larger than 0x7F. */
+  __m256i mask = _mm256_or_si256( wordCharMask( units ), _mm256_cmpgt_epi16( _mm256_setzero_si256(), units ) );
+  for( const char character: { '\'', '.', '@', '/', ':', '?', '=', '#', '%', '-' } ) {
+    mask = _mm256_or_si256( mask, _mm256_cmpeq_epi16( units, _mm256_set1_epi16( character ) ) );
+  }
+  mask = _mm256_or_si256( mask, _mm256_cmpgt_epi16( units, _mm256_set1_epi16( 0x7F ) ) );
+  return mask;
+}
+#elif defined( SPELLCHECKER_SSE2 )
+inline __m128i inRange( __m128i units, short low, short high )
+{
+  return _mm_and_si128( _mm_cmpgt_epi16( units, _mm_set1_epi16( short( low - 1 ) ) ),
+                        _mm_cmplt_epi16( units, _mm_set1_epi16( short( high + 1 ) ) ) );
+}
+
+/*! \brief Mask of the ASCII word characters in the units. */
+inline __m128i wordCharMask( __m128i units )
+{
+  __m128i mask = inRange( units, 'a', 'z' );
+  mask = _mm_or_si128( mask, inRange( units, 'A', 'Z' ) );
+  mask = _mm_or_si128( mask, inRange( units, '0', '9' ) );
+  mask = _mm_or_si128( mask, _mm_cmpeq_epi16( units, _mm_set1_epi16( '_' ) ) );
+  return mask;
+}
+
+/*! \brief Mask of the units that might be part of a word, all but ASCII separators. */
+inline __m128i candidateMask( __m128i units )
+{
+  /* Units from 0x8000 and up are negative as signed values, the rest of the
+   * non ASCII units are larger than 0x7F. */
+  __m128i mask = _mm_or_si128( wordCharMask( units ), _mm_cmplt_epi16( units, _mm_setzero_si128() ) );
+  for( const char character: { '\'', '.', '@', '/', ':', '?', '=', '#', '%', '-' } ) {
+    mask = _mm_or_si128( mask, _mm_cmpeq_epi16( units, _mm_set1_epi16( character ) ) );
+  }
+  mask = _mm_or_si128( mask, _mm_cmpgt_epi16( units, _mm_set1_epi16( 0x7F ) ) );
+  return mask;
+}
+#endif
+
+/*! \brief Find the first unit from \a position that is not an ASCII word character. */
+inline int skipWordChars( const ushort* data, int size, int position )
+{
+#if defined( SPELLCHECKER_AVX2 )
+  for( ; position + 16 <= size; position += 16 ) {
+    const __m256i units = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + position ) );
+    const quint32 mask  = quint32( _mm256_movemask_epi8( wordCharMask( units ) ) );
+    if( mask != 0xFFFFFFFFu ) {
+      return position + countTrailingZeros( ~mask ) / 2;
+    }
+  }
+#elif defined( SPELLCHECKER_SSE2 )
+  for( ; position + 8 <= size; position += 8 ) {
+    const __m128i units = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + position ) );
+    const quint32 mask  = quint32( _mm_movemask_epi8( wordCharMask( units ) ) );
+    if( mask != 0xFFFFu ) {
+      return position + countTrailingZeros( ~mask ) / 2;
+    }
+  }
+#endif
+  while( ( position < size )
+         && ( isAsciiWordChar( data[position] ) == true ) ) {
+    ++position;
+  }
+  return position;
+}
+// --------------------------------------------------
+
+/*! \brief Find the first unit from \a position that might be part of a word.
+ *
+ * All units that are skipped are ASCII characters that are always the end
+ * of a word. */
+inline int skipSeparators( const ushort* data, int size, int position )
+{
+#if defined( SPELLCHECKER_AVX2 )
+  for( ; position + 16 <= size; position += 16 ) {
+    const __m256i units = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( data + position ) );
+    const quint32 mask  = quint32( _mm256_movemask_epi8( candidateMask( units ) ) );
+    if( mask != 0 ) {
+      return position + countTrailingZeros( mask ) / 2;
+    }
+  }
+#elif defined( SPELLCHECKER_SSE2 )
+  for( ; position + 8 <= size; position += 8 ) {
+    const __m128i units = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + position ) );
+    const quint32 mask  = quint32( _mm_movemask_epi8( candidateMask( units ) ) );
+    if( mask != 0 ) {
+      return position + countTrailingZeros( mask ) / 2;
+    }
+  }
+#endif
+  while( ( position < size )
+         && ( data[position] < 128 )
+         && ( ASCII_TABLE.classes[data[position]] == 0 ) ) {
+    ++position;
+  }
+  return position;
+}
+// --------------------------------------------------
+
+} // namespace
+
+CppWordScanner::CppWordScanner( bool websiteChars )
+  : d_websiteChars( websiteChars )
+{}
+// --------------------------------------------------
+
+bool CppWordScanner::nextWord( const QChar* data, int size, int& position, int& wordStart, int& wordEnd ) const
+{
+  const ushort* units = reinterpret_cast<const ushort*>( data );
+  /* Find the start of the word, the first character that is not the end
+   * of a word. */
+  int current = position;
+  while( true ) {
+    current = skipSeparators( units, size, current );
+    if( current >= size ) {
+      position = size;
+      return false;
+    }
+    if( isEndOfWord( data, size, current ) == false ) {
+      break;
+    }
+    ++current;
+  }
+  wordStart = current;
+  /* Find the end of the word, the first character that is the end of a word. */
+  ++current;
+  while( current < size ) {
+    current = skipWordChars( units, size, current );
+    if( ( current >= size )
+        || ( isEndOfWord( data, size, current ) == true ) ) {
+      break;
+    }
+    ++current;
+  }
+  wordEnd  = qMin( current, size );
+  position = wordEnd;
+  return true;
+}
+// --------------------------------------------------
+
+bool CppWordScanner::isEndOfWord( const QChar* data, int size, int position ) const
+{
+  if( position >= size ) {
+    return true;
+  }
+  const ushort character = data[position].unicode();
+  const quint8 charClass = asciiClass( character );
+  if( ( charClass & ClassWord ) != 0 ) {
+    return false;
+  }
+  if( character >= 128 ) {
+    /* Letters and numbers in the rest of Unicode. */
+    return data[position].isLetterOrNumber() == false;
+  }
+  if( charClass == 0 ) {
+    return true;
+  }
+  const bool atEdge = ( position == 0 ) || ( position == size - 1 );
+  if( atEdge == true ) {
+    return true;
+  }
+  const ushort before = data[position - 1].unicode();
+  const ushort after  = data[position + 1].unicode();
+  switch( charClass ) {
+    case ClassApostrophe:
+      return ( data[position - 1].isLetter() == false )
+             || ( data[position + 1].isLetter() == false );
+    case ClassDotAt:
+      return ( isAsciiWordChar( before ) == false )
+             || ( isAsciiWordChar( after ) == false );
+    case ClassWebsite:
+      return ( d_websiteChars == false )
+             || ( isWebsiteChar( before ) == false )
+             || ( isWebsiteChar( after ) == false );
+    default:
+      break;
+  }
+  return true;
+}
+// --------------------------------------------------
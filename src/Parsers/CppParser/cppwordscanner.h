@@ -0,0 +1,75 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include <QChar>
+
+namespace SpellChecker {
+namespace CppSpellChecker {
+namespace Internal {
+
+/*! \brief The C++ Word Scanner class
+ *
+ * Finds the words in a comment or string literal. A word is a run of
+ * characters where none of them is the end of a word, the same rules as
+ * CppDocumentProcessor::isEndOfCurrentWord() uses:
+ *  - Letters, numbers and underscores are part of a word.
+ *  - An apostrophe is part of a word if it is between two letters.
+ *  - A '.' or '@' is part of a word if it is between two ASCII word
+ *      characters, for abbreviations and email addresses.
+ *  - If website addresses are removed, the website characters
+ *      ([/:?=#%-]) are part of a word if they are between two ASCII word
+ *      characters or website characters.
+ *
+ * Instead of checking every character with these rules, the scanner skips
+ * runs of ASCII letters, numbers and underscores inside a word, and runs of
+ * ASCII characters that can never be part of a word between words. These runs
+ * are found 8 (SSE2) or 16 (AVX2) characters at a time. Only the characters
+ * that stop a run are classified, using a lookup table for ASCII characters.
+ */
+class CppWordScanner
+{
+public:
+  /*! \brief Construct the scanner.
+   * \param[in] websiteChars If website characters can be part of a word,
+   *              the removeWebsites setting of the parser. */
+  explicit CppWordScanner( bool websiteChars );
+
+  /*! \brief Find the next word in the string.
+   *
+   * \param[in] data Characters of the string.
+   * \param[in] size Number of characters in the string.
+   * \param[in,out] position Position to start searching from. Updated to the
+   *                  position to continue searching from for the next word.
+   * \param[out] wordStart Position of the first character of the word.
+   * \param[out] wordEnd Position after the last character of the word.
+   * \return False if there are no more words in the string. */
+  bool nextWord( const QChar* data, int size, int& position, int& wordStart, int& wordEnd ) const;
+  /*! \brief Check if the character at the position is the end of a word. */
+  bool isEndOfWord( const QChar* data, int size, int position ) const;
+
+private:
+  bool d_websiteChars;
+};
+
+} // namespace Internal
+} // namespace CppSpellChecker
+} // namespace SpellChecker
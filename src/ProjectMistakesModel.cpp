@@ -18,6 +18,7 @@
 ** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
 ****************************************************************************/
 
+#include "MistakeStore.h"
 #include "ProjectMistakesModel.h"
 
 #include <coreplugin/editormanager/editormanager.h>
@@ -25,16 +26,29 @@
 
 #include <QFileInfo>
 
+// #define BENCH_TIME
+#ifdef BENCH_TIME
+#include <QDebug>
+
+#include <numeric>
+#endif /* BENCH_TIME */
+
 using namespace SpellChecker::Internal;
 using namespace SpellChecker;
 
-using WordListInternalPair = QPair<SpellChecker::WordList, bool /* In Startup Project */>;
-using FileMistakes         = QMap<QString, WordListInternalPair>;
+using FileMistakes = QMap<QString, bool /* In Startup Project */>;
 
 class SpellChecker::Internal::ProjectMistakesModelPrivate
 {
 public:
-  FileMistakes spellingMistakes;
+  FileMistakes spellingMistakes; /*!< Files with mistakes, the mistakes are
+                                 * kept in the \a mistakes store. */
+  MistakeStore mistakes;
+#ifdef BENCH_TIME
+  /*! \brief Estimated memory that the mistakes of each file would use if
+   * they were kept as a WordList. */
+  QHash<QString, qint64> wordListMemoryUsage;
+#endif /* BENCH_TIME */
   QList<QString> sortedKeys; /*!< This list contains the keys of the
                               * spellingMistakes map but sorted according
                               * to the selected \a column and \a order.
@@ -83,18 +97,26 @@ void ProjectMistakesModel::insertSpellingMistakes( const QString& fileName, cons
     Q_ASSERT( idx != -1 );
     beginRemoveRows( QModelIndex(), idx, idx );
     d->spellingMistakes.remove( fileName );
+    d->mistakes.removeFile( fileName );
+#ifdef BENCH_TIME
+    d->wordListMemoryUsage.remove( fileName );
+#endif /* BENCH_TIME */
     d->sortedKeys.removeAll( fileName );
     endRemoveRows();
     return;
   }
 
   /* So there are misspelled words */
+#ifdef BENCH_TIME
+  d->wordListMemoryUsage[fileName] = MistakeStore::wordListMemoryUsage( words );
+  const qint64 wordListBytes = std::accumulate( d->wordListMemoryUsage.constBegin(), d->wordListMemoryUsage.constEnd(), qint64( 0 ) );
+#endif /* BENCH_TIME */
   if( file != d->spellingMistakes.end() ) {
     /* The file was added with mistakes before, check if there are a change in the
      * total number of items. */
-    bool changed = ( file.value().first.count() != words.count() );
+    bool changed = ( d->mistakes.mistakeCount( fileName ) != words.count() );
     /* Assign the words to the file */
-    file.value().first = words;
+    d->mistakes.setMistakes( fileName, words );
     /* Notify of the change if there was one */
     if( changed == true ) {
       int idx = indexOfFile( fileName );
@@ -105,10 +127,16 @@ void ProjectMistakesModel::insertSpellingMistakes( const QString& fileName, cons
     /* Insert the mistakes for the file. The model is not notified of the
      * change here since the sort() function will in any case invalidate
      * all of the views and they will get refreshed after that. */
-    d->spellingMistakes.insert( fileName, qMakePair( words, inStartupProject ) );
+    d->spellingMistakes.insert( fileName, inStartupProject );
+    d->mistakes.setMistakes( fileName, words );
     d->sortedKeys.append( fileName );
     sort( static_cast<int>( d->sortedColumn ), d->sortOrder );
   }
+#ifdef BENCH_TIME
+  qDebug() << "Mistakes memory: "
+           << "\n  - as word lists: " << wordListBytes
+           << "\n  - compact      : " << d->mistakes.memoryUsage();
+#endif /* BENCH_TIME */
 }
 // --------------------------------------------------
 
@@ -116,30 +144,47 @@ void ProjectMistakesModel::clearAllSpellingMistakes()
 {
   beginResetModel();
   d->spellingMistakes.clear();
+  d->mistakes.clear();
   d->sortedKeys.clear();
+#ifdef BENCH_TIME
+  d->wordListMemoryUsage.clear();
+#endif /* BENCH_TIME */
   endResetModel();
 }
 // --------------------------------------------------
 
 SpellChecker::WordList ProjectMistakesModel::mistakesForFile( const QString& fileName ) const
 {
-  return d->spellingMistakes.value( fileName ).first;
+  return d->mistakes.mistakes( fileName );
+}
+// --------------------------------------------------
+
+bool ProjectMistakesModel::mistakeAt( const QString& fileName, int32_t line, int32_t column, SpellChecker::Word& word ) const
+{
+  return d->mistakes.mistakeAt( fileName, line, column, word );
+}
+// --------------------------------------------------
+
+SpellChecker::WordList ProjectMistakesModel::mistakesOfWord( const QString& fileName, const QString& wordText ) const
+{
+  return d->mistakes.mistakesOfWord( fileName, wordText );
+}
+// --------------------------------------------------
+
+QStringList ProjectMistakesModel::wordsWithoutSuggestions( const QString& fileName ) const
+{
+  return d->mistakes.wordsWithoutSuggestions( fileName );
 }
 // --------------------------------------------------
 
 void ProjectMistakesModel::removeAllOccurrences( const QString& wordText )
 {
   beginResetModel();
-  FileMistakes::Iterator iter = d->spellingMistakes.begin();
-  while( iter != d->spellingMistakes.end() ) {
-    iter.value().first.remove( wordText );
-    /* If there are no more words for the file, remove the file from the list */
-    if( iter.value().first.isEmpty() == true ) {
-      d->sortedKeys.removeAll( iter.key() );
-      iter = d->spellingMistakes.erase( iter );
-    } else {
-      ++iter;
-    }
+  /* If there are no more words for a file, remove the file from the list */
+  const QStringList emptyFiles = d->mistakes.removeWord( wordText );
+  for( const QString& fileName: emptyFiles ) {
+    d->sortedKeys.removeAll( fileName );
+    d->spellingMistakes.remove( fileName );
   }
   endResetModel();
 }
@@ -165,7 +210,7 @@ void ProjectMistakesModel::projectFilesChanged( QStringSet filesAdded, QStringSe
       auto wordIter = d->spellingMistakes.find( *addedIter );
       if( wordIter != mistakesEnd ) {
         /* Found one */
-        wordIter.value().second = true;
+        wordIter.value() = true;
         const int32_t row       = indexOfFile( *addedIter );
         const QModelIndex idx   = index( row, COLUMN_FILE_IN_STARTUP );
         emit dataChanged( idx, idx );
@@ -179,7 +224,7 @@ void ProjectMistakesModel::projectFilesChanged( QStringSet filesAdded, QStringSe
       auto wordIter = d->spellingMistakes.find( *removedIter );
       if( wordIter != mistakesEnd ) {
         /* Found one */
-        wordIter.value().second = false;
+        wordIter.value() = false;
         const int32_t row       = indexOfFile( *removedIter );
         const QModelIndex idx   = index( row, COLUMN_FILE_IN_STARTUP );
         emit dataChanged( idx, idx );
@@ -196,9 +241,9 @@ void ProjectMistakesModel::fileSelected( const QModelIndex& index )
     Core::IEditor* editor = Core::EditorManager::openEditor( fileName );
     emit editorOpened();
     Q_ASSERT( editor != nullptr );
-    Q_ASSERT( d->spellingMistakes.value( fileName ).first.isEmpty() == false );
+    Q_ASSERT( d->mistakes.contains( fileName ) == true );
     /* Go to the first misspelled word in the editor. */
-    const SpellChecker::WordList words = d->spellingMistakes.value( fileName ).first;
+    const SpellChecker::WordList words = d->mistakes.mistakes( fileName );
     Q_ASSERT( words.empty() == false );
     /* Get a word on the first line with a spelling mistake and
      * go to that line. This is to ensure that the highest up spelling
@@ -268,13 +313,13 @@ QVariant ProjectMistakesModel::data( const QModelIndex& index, int role ) const
     case COLUMN_FILE:
       return QFileInfo( iter.key() ).fileName();
     case COLUMN_MISTAKES_TOTAL:
-      return ( iter.value().first.count() );
+      return d->mistakes.mistakeCount( iter.key() );
     case COLUMN_FILEPATH:
       return iter.key();
     case COLUMN_FILE_IN_STARTUP:
-      return ( iter.value().second );
+      return ( iter.value() );
     case COLUMN_LITERAL_COUNT:
-      return countStringLiterals( iter.value().first );
+      return d->mistakes.literalCount( iter.key() );
     case COLUMN_FILE_TYPE:
       return QFileInfo( iter.key() ).suffix();
     default:
@@ -310,8 +355,8 @@ void ProjectMistakesModel::sort( int column, Qt::SortOrder order )
      * them on the requested column.
      * This ensures that the files are grouped together based on internal or external
      * and then sorted according to name. The external files will always be listed last. */
-    if( iterLhs.value().second != iterRhs.value().second ) {
-      return iterLhs.value().second;
+    if( iterLhs.value() != iterRhs.value() ) {
+      return iterLhs.value();
     }
     bool greaterThan = false;
 
@@ -322,17 +367,17 @@ void ProjectMistakesModel::sort( int column, Qt::SortOrder order )
         greaterThan = ( QFileInfo( iterLhs.key() ).fileName().toUpper() < QFileInfo( iterRhs.key() ).fileName().toUpper() );
         break;
       case COLUMN_MISTAKES_TOTAL:
-        greaterThan = ( iterLhs.value().first.count() < iterRhs.value().first.count() );
+        greaterThan = ( d->mistakes.mistakeCount( iterLhs.key() ) < d->mistakes.mistakeCount( iterRhs.key() ) );
         break;
       case COLUMN_FILEPATH:
         greaterThan = ( iterLhs.key().toUpper() < iterRhs.key().toUpper() );
         break;
       case COLUMN_FILE_IN_STARTUP:
-        greaterThan = iterLhs.value().second;
+        greaterThan = iterLhs.value();
         break;
       case COLUMN_LITERAL_COUNT: {
-        int countLhs = countStringLiterals( iterLhs.value().first );
-        int countRhs = countStringLiterals( iterRhs.value().first );
+        int countLhs = d->mistakes.literalCount( iterLhs.key() );
+        int countRhs = d->mistakes.literalCount( iterRhs.key() );
         greaterThan  = ( countLhs < countRhs );
         break;
       }
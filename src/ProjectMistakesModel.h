@@ -82,6 +82,28 @@ public:
    * \return A list of misspelled words for the file.
    */
   WordList mistakesForFile( const QString& fileName ) const;
+  /*! \brief Get the mistake at a position in a file.
+   *
+   * Only the mistake that is found is converted to a Word, use this instead
+   * of searching mistakesForFile() for a single position.
+   * \param[in] fileName Name of the file.
+   * \param[in] line Line of the position.
+   * \param[in] column Column of the position.
+   * \param[out] word The mistake at the position, if there is one.
+   * \return true if there is a mistake at the position.
+   */
+  bool mistakeAt( const QString& fileName, int32_t line, int32_t column, Word& word ) const;
+  /*! \brief Get all occurrences of a misspelled word in a file.
+   * \param[in] fileName Name of the file.
+   * \param[in] wordText Text of the word.
+   * \return The mistakes in the file with the text of the word.
+   */
+  WordList mistakesOfWord( const QString& fileName, const QString& wordText ) const;
+  /*! \brief Get the texts of the mistakes in a file that do not have suggestions.
+   * \param[in] fileName Name of the file.
+   * \return Each text of a mistake without suggestions once.
+   */
+  QStringList wordsWithoutSuggestions( const QString& fileName ) const;
   /*! \brief Remove all occurrences of the word.
    *
    * This function is used to remove all occurrences of the given word from
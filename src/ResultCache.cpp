@@ -0,0 +1,311 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "ResultCache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+using namespace SpellChecker::Internal;
+using namespace SpellChecker;
+
+namespace {
+/*! \brief Magic number at the start of the cache file. */
+const quint32 CACHE_FILE_MAGIC = 0x53435252;
+/*! \brief Version of the cache file format.
+ *
+ * Increment this if the format changes, files with a different version are
+ * ignored when loading. */
+const quint32 CACHE_FILE_VERSION = 1;
+
+/*! \brief Write the words, without their file name that is the same for all. */
+void writeWords( QDataStream& stream, const WordList& words )
+{
+  stream << qint32( words.size() );
+  for( const Word& word: words ) {
+    stream << qint32( word.start ) << qint32( word.end ) << qint32( word.length )
+           << qint32( word.lineNumber ) << qint32( word.columnNumber )
+           << word.text << word.charAfter << word.inComment << word.suggestions;
+  }
+}
+// --------------------------------------------------
+
+/*! \brief Read the words written by writeWords().
+ *
+ * The texts of the words are shared between all words read with the same
+ * \a texts. */
+bool readWords( QDataStream& stream, const QString& fileName, QHash<QString, QString>& texts, WordList& words )
+{
+  qint32 count = 0;
+  stream >> count;
+  if( ( stream.status() != QDataStream::Ok )
+      || ( count < 0 ) ) {
+    return false;
+  }
+  words.reserve( count );
+  for( qint32 index = 0; index < count; ++index ) {
+    Word word;
+    qint32 start;
+    qint32 end;
+    qint32 length;
+    qint32 line;
+    qint32 column;
+    stream >> start >> end >> length >> line >> column
+           >> word.text >> word.charAfter >> word.inComment >> word.suggestions;
+    if( stream.status() != QDataStream::Ok ) {
+      return false;
+    }
+    word.start        = start;
+    word.end          = end;
+    word.length       = length;
+    word.lineNumber   = line;
+    word.columnNumber = column;
+    word.fileName     = fileName;
+    QHash<QString, QString>::const_iterator text = texts.constFind( word.text );
+    if( text != texts.constEnd() ) {
+      word.text = text.value();
+    } else {
+      texts.insert( word.text, word.text );
+    }
+    words.append( std::move( word ) );
+  }
+  return true;
+}
+// --------------------------------------------------
+} // namespace
+
+ResultCache::ResultCache()
+{}
+// --------------------------------------------------
+
+ResultCache::~ResultCache()
+{}
+// --------------------------------------------------
+
+bool ResultCache::load( const QString& projectFile )
+{
+  d_projectFile = projectFile;
+  d_entries.clear();
+
+  const QString fileName = cacheFile( projectFile );
+  QFile file( fileName );
+  if( file.open( QIODevice::ReadOnly ) == false ) {
+    return false;
+  }
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_12 );
+  quint32 magic   = 0;
+  quint32 version = 0;
+  stream >> magic >> version;
+  if( ( magic != CACHE_FILE_MAGIC )
+      || ( version != CACHE_FILE_VERSION ) ) {
+    qDebug() << "ResultCache: Ignoring cache file with unknown format: " << fileName;
+    return false;
+  }
+
+  QHash<QString, QString> texts;
+  while( stream.atEnd() == false ) {
+    QString sourceFile;
+    Entry entry;
+    stream >> sourceFile >> entry.result.parser >> entry.result.settings >> entry.result.dictionary
+           >> entry.size >> entry.modified >> entry.hash;
+    if( ( stream.status() != QDataStream::Ok )
+        || ( readWords( stream, sourceFile, texts, entry.result.words ) == false )
+        || ( readWords( stream, sourceFile, texts, entry.result.mistakes ) == false ) ) {
+      /* Keep what was read up to the error. */
+      break;
+    }
+    /* Only keep the result if the file did not change. If the size and time
+     * are the same the content is assumed to be the same, otherwise the
+     * content is compared, for example for files that were checked out
+     * again without changes. */
+    const QFileInfo info( sourceFile );
+    if( info.exists() == false ) {
+      continue;
+    }
+    const qint64 size     = info.size();
+    const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+    if( ( size != entry.size )
+        || ( modified != entry.modified ) ) {
+      if( ( size != entry.size )
+          || ( contentHash( sourceFile ) != entry.hash ) ) {
+        continue;
+      }
+      entry.modified = modified;
+    }
+    entry.hasMistakes = true;
+    d_entries.insert( sourceFile, entry );
+  }
+  return true;
+}
+// --------------------------------------------------
+
+bool ResultCache::save() const
+{
+  if( d_projectFile.isEmpty() == true ) {
+    return false;
+  }
+  const QString fileName = cacheFile( d_projectFile );
+  QFileInfo( fileName ).dir().mkpath( QStringLiteral( "." ) );
+  /* Use a save file so that a crash while writing does not leave a
+   * truncated cache behind. */
+  QSaveFile file( fileName );
+  if( file.open( QIODevice::WriteOnly ) == false ) {
+    qDebug() << "ResultCache: Could not open cache file: " << fileName;
+    return false;
+  }
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_12 );
+  stream << CACHE_FILE_MAGIC << CACHE_FILE_VERSION;
+  for( QHash<QString, Entry>::const_iterator iter = d_entries.constBegin(); iter != d_entries.constEnd(); ++iter ) {
+    const Entry& entry = iter.value();
+    if( entry.hasMistakes == false ) {
+      continue;
+    }
+    /* The words are only valid for the content that the file had when they
+     * were extracted. If the file changed since then, the result is not
+     * saved. */
+    const QFileInfo info( iter.key() );
+    if( ( info.exists() == false )
+        || ( info.size() != entry.size )
+        || ( info.lastModified().toMSecsSinceEpoch() != entry.modified ) ) {
+      continue;
+    }
+    const QByteArray hash = ( entry.hash.isEmpty() == true )
+                            ? contentHash( iter.key() )
+                            : entry.hash;
+    if( hash.isEmpty() == true ) {
+      continue;
+    }
+    stream << iter.key() << entry.result.parser << entry.result.settings << entry.result.dictionary
+           << entry.size << entry.modified << hash;
+    writeWords( stream, entry.result.words );
+    writeWords( stream, entry.result.mistakes );
+  }
+  return file.commit();
+}
+// --------------------------------------------------
+
+void ResultCache::clear()
+{
+  d_projectFile.clear();
+  d_entries.clear();
+}
+// --------------------------------------------------
+
+void ResultCache::setProjectFile( const QString& projectFile )
+{
+  d_projectFile = projectFile;
+  d_entries.clear();
+}
+// --------------------------------------------------
+
+QString ResultCache::projectFile() const
+{
+  return d_projectFile;
+}
+// --------------------------------------------------
+
+QStringList ResultCache::merge( const ResultCache& other )
+{
+  QStringList added;
+  for( QHash<QString, Entry>::const_iterator iter = other.d_entries.constBegin(); iter != other.d_entries.constEnd(); ++iter ) {
+    if( d_entries.contains( iter.key() ) == false ) {
+      d_entries.insert( iter.key(), iter.value() );
+      added.append( iter.key() );
+    }
+  }
+  return added;
+}
+// --------------------------------------------------
+
+void ResultCache::setWords( const QString& fileName, const QString& parser, const QString& settings, const WordList& words )
+{
+  const QFileInfo info( fileName );
+  Entry& entry          = d_entries[fileName];
+  entry.result.parser   = parser;
+  entry.result.settings = settings;
+  entry.result.words    = words;
+  entry.result.mistakes.clear();
+  entry.size            = info.size();
+  entry.modified        = info.lastModified().toMSecsSinceEpoch();
+  entry.hash.clear();
+  entry.hasMistakes     = false;
+}
+// --------------------------------------------------
+
+void ResultCache::setMistakes( const QString& fileName, const QString& dictionary, const WordList& mistakes )
+{
+  QHash<QString, Entry>::iterator iter = d_entries.find( fileName );
+  if( iter == d_entries.end() ) {
+    return;
+  }
+  iter.value().result.dictionary = dictionary;
+  iter.value().result.mistakes   = mistakes;
+  iter.value().hasMistakes       = true;
+}
+// --------------------------------------------------
+
+void ResultCache::remove( const QString& fileName )
+{
+  d_entries.remove( fileName );
+}
+// --------------------------------------------------
+
+QHash<QString, ResultCache::Result> ResultCache::results() const
+{
+  QHash<QString, Result> results;
+  for( QHash<QString, Entry>::const_iterator iter = d_entries.constBegin(); iter != d_entries.constEnd(); ++iter ) {
+    if( iter.value().hasMistakes == true ) {
+      results.insert( iter.key(), iter.value().result );
+    }
+  }
+  return results;
+}
+// --------------------------------------------------
+
+QString ResultCache::cacheFile( const QString& projectFile )
+{
+  const QByteArray projectHash = QCryptographicHash::hash( projectFile.toUtf8(), QCryptographicHash::Sha1 ).toHex();
+  return QStandardPaths::writableLocation( QStandardPaths::CacheLocation )
+         + QLatin1String( "/SpellChecker/results/" ) + QString::fromLatin1( projectHash ) + QLatin1String( ".cache" );
+}
+// --------------------------------------------------
+
+QByteArray ResultCache::contentHash( const QString& fileName )
+{
+  QFile file( fileName );
+  if( file.open( QIODevice::ReadOnly ) == false ) {
+    return {};
+  }
+  QCryptographicHash hash( QCryptographicHash::Sha1 );
+  if( hash.addData( &file ) == false ) {
+    return {};
+  }
+  return hash.result();
+}
+// --------------------------------------------------
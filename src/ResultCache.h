@@ -0,0 +1,129 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include "Word.h"
+
+#include <QByteArray>
+#include <QHash>
+
+namespace SpellChecker {
+namespace Internal {
+
+/*! \brief The ResultCache class
+ *
+ * Results of the files of a project that are kept between sessions, so that
+ * files that did not change do not have to be parsed and spell checked again
+ * when the project is opened.
+ *
+ * The result of a file is the list of words that the parser extracted and
+ * the mistakes that the spell checker found in those words. It is stored
+ * along with the identity of the settings of the parser and the identity of
+ * the dictionary. The user of the cache must only use a result if these
+ * are still the same.
+ *
+ * The results of a project are stored in a single file in the cache
+ * location of Qt Creator. When the file is saved the content hash of every
+ * file is stored with its result. When the results are loaded, only
+ * results of files that still have the same content are kept. The size and
+ * modification time of a file are checked first, the content is only read
+ * and hashed if these changed.
+ */
+class ResultCache
+{
+public:
+  /*! \brief Result of a single file. */
+  struct Result {
+    QString parser;     /*!< Name of the parser that extracted the words. */
+    QString settings;   /*!< Identity of the settings of the parser. */
+    QString dictionary; /*!< Identity of the dictionary used to check the words. */
+    WordList words;     /*!< Words extracted from the file. */
+    WordList mistakes;  /*!< Misspelled words of the file. */
+  };
+
+  ResultCache();
+  ~ResultCache();
+
+  /*! \brief Load the results of the project.
+   *
+   * The current results are replaced by the results of files in the project
+   * that did not change since they were saved.
+   *
+   * This reads every result and hashes the files that changed on disk, thus
+   * it should be called on a cache of its own in a background thread. The
+   * loaded results are then added to the cache in use with merge().
+   * \param[in] projectFile File of the project.
+   * \return False if there were no results for the project. */
+  bool load( const QString& projectFile );
+  /*! \brief Start keeping the results of the project, without loading the
+   * results that were saved before.
+   *
+   * The current results are removed. */
+  void setProjectFile( const QString& projectFile );
+  /*! \brief Get the file of the project that the results are kept for. */
+  QString projectFile() const;
+  /*! \brief Add the results that were loaded in the \a other cache.
+   *
+   * Only results of files that do not have a result in this cache are
+   * added, the results in this cache are newer.
+   * \return The files of which the results were added. */
+  QStringList merge( const ResultCache& other );
+  /*! \brief Save the results to the file of the project that was loaded last.
+   *
+   * Results of files that changed since they were parsed, or that did not get
+   * their mistakes yet, are not saved. */
+  bool save() const;
+  /*! \brief Remove all results and forget the project. */
+  void clear();
+
+  /*! \brief Set the words of a file that were extracted by the parser.
+   *
+   * The mistakes of the file are cleared until setMistakes() is called. */
+  void setWords( const QString& fileName, const QString& parser, const QString& settings, const WordList& words );
+  /*! \brief Set the mistakes that were found in the words of the file.
+   *
+   * Ignored if the words of the file are not known. */
+  void setMistakes( const QString& fileName, const QString& dictionary, const WordList& mistakes );
+  /*! \brief Remove the result of the file. */
+  void remove( const QString& fileName );
+  /*! \brief Get the results of all files that have words and mistakes. */
+  QHash<QString, Result> results() const;
+
+private:
+  /*! \brief Result of a file along with what is needed to detect changes to the file. */
+  struct Entry {
+    Result result;
+    qint64 size       = -1;    /*!< Size of the file when the words were set. */
+    qint64 modified   = -1;    /*!< Modification time of the file when the words were set. */
+    QByteArray hash;           /*!< Hash of the content of the file, empty if not known yet. */
+    bool hasMistakes  = false; /*!< If the mistakes of the current words are known. */
+  };
+  /*! \brief Get the file that the results of the project are stored in. */
+  static QString cacheFile( const QString& projectFile );
+  /*! \brief Get the hash of the content of the file, empty if it can not be read. */
+  static QByteArray contentHash( const QString& fileName );
+
+  QString d_projectFile;
+  QHash<QString, Entry> d_entries;
+};
+
+} // namespace Internal
+} // namespace SpellChecker
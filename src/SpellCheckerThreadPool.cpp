@@ -0,0 +1,86 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "SpellCheckerThreadPool.h"
+
+#include <QThread>
+
+using namespace SpellChecker;
+
+namespace {
+/*! \brief Number of workers of the interactive lane.
+ *
+ * More than one so that a new run for the current editor does not have to
+ * wait for a run that is busy being cancelled. */
+const int INTERACTIVE_WORKER_COUNT = 2;
+} // namespace
+
+SpellCheckerThreadPool::SpellCheckerThreadPool()
+{
+  d_interactive.setMaxThreadCount( INTERACTIVE_WORKER_COUNT );
+  /* Keep the threads of the interactive lane alive, a thread should not be
+   * created each time that the current file is edited. */
+  d_interactive.setExpiryTimeout( -1 );
+  d_bulk.setMaxThreadCount( automaticWorkerCount() );
+  d_threadCount.storeRelaxed( INTERACTIVE_WORKER_COUNT + d_bulk.maxThreadCount() );
+}
+// --------------------------------------------------
+
+SpellCheckerThreadPool::~SpellCheckerThreadPool()
+{
+  d_interactive.clear();
+  d_bulk.clear();
+  d_interactive.waitForDone();
+  d_bulk.waitForDone();
+}
+// --------------------------------------------------
+
+QThreadPool* SpellCheckerThreadPool::pool( Lane lane )
+{
+  return ( lane == Lane::Interactive )
+         ? &d_interactive
+         : &d_bulk;
+}
+// --------------------------------------------------
+
+void SpellCheckerThreadPool::setWorkerCount( int count )
+{
+  d_bulk.setMaxThreadCount( ( count > 0 ) ? count : automaticWorkerCount() );
+  d_threadCount.storeRelaxed( INTERACTIVE_WORKER_COUNT + d_bulk.maxThreadCount() );
+}
+// --------------------------------------------------
+
+int SpellCheckerThreadPool::workerCount() const
+{
+  return d_bulk.maxThreadCount();
+}
+// --------------------------------------------------
+
+int SpellCheckerThreadPool::threadCount() const
+{
+  return d_threadCount.loadRelaxed();
+}
+// --------------------------------------------------
+
+int SpellCheckerThreadPool::automaticWorkerCount()
+{
+  return qMax( 1, QThread::idealThreadCount() / 2 );
+}
+// --------------------------------------------------
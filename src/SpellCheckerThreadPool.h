@@ -0,0 +1,80 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QThreadPool>
+
+namespace SpellChecker {
+
+/*! \brief The SpellCheckerThreadPool class
+ *
+ * Threads used by the spell checker for its background work. The spell
+ * checker does not use the global thread pool, so that it does not compete
+ * with the indexer and locator of Qt Creator for the threads.
+ *
+ * The work is split in two lanes, each with its own pool of threads:
+ *  - The interactive lane is for the file in the current editor. The user
+ *    is waiting on this work, thus it has threads that are kept alive and
+ *    run at a high priority.
+ *  - The bulk lane is for all other files of the project. The number of
+ *    workers of this lane can be configured.
+ *
+ * Since the lanes do not share threads, work in the interactive lane never
+ * waits behind the work queued in the bulk lane while a project is parsed. */
+class SpellCheckerThreadPool
+{
+public:
+  /*! \brief Lane that work is queued in. */
+  enum class Lane {
+    Interactive = 0, /*!< Work for the current editor. */
+    Bulk             /*!< Background work for the project. */
+  };
+
+  SpellCheckerThreadPool();
+  /*! \brief Destructor, waits for all work in both lanes to finish. */
+  ~SpellCheckerThreadPool();
+
+  /*! \brief Get the pool of the \a lane to start work in. */
+  QThreadPool* pool( Lane lane );
+  /*! \brief Set the number of workers of the bulk lane.
+   * \param[in] count Number of workers, 0 to use automaticWorkerCount(). */
+  void setWorkerCount( int count );
+  /*! \brief Get the number of workers of the bulk lane. */
+  int workerCount() const;
+  /*! \brief Get the number of workers of both lanes.
+   *
+   * This is the most work that can run at the same time. Unlike the other
+   * functions, this function can be called from any thread. */
+  int threadCount() const;
+  /*! \brief Number of workers used if the count is not configured.
+   *
+   * Half of the cores of the machine, leaving the rest for Qt Creator, but
+   * at least one. */
+  static int automaticWorkerCount();
+
+private:
+  QThreadPool d_interactive;
+  QThreadPool d_bulk;
+  QAtomicInt d_threadCount;
+};
+
+} // namespace SpellChecker
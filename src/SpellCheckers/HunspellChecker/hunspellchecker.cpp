@@ -23,22 +23,171 @@
 #include "HunspellConstants.h"
 
 #include "../../spellcheckerconstants.h"
+#include "../../spellcheckercore.h"
+#include "../../SpellCheckerThreadPool.h"
+#include "../../UserDictionary.h"
 
 #include <hunspell/hunspell.hxx>
 
 #include <coreplugin/icore.h>
+#include <utils/runextensions.h>
 
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QMutex>
+#include <QSet>
 #include <QSharedPointer>
 #include <QTextCodec>
+#include <QWaitCondition>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <vector>
+
+// #define BENCH_TIME
+#ifdef BENCH_TIME
+#include <QElapsedTimer>
+
+#include <thread>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif /* Q_OS_LINUX */
+#endif /* BENCH_TIME */
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#define SPELLCHECKER_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace {
-/*! \brief Wrapper around Hunspell object */
+/*! \brief Get all UTF-16 code units of the string OR-ed together.
+ *
+ * The result is used to know if all characters fit in a range, for example
+ * if it is below 0x80 all characters are ASCII. */
+inline ushort orOfCodeUnits( const ushort* data, int size )
+{
+  ushort result = 0;
+  int index     = 0;
+#ifdef SPELLCHECKER_SSE2
+  if( size >= 8 ) {
+    __m128i accumulator = _mm_setzero_si128();
+    for( ; index + 8 <= size; index += 8 ) {
+      accumulator = _mm_or_si128( accumulator, _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + index ) ) );
+    }
+    accumulator = _mm_or_si128( accumulator, _mm_srli_si128( accumulator, 8 ) );
+    accumulator = _mm_or_si128( accumulator, _mm_srli_si128( accumulator, 4 ) );
+    accumulator = _mm_or_si128( accumulator, _mm_srli_si128( accumulator, 2 ) );
+    result      = ushort( _mm_cvtsi128_si32( accumulator ) );
+  }
+#endif /* SPELLCHECKER_SSE2 */
+  for( ; index < size; ++index ) {
+    result |= data[index];
+  }
+  return result;
+}
+// --------------------------------------------------
+
+/*! \brief Narrow UTF-16 code units that are all below 0x100 to bytes. */
+inline void narrow( const ushort* data, int size, char* out )
+{
+  int index = 0;
+#ifdef SPELLCHECKER_SSE2
+  /* The values all fit in a byte, thus the saturation of the pack does
+   * not change any of them. */
+  for( ; index + 16 <= size; index += 16 ) {
+    const __m128i low  = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + index ) );
+    const __m128i high = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + index + 8 ) );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( out + index ), _mm_packus_epi16( low, high ) );
+  }
+#endif /* SPELLCHECKER_SSE2 */
+  for( ; index < size; ++index ) {
+    out[index] = char( data[index] );
+  }
+}
+// --------------------------------------------------
+
+/*! \brief Encode UTF-16 to UTF-8 into the buffer, reusing its memory.
+ *
+ * Unpaired surrogates are replaced with '?', the same as QTextCodec does. */
+inline void encodeUtf8( const ushort* data, int size, QByteArray& buffer )
+{
+  /* A code unit never needs more than 3 bytes, a surrogate pair uses 4 bytes
+   * for two code units. */
+  buffer.resize( size * 3 );
+  uchar* out = reinterpret_cast<uchar*>( buffer.data() );
+  for( int index = 0; index < size; ++index ) {
+    const ushort unit = data[index];
+    if( unit < 0x80 ) {
+      *out++ = uchar( unit );
+    } else if( unit < 0x800 ) {
+      *out++ = uchar( 0xC0 | ( unit >> 6 ) );
+      *out++ = uchar( 0x80 | ( unit & 0x3F ) );
+    } else if( QChar::isSurrogate( unit ) == false ) {
+      *out++ = uchar( 0xE0 | ( unit >> 12 ) );
+      *out++ = uchar( 0x80 | ( ( unit >> 6 ) & 0x3F ) );
+      *out++ = uchar( 0x80 | ( unit & 0x3F ) );
+    } else if( ( QChar::isHighSurrogate( unit ) == true )
+               && ( index + 1 < size )
+               && ( QChar::isLowSurrogate( data[index + 1] ) == true ) ) {
+      const uint codePoint = QChar::surrogateToUcs4( unit, data[++index] );
+      *out++ = uchar( 0xF0 | ( codePoint >> 18 ) );
+      *out++ = uchar( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) );
+      *out++ = uchar( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+      *out++ = uchar( 0x80 | ( codePoint & 0x3F ) );
+    } else {
+      *out++ = '?';
+    }
+  }
+  buffer.resize( int( out - reinterpret_cast<uchar*>( buffer.data() ) ) );
+}
+// --------------------------------------------------
+
+#ifdef BENCH_TIME
+/*! \brief Get the resident memory of the process in bytes, -1 if it is not known.
+ *
+ * Used to estimate the memory of a Hunspell object. Other threads allocate
+ * memory at the same time, thus the difference is only an indication. */
+qint64 residentMemory()
+{
+#ifdef Q_OS_LINUX
+  QFile statm( QStringLiteral( "/proc/self/statm" ) );
+  if( statm.open( QIODevice::ReadOnly ) == true ) {
+    const QList<QByteArray> fields = statm.readAll().split( ' ' );
+    if( fields.size() > 1 ) {
+      return fields.at( 1 ).toLongLong() * sysconf( _SC_PAGESIZE );
+    }
+  }
+#endif /* Q_OS_LINUX */
+  return -1;
+}
+// --------------------------------------------------
+#endif /* BENCH_TIME */
+
+/*! \brief Maximum number of Hunspell objects in a pool.
+ *
+ * Words are checked by the workers of the spell checker thread pool, thus
+ * one object for each worker of both lanes is enough. Other threads, for
+ * example the main thread getting suggestions, wait for an object to be
+ * returned instead of loading another copy of the dictionary. */
+int maxPoolInstances()
+{
+  const SpellChecker::SpellCheckerCore* core = SpellChecker::SpellCheckerCore::instance();
+  if( core == nullptr ) {
+    return 1;
+  }
+  return qMax( 1, core->threadPool()->threadCount() );
+}
+// --------------------------------------------------
+
+/*! \brief Wrapper around Hunspell object
+ *
+ * The wrapper is not thread safe by itself. It is owned by the HunspellPool
+ * and must only be used by a thread that leased it from the pool. */
 class HunspellWrapper
 {
 public:
@@ -49,11 +198,16 @@ public:
    * .aff file is derived, which is also needed by Hunspell and must be
    * co-located with the dictionary file. */
   HunspellWrapper( const QString& dictionary )
+    : d_appliedWords( 0 )
   {
     /* Get the affix dictionary path */
     QString affPath = QString( dictionary ).replace( QRegExp( QLatin1String( "\\.dic$" ) ), QLatin1String( ".aff" ) );
     d_hunspell = HunspellPtr( new ::Hunspell( affPath.toLatin1(), dictionary.toLatin1() ) );
     d_codec    = QTextCodec::codecForName( d_hunspell->get_dic_encoding() );
+    d_encoding = encodingOfCodec( d_codec );
+#ifdef BENCH_TIME
+    benchmarkEncode();
+#endif /* BENCH_TIME */
   }
   /*! \brief Check if the supplied \a word is a spelling mistake or not.
    *
@@ -61,9 +215,7 @@ public:
    * object. */
   bool isSpellingMistake( const QString& word ) const
   {
-    QMutexLocker lock( &d_mutex );
-    HunspellPtr  hunspell = d_hunspell;
-    bool recognised       = hunspell->spell( encode( word ) );
+    bool recognised = d_hunspell->spell( encode( word ).constData() );
     return ( recognised == false );
   }
   /*! \brief Get the list of suggestions for the given word.
@@ -73,31 +225,73 @@ public:
   QStringList getSuggestionsForWord( const QString& word ) const
   {
     QStringList suggestionsList;
-    QMutexLocker lock( &d_mutex );
-    HunspellPtr  hunspell = d_hunspell;
     char** suggestions;
-    int numSuggestions = d_hunspell->suggest( &suggestions, encode( word ) );
+    int numSuggestions = d_hunspell->suggest( &suggestions, encode( word ).constData() );
     suggestionsList.reserve( numSuggestions );
     for( int i = 0; i < numSuggestions; ++i ) {
       suggestionsList << decode( suggestions[i] );
     }
-    hunspell->free_list( &suggestions, numSuggestions );
+    d_hunspell->free_list( &suggestions, numSuggestions );
     return suggestionsList;
   }
-  /*! \brief Add the given word to the Hunspell object.
+  /*! \brief Add the given words to the Hunspell object.
    *
-   * A word that is added will not be considered a spelling mistake.
+   * Words that are added will not be considered spelling mistakes.
    * Words added to the object will only be remembered for the lifetime
    * of the object. To remember a word between runs, external functionality
-   * must be used. */
-  void addWord( const QString& word )
+   * must be used.
+   *
+   * The pool keeps a single list of all words added during the session. The
+   * \a words list is that list and only the words that were not yet applied
+   * to this object are added. */
+  void addWords( const QStringList& words )
   {
-    QMutexLocker lock( &d_mutex );
-    HunspellPtr  hunspell = d_hunspell;
-    d_hunspell->add( encode( word ).constData() );
+    for( int i = d_appliedWords; i < words.size(); ++i ) {
+      d_hunspell->add( encode( words.at( i ) ).constData() );
+    }
+    d_appliedWords = words.size();
+  }
+  /*! \brief Number of words from the session list already added to this object. */
+  int appliedWords() const
+  {
+    return d_appliedWords;
   }
 
 private:
+  /*! \brief Encodings that have a fast path in encode() and decode(). */
+  enum class Encoding {
+    Utf8 /*!< UTF-8, all words are encoded without the codec. */,
+    Latin1 /*!< ISO-8859-1, words with only Latin-1 characters are narrowed. */,
+    AsciiCompatible /*!< Other encodings where ASCII maps to itself, ASCII words are narrowed. */,
+    Other /*!< All words go through the codec. */
+  };
+
+  /*! \brief Find out which fast path can be used for the codec. */
+  static Encoding encodingOfCodec( QTextCodec* codec )
+  {
+    if( codec == nullptr ) {
+      /* Without a codec the words are converted to Latin-1. */
+      return Encoding::Latin1;
+    }
+    switch( codec->mibEnum() ) {
+      case 106:
+        return Encoding::Utf8;
+      case 4:
+        return Encoding::Latin1;
+      default:
+        break;
+    }
+    /* Almost all encodings supported by Hunspell encode ASCII as is, but
+     * rather check it than assume it. */
+    QString ascii;
+    QByteArray expected;
+    for( int character = 1; character < 0x80; ++character ) {
+      ascii.append( QChar( character ) );
+      expected.append( char( character ) );
+    }
+    return ( codec->fromUnicode( ascii ) == expected ) ? Encoding::AsciiCompatible : Encoding::Other;
+  }
+
   /*! \brief Encode a word into the encoding of the selected dictionary.
    *
    * If the selected dictionary uses a different encoding than the one
@@ -105,9 +299,36 @@ private:
    * word to the encoding of the dictionary, before it is spell checked by the
    * hunspell library.
    *
+   * Most words from source code are ASCII. If the word fits in the encoding
+   * of the dictionary without conversion it is narrowed directly, without
+   * going through the codec. The result is written to a buffer that is
+   * reused by the thread, thus it is only valid until the next call from the
+   * same thread and must not be kept.
+   *
    * If the codec is not set or valid the word is converted to
    * its Latin-1 representation. */
-  QByteArray encode( const QString& word ) const
+  const QByteArray& encode( const QString& word ) const
+  {
+    static thread_local QByteArray buffer;
+    const ushort* data = word.utf16();
+    const int size     = word.size();
+    const ushort bits  = orOfCodeUnits( data, size );
+    if( ( ( bits < 0x80 ) && ( d_encoding != Encoding::Other ) )
+        || ( ( bits < 0x100 ) && ( d_encoding == Encoding::Latin1 ) ) ) {
+      buffer.resize( size );
+      narrow( data, size, buffer.data() );
+      return buffer;
+    }
+    if( d_encoding == Encoding::Utf8 ) {
+      encodeUtf8( data, size, buffer );
+      return buffer;
+    }
+    buffer = encodeWithCodec( word );
+    return buffer;
+  }
+
+  /*! \brief Encode a word using the codec, without any fast path. */
+  QByteArray encodeWithCodec( const QString& word ) const
   {
     if( d_codec != nullptr ) {
       return d_codec->fromUnicode( word );
@@ -125,36 +346,481 @@ private:
    * its Latin-1 representation. */
   QString decode( const QByteArray& word ) const
   {
+    switch( d_encoding ) {
+      case Encoding::Utf8:
+        return QString::fromUtf8( word );
+      case Encoding::Latin1:
+        return QString::fromLatin1( word );
+      default:
+        break;
+    }
     if( d_codec != nullptr ) {
       return d_codec->toUnicode( word );
     }
     return QLatin1String( word );
   }
 
+#ifdef BENCH_TIME
+  /*! \brief Compare the cost of encoding words with and without the fast path. */
+  void benchmarkEncode() const
+  {
+    const QStringList words = { QStringLiteral( "the" ), QStringLiteral( "spell" ), QStringLiteral( "checker" ),
+                                QStringLiteral( "parses" ), QStringLiteral( "comments" ), QStringLiteral( "and" ),
+                                QStringLiteral( "string" ), QStringLiteral( "literals" ), QStringLiteral( "documentation" ),
+                                QString::fromUtf8( "na\xc3\xafve" ), QString::fromUtf8( "fa\xc3\xa7" "ade" ) };
+    const int iterations = 100000;
+    qint64 bytes         = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for( int iteration = 0; iteration < iterations; ++iteration ) {
+      for( const QString& word: words ) {
+        bytes += encode( word ).size();
+      }
+    }
+    const qint64 fastPath = timer.nsecsElapsed();
+    timer.restart();
+    for( int iteration = 0; iteration < iterations; ++iteration ) {
+      for( const QString& word: words ) {
+        bytes += encodeWithCodec( word ).size();
+      }
+    }
+    const qint64 codec = timer.nsecsElapsed();
+    const double count = double( iterations ) * words.size();
+    qDebug() << "HunspellWrapper: Encode cost per word for" << d_hunspell->get_dic_encoding()
+             << "\n  - fast path (ns): " << fastPath / count
+             << "\n  - codec (ns)    : " << codec / count
+             << "\n  - bytes         : " << bytes;
+  }
+#endif /* BENCH_TIME */
+
 private:
   using HunspellPtr = QSharedPointer< ::Hunspell>;
   HunspellPtr d_hunspell;
   QTextCodec* d_codec;
-  mutable QMutex d_mutex;
+  Encoding d_encoding;
+  int d_appliedWords;
+};
+
+/*! \brief Pool of Hunspell objects for the same dictionary.
+ *
+ * A single Hunspell object is not thread safe and used to be guarded by a
+ * single mutex. All spell checking threads then queued up behind that
+ * mutex, which made the spell checking effectively single threaded.
+ *
+ * The pool creates Hunspell objects on demand, up to one for each thread
+ * that is spell checking at the same time, capped to the number of workers
+ * of the spell checker thread pool, see maxPoolInstances(). A thread leases
+ * an object for the duration of a call and returns it to the pool
+ * afterwards. If all objects are in use and the cap is reached, the thread
+ * waits until one is returned.
+ *
+ * Memory: Hunspell can not share a loaded dictionary between objects, each
+ * object parses the .aff and .dic files into its own hash tables. Every
+ * object thus costs about as much memory as the first one, which grows with
+ * the size of the dictionary and its affix rules. With the default settings
+ * the cap is half the cores plus the two interactive workers. An object is
+ * only created when all existing objects are in use, thus a pool only grows
+ * to the cap while a project is checked by all workers. With BENCH_TIME
+ * defined the growth of the resident memory is logged for every object
+ * that is created.
+ *
+ * Words added or ignored during the session are kept in a single list on the
+ * pool. Each object applies the words that it is missing when it is leased,
+ * thus an added word reaches every object, including objects that get
+ * created later, before that object is used again. Hunspell only has a
+ * function to add a single word, thus a new object adds the words of the
+ * user dictionary one at a time, which is done without holding the lock of
+ * the pool. */
+class HunspellPool
+{
+public:
+  HunspellPool( const QString& dictionary )
+    : d_dictionary( dictionary )
+    , d_createdInstances( 1 )
+  {
+    /* Create the first object immediately so that the pool is ready to be
+     * used once it is constructed. The pool is constructed on a background
+     * thread, loading the dictionary does not block the caller. */
+    d_instances.emplace_back( new HunspellWrapper( d_dictionary ) );
+    d_idle.append( d_instances.back().get() );
+    /* The identity includes the modification time and size of the dictionary
+     * so that cached results are not used if the dictionary file was updated. */
+    const QFileInfo dictionaryInfo( d_dictionary );
+    d_identity = QStringLiteral( "%1|%2|%3" ).arg( dictionaryInfo.absoluteFilePath()
+                                                   , dictionaryInfo.lastModified().toString( Qt::ISODate )
+                                                   , QString::number( dictionaryInfo.size() ) );
+  }
+
+  /*! \brief Identity of the dictionary loaded by the pool. */
+  QString identity() const
+  {
+    return d_identity;
+  }
+
+  /*! \brief Dictionary loaded by the pool. */
+  QString dictionary() const
+  {
+    return d_dictionary;
+  }
+
+  /*! \brief Lease an object from the pool.
+   *
+   * The returned object must be given back to the pool using release().
+   * Use the HunspellLease to make sure that this happens. */
+  HunspellWrapper* acquire()
+  {
+    QMutexLocker lock( &d_mutex );
+    while( d_idle.isEmpty() == true ) {
+      if( d_createdInstances < maxPoolInstances() ) {
+        /* Reserve the slot and construct the object without holding the lock,
+         * loading a dictionary takes some time and other threads might
+         * return objects in the mean time. */
+        ++d_createdInstances;
+        lock.unlock();
+#ifdef BENCH_TIME
+        QElapsedTimer timer;
+        timer.start();
+        const qint64 memory = residentMemory();
+#endif /* BENCH_TIME */
+        std::unique_ptr<HunspellWrapper> wrapper( new HunspellWrapper( d_dictionary ) );
+#ifdef BENCH_TIME
+        qDebug() << "HunspellPool: Created instance" << d_createdInstances << "of" << maxPoolInstances()
+                 << "\n  - time           : " << timer.elapsed()
+                 << "\n  - memory (bytes) : " << residentMemory() - memory;
+#endif /* BENCH_TIME */
+        lock.relock();
+        d_instances.push_back( std::move( wrapper ) );
+        HunspellWrapper* instance = d_instances.back().get();
+        syncWords( instance, lock );
+        return instance;
+      }
+      d_available.wait( &d_mutex );
+    }
+    HunspellWrapper* instance = d_idle.takeLast();
+    syncWords( instance, lock );
+    return instance;
+  }
+
+  /*! \brief Return an object previously leased using acquire(). */
+  void release( HunspellWrapper* instance )
+  {
+    QMutexLocker lock( &d_mutex );
+    d_idle.append( instance );
+    d_available.wakeOne();
+  }
+
+  /*! \brief Add the list of words to all objects in the pool.
+   *
+   * Objects that are idle or in use get the words the next time that
+   * they are leased from the pool. */
+  void addWords( const QStringList& words )
+  {
+    QMutexLocker lock( &d_mutex );
+    d_addedWords.append( words );
+  }
+
+  /*! \brief Get the words added to the pool. */
+  QStringList addedWords()
+  {
+    QMutexLocker lock( &d_mutex );
+    return d_addedWords;
+  }
+
+private:
+  /*! \brief Apply the words added since the object was last leased.
+   *
+   * The object is already leased by the caller, thus only the copy of the
+   * list must be made while holding the lock. The list is implicitly shared
+   * and adding the words is done without the lock. */
+  void syncWords( HunspellWrapper* instance, QMutexLocker& lock )
+  {
+    if( instance->appliedWords() == d_addedWords.size() ) {
+      return;
+    }
+    const QStringList words = d_addedWords;
+    lock.unlock();
+    instance->addWords( words );
+    lock.relock();
+  }
+
+  QString d_dictionary;
+  QString d_identity;
+  int d_createdInstances;
+  std::vector<std::unique_ptr<HunspellWrapper>> d_instances;
+  QList<HunspellWrapper*> d_idle;
+  QStringList d_addedWords;
+  QMutex d_mutex;
+  QWaitCondition d_available;
+};
+
+using HunspellPoolPtr = std::shared_ptr<HunspellPool>;
+
+/*! \brief RAII helper to lease a Hunspell object from the pool.
+ *
+ * The lease keeps a reference to the pool, if the pool gets replaced while
+ * the lease is held, the old pool stays alive until the lease is released. */
+class HunspellLease
+{
+public:
+  HunspellLease( HunspellPoolPtr pool )
+    : d_pool( std::move( pool ) )
+    , d_instance( d_pool->acquire() )
+  {}
+  ~HunspellLease()
+  {
+    d_pool->release( d_instance );
+  }
+  HunspellWrapper* operator->() const
+  {
+    return d_instance;
+  }
+
+private:
+  Q_DISABLE_COPY( HunspellLease )
+  HunspellPoolPtr d_pool;
+  HunspellWrapper* d_instance;
 };
 
+#ifdef BENCH_TIME
+/*! \brief Measure the throughput of the pool for an increasing number of threads.
+ *
+ * Every thread checks the same words, leasing an object for each word the
+ * same as HunspellChecker::isSpellingMistake() does. Each thread count
+ * is run twice, the first run creates the objects that are missing and the
+ * second run is timed. With an object per thread the throughput should grow
+ * with the number of threads up to the number of cores, where a single
+ * object behind a mutex stays flat.
+ * \param[in] pool Pool to measure, it keeps the objects that get created.
+ * \param[in] dictionaryWords Words of the dictionary used to make the words
+ *              that are checked. */
+void benchmarkPool( const HunspellPoolPtr& pool, const QStringList& dictionaryWords )
+{
+  /* Besides the words themselves, check forms with a suffix and with a typo
+   * so that the affix handling and misses are part of the measurement. */
+  QStringList words;
+  const int stride = qMax( 1, dictionaryWords.size() / 1000 );
+  for( int index = 0; index < dictionaryWords.size(); index += stride ) {
+    const QString& word = dictionaryWords.at( index );
+    words << word << word + QLatin1String( "s" ) << word + QLatin1String( "xq" );
+  }
+  if( words.isEmpty() == true ) {
+    return;
+  }
+  const int maxThreads = maxPoolInstances();
+  int threads          = 1;
+  while( true ) {
+    qint64 nsecs = 0;
+    for( int run = 0; run < 2; ++run ) {
+      QElapsedTimer timer;
+      timer.start();
+      std::vector<std::thread> workers;
+      for( int thread = 0; thread < threads; ++thread ) {
+        workers.emplace_back( [&pool, &words]() {
+          for( const QString& word: qAsConst( words ) ) {
+            HunspellLease hunspell( pool );
+            hunspell->isSpellingMistake( word );
+          }
+        } );
+      }
+      for( std::thread& worker: workers ) {
+        worker.join();
+      }
+      nsecs = timer.nsecsElapsed();
+    }
+    const double wordsPerSecond = ( double( words.size() ) * threads * 1e9 ) / double( qMax<qint64>( nsecs, 1 ) );
+    qDebug() << "HunspellPool: Throughput"
+             << "\n  - threads      : " << threads
+             << "\n  - words        : " << words.size() * threads
+             << "\n  - words/second : " << qint64( wordsPerSecond );
+    if( threads == maxThreads ) {
+      break;
+    }
+    threads = qMin( threads * 2, maxThreads );
+  }
+}
+// --------------------------------------------------
+#endif /* BENCH_TIME */
+
+/*! \brief Split the flags of a dictionary entry according to the FLAG type. */
+QStringList splitFlags( const QString& flags, const QString& flagType )
+{
+  QStringList result;
+  if( flagType == QLatin1String( "num" ) ) {
+    result = flags.split( QLatin1Char( ',' ), Qt::SkipEmptyParts );
+  } else if( flagType == QLatin1String( "long" ) ) {
+    for( int index = 0; index < flags.size(); index += 2 ) {
+      result.append( flags.mid( index, 2 ) );
+    }
+  } else {
+    for( const QChar& flag: flags ) {
+      result.append( flag );
+    }
+  }
+  return result;
+}
+// --------------------------------------------------
+
+/*! \brief Read the words of the dictionary that are correct as they are.
+ *
+ * These are the stems in the .dic file. Stems that have a flag that changes
+ * if the stem by itself is accepted, for example NEEDAFFIX or FORBIDDENWORD,
+ * are left out. Affixes are not expanded, thus the words with affixes still
+ * need to be checked by Hunspell. */
+QStringList readKnownWords( const QString& dictionary )
+{
+  const QString affPath = QString( dictionary ).replace( QRegExp( QLatin1String( "\\.dic$" ) ), QLatin1String( ".aff" ) );
+  QFile affFile( affPath );
+  if( affFile.open( QIODevice::ReadOnly ) == false ) {
+    return QStringList();
+  }
+  /* The keywords of the .aff file are ASCII. Only the values of the flag
+   * keywords are used, which must be decoded the same as the .dic file. */
+  QByteArray encoding = "ISO8859-1";
+  QString flagType;
+  QList<QByteArray> specialFlagValues;
+  const QList<QByteArray> specialFlagKeywords = { "NEEDAFFIX", "PSEUDOROOT", "FORBIDDENWORD", "ONLYINCOMPOUND", "CIRCUMFIX" };
+  while( affFile.atEnd() == false ) {
+    const QList<QByteArray> fields = affFile.readLine().simplified().split( ' ' );
+    if( fields.size() < 2 ) {
+      continue;
+    }
+    if( fields.at( 0 ) == "SET" ) {
+      encoding = fields.at( 1 );
+    } else if( fields.at( 0 ) == "FLAG" ) {
+      flagType = QString::fromLatin1( fields.at( 1 ) );
+    } else if( specialFlagKeywords.contains( fields.at( 0 ) ) == true ) {
+      specialFlagValues.append( fields.at( 1 ) );
+    }
+  }
+  affFile.close();
+  QTextCodec* codec = QTextCodec::codecForName( encoding );
+  if( codec == nullptr ) {
+    return QStringList();
+  }
+  QSet<QString> specialFlags;
+  for( const QByteArray& value: qAsConst( specialFlagValues ) ) {
+    specialFlags.insert( codec->toUnicode( value ) );
+  }
+
+  QFile dicFile( dictionary );
+  if( dicFile.open( QIODevice::ReadOnly ) == false ) {
+    return QStringList();
+  }
+  const QStringList lines = codec->toUnicode( dicFile.readAll() ).split( QLatin1Char( '\n' ), Qt::SkipEmptyParts );
+  dicFile.close();
+  QStringList words;
+  QSet<QString> excluded;
+  words.reserve( lines.size() );
+  /* The first line is the number of entries. */
+  for( int lineIdx = 1; lineIdx < lines.size(); ++lineIdx ) {
+    QString entry = lines.at( lineIdx );
+    /* Remove the morphological fields. */
+    const int fieldsStart = entry.indexOf( QRegExp( QStringLiteral( "[\\t\\r ]" ) ) );
+    if( fieldsStart != -1 ) {
+      entry.truncate( fieldsStart );
+    }
+    /* A slash that is part of the word is escaped with a backslash. */
+    int flagsStart = entry.indexOf( QLatin1Char( '/' ) );
+    while( ( flagsStart > 0 )
+           && ( entry.at( flagsStart - 1 ) == QLatin1Char( '\\' ) ) ) {
+      flagsStart = entry.indexOf( QLatin1Char( '/' ), flagsStart + 1 );
+    }
+    QString word = ( flagsStart == -1 ) ? entry : entry.left( flagsStart );
+    word.replace( QStringLiteral( "\\/" ), QStringLiteral( "/" ) );
+    if( word.isEmpty() == true ) {
+      continue;
+    }
+    if( flagsStart != -1 ) {
+      const QStringList flags = splitFlags( entry.mid( flagsStart + 1 ), flagType );
+      const bool special      = std::any_of( flags.cbegin(), flags.cend(), [&specialFlags]( const QString& flag ) {
+        return specialFlags.contains( flag );
+      } );
+      if( special == true ) {
+        /* Other entries of the same stem might not have the flag, the
+         * stem must still not be accepted by the filter. */
+        excluded.insert( word );
+        continue;
+      }
+    }
+    words.append( word );
+  }
+  if( excluded.isEmpty() == false ) {
+    words.erase( std::remove_if( words.begin(), words.end(), [&excluded]( const QString& word ) {
+      return excluded.contains( word );
+    } ), words.end() );
+  }
+  return words;
+}
+// --------------------------------------------------
+
+/*! \brief Create a pool for the dictionary with the added words.
+ *
+ * This function is run on a background thread. It only uses its arguments
+ * and does not touch the checker.
+ * \param[in] dictionary Dictionary to load.
+ * \param[in] userWords Words from the user dictionary.
+ * \param[in] sessionWords Words ignored during the current session.
+ * \return The new pool, ready to be used. */
+HunspellPoolPtr createPool( const QString& dictionary, const QStringList& userWords, const QStringList& sessionWords )
+{
+#ifdef BENCH_TIME
+  QElapsedTimer timer;
+  timer.start();
+#endif /* BENCH_TIME */
+  HunspellPoolPtr pool = std::make_shared<HunspellPool>( dictionary );
+  pool->addWords( userWords );
+  pool->addWords( sessionWords );
+#ifdef BENCH_TIME
+  qDebug() << "createPool: Loaded" << dictionary
+           << "\n  - time : " << timer.elapsed();
+  benchmarkPool( pool, readKnownWords( dictionary ) );
+#endif /* BENCH_TIME */
+  return pool;
+}
+// --------------------------------------------------
+
 } // namespace
 
 
 class SpellChecker::Checker::Hunspell::HunspellCheckerPrivate
 {
-  using HunspellWrapperPtr = std::unique_ptr<HunspellWrapper>;
 public:
   QString dictionary;
   QString userDictionary;
-  QMutex  fileMutex;
-  HunspellWrapperPtr hunspell;
+  SpellChecker::UserDictionary userWords;
+  /*! \brief Pool for the current dictionary.
+   *
+   * The pointer is only read and written using the atomic functions for
+   * shared pointers. It is null until the first dictionary is loaded. */
+  HunspellPoolPtr hunspell;
+  /*! \brief Words ignored during this session.
+   *
+   * These are applied to every new pool, since ignored words are not
+   * stored in the user dictionary. Only used on the main thread. */
+  QStringList sessionWords;
+  /*! \brief Incremented for every load, results of older loads are dropped. */
+  quint64 loadGeneration;
 
   HunspellCheckerPrivate()
     : dictionary()
     , userDictionary()
+    , loadGeneration( 0 )
   {}
   ~HunspellCheckerPrivate() {}
+
+  HunspellPoolPtr pool() const
+  {
+    return std::atomic_load( &hunspell );
+  }
+
+  /*! \brief Add the words to the current pool, if there is one. */
+  void addToPool( const QStringList& words ) const
+  {
+    HunspellPoolPtr currentPool = pool();
+    if( currentPool != nullptr ) {
+      currentPool->addWords( words );
+    }
+  }
 };
 // --------------------------------------------------
 // --------------------------------------------------
@@ -167,8 +833,16 @@ HunspellChecker::HunspellChecker()
   , d( new HunspellCheckerPrivate() )
 {
   loadSettings();
-  d->hunspell = std::make_unique<HunspellWrapper>( d->dictionary );
-  loadUserAddedWords();
+  d->userWords.open( d->userDictionary );
+  /* Words appended to the user dictionary by another process are added to
+   * the current pool, if the file was rewritten the dictionary is loaded
+   * again since words might have been removed. */
+  connect( &d->userWords, &SpellChecker::UserDictionary::wordsAdded, this, [this]( const QStringList& words ) {
+    d->addToPool( words );
+    emit dictionaryUpdated();
+  } );
+  connect( &d->userWords, &SpellChecker::UserDictionary::reset, this, &HunspellChecker::loadDictionary );
+  loadDictionary();
 }
 // --------------------------------------------------
 
@@ -201,27 +875,36 @@ void HunspellChecker::loadSettings()
 }
 // --------------------------------------------------
 
-void HunspellChecker::loadUserAddedWords()
+void HunspellChecker::loadDictionary()
 {
-  /* Save the word to the user dictionary */
-  if( d->userDictionary.isEmpty() == true ) {
-    qDebug() << "loadUserAddedWords: User dictionary name empty";
-    return;
-  }
-
-  QFile dictionary( d->userDictionary );
-  if( dictionary.open( QIODevice::ReadOnly ) == false ) {
-    qDebug() << "loadUserAddedWords: Could not open user dictionary file: " << d->userDictionary;
-    return;
-  }
-
-  QTextStream stream( &dictionary );
-  QString word;
-  while( stream.atEnd() != true ) {
-    word = stream.readLine();
-    ignoreWord( word );
-  }
-  dictionary.close();
+  /* Loading a dictionary can take a while, the pool is created on a
+   * background thread and swapped in when it is ready. Lookups that are busy
+   * with the old pool keep using it until they are done. */
+  const quint64 generation    = ++d->loadGeneration;
+  const QStringList userWords = d->userWords.words();
+  const int sessionWordCount  = d->sessionWords.size();
+  QFutureWatcher<HunspellPoolPtr>* watcher = new QFutureWatcher<HunspellPoolPtr>( this );
+  connect( watcher, &QFutureWatcher<HunspellPoolPtr>::finished, this, [this, watcher, generation, userWordCount = userWords.size(), sessionWordCount]() {
+    watcher->deleteLater();
+    if( ( watcher->isCanceled() == true )
+        || ( generation != d->loadGeneration ) ) {
+      /* A newer load was started in the mean time. */
+      return;
+    }
+    HunspellPoolPtr pool = watcher->result();
+    /* Words added or ignored while the pool was loading. A reset of the user
+     * dictionary starts a new load, thus the words are only appended to. */
+    pool->addWords( d->userWords.words().mid( userWordCount ) );
+    pool->addWords( d->sessionWords.mid( sessionWordCount ) );
+    const bool wasReady = isReady();
+    std::atomic_store( &d->hunspell, pool );
+    if( wasReady == true ) {
+      emit dictionaryUpdated();
+    } else {
+      emit ready();
+    }
+  } );
+  watcher->setFuture( Utils::runAsync( createPool, d->dictionary, userWords, d->sessionWords ) );
 }
 // --------------------------------------------------
 
@@ -242,38 +925,55 @@ void HunspellChecker::saveSettings() const
 
 bool HunspellChecker::isSpellingMistake( const QString& word ) const
 {
-  return d->hunspell->isSpellingMistake( word );
+  HunspellPoolPtr pool = d->pool();
+  if( pool == nullptr ) {
+    /* The dictionary is still loading, the words get checked again when
+     * it is ready. */
+    return false;
+  }
+  HunspellLease hunspell( std::move( pool ) );
+  return hunspell->isSpellingMistake( word );
+}
+// --------------------------------------------------
+
+QBitArray HunspellChecker::areSpellingMistakes( const QStringList& words ) const
+{
+  QBitArray mistakes( words.size() );
+  HunspellPoolPtr pool = d->pool();
+  if( pool == nullptr ) {
+    return mistakes;
+  }
+  /* Lease the Hunspell object once for the whole batch. */
+  HunspellLease hunspell( std::move( pool ) );
+  for( int index = 0; index < words.size(); ++index ) {
+    if( hunspell->isSpellingMistake( words.at( index ) ) == true ) {
+      mistakes.setBit( index );
+    }
+  }
+  return mistakes;
 }
 // --------------------------------------------------
 
 void HunspellChecker::getSuggestionsForWord( const QString& word, QStringList& suggestionsList ) const
 {
-  suggestionsList = d->hunspell->getSuggestionsForWord( word );
+  HunspellPoolPtr pool = d->pool();
+  if( pool == nullptr ) {
+    suggestionsList.clear();
+    return;
+  }
+  HunspellLease hunspell( std::move( pool ) );
+  suggestionsList = hunspell->getSuggestionsForWord( word );
 }
 // --------------------------------------------------
 
 bool HunspellChecker::addWord( const QString& word )
 {
-  // HunspellPtr  hunspell = d->hunspell;*/
   /* Save the word to the user dictionary */
-  if( d->userDictionary.isEmpty() == true ) {
-    qDebug() << "User dictionary name empty";
-    return false;
-  }
-
-  QMutexLocker lock( &d->fileMutex );
-  QFileInfo( d->userDictionary ).dir().mkpath( "." );
-  QFile dictionary( d->userDictionary );
-  if( dictionary.open( QIODevice::Append ) == false ) {
-    qDebug() << "Could not open user dictionary file: " << d->userDictionary;
+  if( d->userWords.addWord( word ) == false ) {
     return false;
   }
   /* Only add the word to the spellchecker if the previous checks passed. */
-  d->hunspell->addWord( word );
-
-  QTextStream stream( &dictionary );
-  stream << word << endl;
-  dictionary.close();
+  d->addToPool( { word } );
   return true;
 }
 // --------------------------------------------------
@@ -282,11 +982,43 @@ bool HunspellChecker::ignoreWord( const QString& word )
 {
   /* The word is only added for this run of the IDE.
    * For this reason it is not added to the file. */
-  d->hunspell->addWord( word );
+  addSessionWord( word );
   return true;
 }
 // --------------------------------------------------
 
+void HunspellChecker::addSessionWord( const QString& word )
+{
+  d->sessionWords.append( word );
+  d->addToPool( { word } );
+}
+// --------------------------------------------------
+
+QString HunspellChecker::dictionaryIdentity() const
+{
+  HunspellPoolPtr pool = d->pool();
+  return ( pool != nullptr ) ? pool->identity() : QString();
+}
+// --------------------------------------------------
+
+bool HunspellChecker::isReady() const
+{
+  return ( d->pool() != nullptr );
+}
+// --------------------------------------------------
+
+QStringList HunspellChecker::knownWords() const
+{
+  /* The stems of the dictionary and the words added to the pool, words with
+   * affixes are left to Hunspell. */
+  HunspellPoolPtr pool = d->pool();
+  if( pool == nullptr ) {
+    return QStringList();
+  }
+  return readKnownWords( pool->dictionary() ) + pool->addedWords();
+}
+// --------------------------------------------------
+
 QWidget* HunspellChecker::optionsWidget()
 {
   HunspellOptionsWidget* widget = new HunspellOptionsWidget( d->dictionary, d->userDictionary );
@@ -303,6 +1035,7 @@ void HunspellChecker::updateDictionary( const QString& dictionary )
   if( d->dictionary != dictionary ) {
     d->dictionary = dictionary;
     emit dictionaryChanged( d->dictionary );
+    loadDictionary();
   }
 }
 // --------------------------------------------------
@@ -312,6 +1045,8 @@ void HunspellChecker::updateUserDictionary( const QString& userDictionary )
   if( d->userDictionary != userDictionary ) {
     d->userDictionary = userDictionary;
     emit userDictionaryChanged( d->userDictionary );
+    d->userWords.open( d->userDictionary );
+    loadDictionary();
   }
 }
 // --------------------------------------------------
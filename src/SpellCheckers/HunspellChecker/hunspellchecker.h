@@ -39,10 +39,14 @@ public:
 
   QString name() const Q_DECL_OVERRIDE;
   bool isSpellingMistake( const QString& word ) const Q_DECL_OVERRIDE;
+  QBitArray areSpellingMistakes( const QStringList& words ) const Q_DECL_OVERRIDE;
   void getSuggestionsForWord( const QString& word, QStringList& suggestionsList ) const Q_DECL_OVERRIDE;
   bool addWord( const QString& word ) Q_DECL_OVERRIDE;
   bool ignoreWord( const QString& word ) Q_DECL_OVERRIDE;
   QWidget* optionsWidget() Q_DECL_OVERRIDE;
+  QString dictionaryIdentity() const Q_DECL_OVERRIDE;
+  bool isReady() const Q_DECL_OVERRIDE;
+  QStringList knownWords() const Q_DECL_OVERRIDE;
 
 signals:
   void dictionaryChanged( const QString& dictionary );
@@ -55,7 +59,15 @@ public slots:
 private:
   void loadSettings();
   void saveSettings() const;
-  void loadUserAddedWords();
+  /*! \brief Load the dictionary and the user dictionary in the background.
+   *
+   * The current dictionary stays in use until the new one is loaded, after
+   * which it is swapped in and dictionaryUpdated() gets emitted. The first
+   * dictionary that is loaded emits ready() instead. */
+  void loadDictionary();
+  /*! \brief Ignore a word in the current dictionary and remember it for the
+   * dictionaries loaded later on during this session. */
+  void addSessionWord( const QString& word );
   HunspellCheckerPrivate* const d;
 };
 
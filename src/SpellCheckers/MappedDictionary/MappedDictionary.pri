@@ -0,0 +1,12 @@
+SOURCES += \
+        $$PWD/mappeddictionarychecker.cpp \
+        $$PWD/mappeddictionaryoptionswidget.cpp
+
+HEADERS +=  \
+        $$PWD/mappeddictionarychecker.h \
+        $$PWD/MappedDictionaryConstants.h \
+        $$PWD/MappedDictionaryFormat.h \
+        $$PWD/mappeddictionaryoptionswidget.h
+
+FORMS += \
+        $$PWD/mappeddictionaryoptionswidget.ui
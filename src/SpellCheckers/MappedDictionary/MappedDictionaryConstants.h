@@ -0,0 +1,35 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+namespace SpellChecker {
+namespace SpellCheckers {
+namespace MappedDictionaryChecker {
+namespace Constants {
+
+const char SETTINGS_GROUP[]          = "MappedDictionary";
+const char SETTING_DICTIONARY[]      = "Dictionary";
+const char SETTING_USER_DICTIONARY[] = "UserDictionary";
+
+} // namespace Constants
+} // namespace MappedDictionaryChecker
+} // namespace SpellCheckers
+} // namespace SpellChecker
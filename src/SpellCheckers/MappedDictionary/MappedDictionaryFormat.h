@@ -0,0 +1,279 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtEndian>
+
+#include <cstring>
+
+/*! \file
+ * \brief Binary format of a compiled dictionary image.
+ *
+ * The image contains all accepted word forms of a dictionary, with the
+ * affixes already expanded, sorted by their UTF-8 bytes. It is written by
+ * the dictcompiler tool and memory mapped read-only by the
+ * MappedDictionaryChecker, thus all threads and processes that use the same
+ * image share its pages.
+ *
+ * The image consists of the following parts:
+ *  - Header: Fixed size header, all values stored little endian.
+ *  - Alphabet: UTF-8 string with every character used in the words, used
+ *      to generate suggestions.
+ *  - Index: One quint32 per block with the offset of the block in the data.
+ *  - Data: The words, in blocks of WORDS_PER_BLOCK words. The first word of a
+ *      block is stored in full as a varint length followed by its bytes. The
+ *      other words are front coded relative to the previous word as a varint
+ *      length of the shared prefix, a varint length of the suffix and then the
+ *      bytes of the suffix.
+ *
+ * Since the first word of each block is stored in full, a lookup does a
+ * binary search over the blocks and then decodes at most one block. */
+
+namespace SpellChecker {
+namespace Checker {
+namespace MappedDictionary {
+namespace Format {
+
+const char    MAGIC[8]        = { 'Q', 't', 'C', 'S', 'P', 'D', 'I', 'C' };
+const quint32 VERSION         = 1;
+const int     WORDS_PER_BLOCK = 32;
+/*! Words longer than this are not stored in the image. */
+const int MAX_WORD_BYTES = 255;
+
+struct Header {
+  char    magic[8];
+  quint32 version;
+  quint32 wordCount;
+  quint32 blockCount;
+  quint32 alphabetSize;
+  quint64 alphabetOffset;
+  quint64 indexOffset;
+  quint64 dataOffset;
+  quint64 dataSize;
+};
+static_assert( sizeof( Header ) == 56, "The header must not contain padding" );
+
+/*! \brief Append \a value as a variable length integer to \a buffer. */
+inline void appendVarint( QByteArray& buffer, quint32 value )
+{
+  while( value >= 0x80 ) {
+    buffer.append( static_cast<char>( ( value & 0x7F ) | 0x80 ) );
+    value >>= 7;
+  }
+  buffer.append( static_cast<char>( value ) );
+}
+// --------------------------------------------------
+
+/*! \brief Read a variable length integer.
+ * \return Pointer past the integer, or nullptr if the integer does not end
+ *          before \a end. */
+inline const uchar* readVarint( const uchar* data, const uchar* end, quint32& value )
+{
+  value = 0;
+  for( int shift = 0; ( data < end ) && ( shift < 32 ); shift += 7 ) {
+    const uchar byte = *data++;
+    value |= quint32( byte & 0x7F ) << shift;
+    if( ( byte & 0x80 ) == 0 ) {
+      return data;
+    }
+  }
+  return nullptr;
+}
+// --------------------------------------------------
+
+/*! \brief Compare two byte strings the same way that QByteArray does. */
+inline int compare( const uchar* left, int leftSize, const uchar* right, int rightSize )
+{
+  const int result = std::memcmp( left, right, size_t( qMin( leftSize, rightSize ) ) );
+  if( result != 0 ) {
+    return result;
+  }
+  return leftSize - rightSize;
+}
+// --------------------------------------------------
+
+/*! \brief Read-only view on a dictionary image.
+ *
+ * The reader does not own the memory of the image. It does not modify any
+ * state when looking up words, thus it is safe to use from multiple threads. */
+class ImageReader
+{
+public:
+  ImageReader()
+  {
+    std::memset( &d_header, 0, sizeof( d_header ) );
+  }
+
+  /*! \brief Set up the reader for the image.
+   *
+   * The image is validated before it is used.
+   * \return True if the image is valid. */
+  bool open( const uchar* image, qint64 size )
+  {
+    d_image = nullptr;
+    if( ( image == nullptr )
+        || ( size < qint64( sizeof( Header ) ) ) ) {
+      return false;
+    }
+    Header header;
+    std::memcpy( &header, image, sizeof( header ) );
+    header.version        = qFromLittleEndian( header.version );
+    header.wordCount      = qFromLittleEndian( header.wordCount );
+    header.blockCount     = qFromLittleEndian( header.blockCount );
+    header.alphabetSize   = qFromLittleEndian( header.alphabetSize );
+    header.alphabetOffset = qFromLittleEndian( header.alphabetOffset );
+    header.indexOffset    = qFromLittleEndian( header.indexOffset );
+    header.dataOffset     = qFromLittleEndian( header.dataOffset );
+    header.dataSize       = qFromLittleEndian( header.dataSize );
+    const quint64 imageSize = quint64( size );
+    if( ( std::memcmp( header.magic, MAGIC, sizeof( MAGIC ) ) != 0 )
+        || ( header.version != VERSION )
+        || ( header.alphabetOffset + header.alphabetSize > imageSize )
+        || ( header.indexOffset + quint64( header.blockCount ) * sizeof( quint32 ) > imageSize )
+        || ( header.dataOffset + header.dataSize > imageSize )
+        || ( quint64( header.blockCount ) * WORDS_PER_BLOCK < header.wordCount ) ) {
+      return false;
+    }
+    d_header = header;
+    d_image  = image;
+    return true;
+  }
+
+  bool isValid() const
+  {
+    return d_image != nullptr;
+  }
+
+  quint32 wordCount() const
+  {
+    return d_header.wordCount;
+  }
+
+  /*! \brief Characters used in the words of the image. */
+  QString alphabet() const
+  {
+    if( isValid() == false ) {
+      return QString();
+    }
+    return QString::fromUtf8( reinterpret_cast<const char*>( d_image + d_header.alphabetOffset ), int( d_header.alphabetSize ) );
+  }
+
+  /*! \brief Check if the image contains the UTF-8 encoded word. */
+  bool contains( const QByteArray& word ) const
+  {
+    if( ( isValid() == false )
+        || ( d_header.blockCount == 0 )
+        || ( word.size() > MAX_WORD_BYTES ) ) {
+      return false;
+    }
+    const uchar* key     = reinterpret_cast<const uchar*>( word.constData() );
+    const int keySize    = word.size();
+    const uchar* data    = d_image + d_header.dataOffset;
+    const uchar* dataEnd = data + d_header.dataSize;
+
+    /* Find the last block with a first word that is not larger than the key. */
+    quint32 low  = 0;
+    quint32 high = d_header.blockCount;
+    while( high - low > 1 ) {
+      const quint32 middle = low + ( high - low ) / 2;
+      const uchar* wordData;
+      quint32 wordSize;
+      if( firstWordOfBlock( middle, wordData, wordSize ) == false ) {
+        return false;
+      }
+      if( compare( wordData, int( wordSize ), key, keySize ) <= 0 ) {
+        low = middle;
+      } else {
+        high = middle;
+      }
+    }
+
+    /* Decode the block until the key is found or passed. */
+    const quint32 blockOffset = blockOffsetAt( low );
+    if( blockOffset >= d_header.dataSize ) {
+      return false;
+    }
+    const uchar* current       = data + blockOffset;
+    const quint32 firstIndex   = low * WORDS_PER_BLOCK;
+    const quint32 wordsInBlock = qMin<quint32>( WORDS_PER_BLOCK, d_header.wordCount - firstIndex );
+    uchar buffer[MAX_WORD_BYTES];
+    quint32 bufferSize = 0;
+    for( quint32 index = 0; index < wordsInBlock; ++index ) {
+      quint32 prefix = 0;
+      quint32 suffix = 0;
+      if( index != 0 ) {
+        current = readVarint( current, dataEnd, prefix );
+        if( current == nullptr ) {
+          return false;
+        }
+      }
+      current = readVarint( current, dataEnd, suffix );
+      if( ( current == nullptr )
+          || ( prefix > bufferSize )
+          || ( prefix + suffix > quint32( MAX_WORD_BYTES ) )
+          || ( suffix > quint32( dataEnd - current ) ) ) {
+        return false;
+      }
+      std::memcpy( buffer + prefix, current, suffix );
+      current   += suffix;
+      bufferSize = prefix + suffix;
+      const int result = compare( buffer, int( bufferSize ), key, keySize );
+      if( result == 0 ) {
+        return true;
+      }
+      if( result > 0 ) {
+        /* The words are sorted, the key can not be later in the block. */
+        return false;
+      }
+    }
+    return false;
+  }
+
+private:
+  quint32 blockOffsetAt( quint32 block ) const
+  {
+    quint32 offset;
+    std::memcpy( &offset, d_image + d_header.indexOffset + block * sizeof( quint32 ), sizeof( offset ) );
+    return qFromLittleEndian( offset );
+  }
+
+  bool firstWordOfBlock( quint32 block, const uchar*& wordData, quint32& wordSize ) const
+  {
+    const quint32 offset = blockOffsetAt( block );
+    if( offset >= d_header.dataSize ) {
+      return false;
+    }
+    const uchar* data    = d_image + d_header.dataOffset;
+    const uchar* dataEnd = data + d_header.dataSize;
+    wordData = readVarint( data + offset, dataEnd, wordSize );
+    return ( wordData != nullptr ) && ( wordSize <= quint32( dataEnd - wordData ) );
+  }
+
+  const uchar* d_image = nullptr;
+  Header d_header;
+};
+
+} // namespace Format
+} // namespace MappedDictionary
+} // namespace Checker
+} // namespace SpellChecker
@@ -0,0 +1,416 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "mappeddictionarychecker.h"
+#include "mappeddictionaryoptionswidget.h"
+#include "MappedDictionaryConstants.h"
+#include "MappedDictionaryFormat.h"
+
+#include "../../spellcheckerconstants.h"
+#include "../../UserDictionary.h"
+
+#include <coreplugin/icore.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QReadWriteLock>
+#include <QSet>
+
+// #define BENCH_TIME
+#ifdef BENCH_TIME
+#include <QElapsedTimer>
+#endif /* BENCH_TIME */
+
+namespace {
+/*! Maximum number of suggestions returned for a word. */
+const int MAX_SUGGESTIONS = 15;
+} // namespace
+
+class SpellChecker::Checker::MappedDictionary::MappedDictionaryCheckerPrivate
+{
+public:
+  QString dictionary;
+  QString userDictionary;
+  QString dictionaryIdentity;
+  SpellChecker::UserDictionary userWords;
+  /*! \brief Words ignored during this session, only used on the main thread. */
+  QStringList ignoredWords;
+  /*! \brief Lock for the mapping and the added words.
+   *
+   * Lookups only take the lock for reading, it is only locked for writing
+   * when the image gets mapped again or words are added. */
+  mutable QReadWriteLock lock;
+  QFile imageFile;
+  uchar* image;
+  SpellChecker::Checker::MappedDictionary::Format::ImageReader reader;
+  QString alphabet;
+  /*! \brief Words from the user dictionary and words ignored, for lookups. */
+  QSet<QString> addedWords;
+
+  MappedDictionaryCheckerPrivate()
+    : dictionary()
+    , userDictionary()
+    , image( nullptr )
+  {}
+  ~MappedDictionaryCheckerPrivate() {}
+
+  /*! \brief Check if the word is in the image or added words, as is.
+   *
+   * The caller must hold the lock for reading. */
+  bool isKnown( const QString& word ) const
+  {
+    return ( addedWords.contains( word ) == true )
+           || ( reader.contains( word.toUtf8() ) == true );
+  }
+
+  /*! \brief Check if the word is correct.
+   *
+   * The same as Hunspell, capitalized words and words in all caps are also
+   * accepted if the dictionary contains the lower case word. All caps words
+   * are accepted if the dictionary contains the capitalized word, for
+   * example names.
+   * The caller must hold the lock for reading. */
+  bool isCorrect( const QString& word ) const
+  {
+    if( isKnown( word ) == true ) {
+      return true;
+    }
+    const QString lower = word.toLower();
+    if( lower == word ) {
+      return false;
+    }
+    const bool allCaps     = ( word == word.toUpper() );
+    const bool capitalized = ( word.at( 0 ).isUpper() == true )
+                             && ( word.midRef( 1 ) == lower.midRef( 1 ) );
+    if( ( allCaps == false )
+        && ( capitalized == false ) ) {
+      return false;
+    }
+    if( isKnown( lower ) == true ) {
+      return true;
+    }
+    if( allCaps == true ) {
+      QString capitalizedWord = lower;
+      capitalizedWord[0] = capitalizedWord.at( 0 ).toUpper();
+      return isKnown( capitalizedWord );
+    }
+    return false;
+  }
+
+  void unmap()
+  {
+    if( image != nullptr ) {
+      imageFile.unmap( image );
+      image = nullptr;
+    }
+    imageFile.close();
+    reader = SpellChecker::Checker::MappedDictionary::Format::ImageReader();
+    alphabet.clear();
+  }
+};
+// --------------------------------------------------
+// --------------------------------------------------
+// --------------------------------------------------
+
+using namespace SpellChecker::Checker::MappedDictionary;
+
+MappedDictionaryChecker::MappedDictionaryChecker()
+  : ISpellChecker()
+  , d( new MappedDictionaryCheckerPrivate() )
+{
+  loadSettings();
+  d->userWords.open( d->userDictionary );
+  connect( &d->userWords, &SpellChecker::UserDictionary::wordsAdded, this, [this]( const QStringList& words ) {
+    {
+      QWriteLocker lock( &d->lock );
+      for( const QString& word: words ) {
+        d->addedWords.insert( word );
+      }
+    }
+    emit dictionaryUpdated();
+  } );
+  connect( &d->userWords, &SpellChecker::UserDictionary::reset, this, [this]() {
+    loadDictionary();
+    emit dictionaryUpdated();
+  } );
+  loadDictionary();
+}
+// --------------------------------------------------
+
+MappedDictionaryChecker::~MappedDictionaryChecker()
+{
+  saveSettings();
+  d->unmap();
+  delete d;
+}
+// --------------------------------------------------
+
+QString MappedDictionaryChecker::name() const
+{
+  return tr( "Mapped Dictionary" );
+}
+// --------------------------------------------------
+
+void MappedDictionaryChecker::loadSettings()
+{
+  QSettings* settings = Core::ICore::settings();
+  settings->beginGroup( QLatin1String( Constants::CORE_SETTINGS_GROUP ) );
+  settings->beginGroup( QLatin1String( Constants::CORE_SPELLCHECKERS_GROUP ) );
+  settings->beginGroup( QLatin1String( SpellCheckers::MappedDictionaryChecker::Constants::SETTINGS_GROUP ) );
+  d->dictionary     = settings->value( QLatin1String( SpellCheckers::MappedDictionaryChecker::Constants::SETTING_DICTIONARY ), QLatin1String( "" ) ).toString();
+  d->userDictionary = settings->value( QLatin1String( SpellCheckers::MappedDictionaryChecker::Constants::SETTING_USER_DICTIONARY ), QLatin1String( "" ) ).toString();
+  settings->endGroup();
+  settings->endGroup();
+  settings->endGroup();
+}
+// --------------------------------------------------
+
+void MappedDictionaryChecker::saveSettings() const
+{
+  QSettings* settings = Core::ICore::settings();
+  settings->beginGroup( QLatin1String( Constants::CORE_SETTINGS_GROUP ) );
+  settings->beginGroup( QLatin1String( Constants::CORE_SPELLCHECKERS_GROUP ) );
+  settings->beginGroup( QLatin1String( SpellCheckers::MappedDictionaryChecker::Constants::SETTINGS_GROUP ) );
+  settings->setValue( QLatin1String( SpellCheckers::MappedDictionaryChecker::Constants::SETTING_DICTIONARY ),      d->dictionary );
+  settings->setValue( QLatin1String( SpellCheckers::MappedDictionaryChecker::Constants::SETTING_USER_DICTIONARY ), d->userDictionary );
+  settings->endGroup();
+  settings->endGroup();
+  settings->endGroup();
+  settings->sync();
+}
+// --------------------------------------------------
+
+void MappedDictionaryChecker::loadDictionary()
+{
+#ifdef BENCH_TIME
+  QElapsedTimer timer;
+  timer.start();
+#endif /* BENCH_TIME */
+  /* Build the set before taking the lock, the lookups can continue using
+   * the current words in the mean time. */
+  QSet<QString> addedWords;
+  const QStringList userWords = d->userWords.words();
+  addedWords.reserve( userWords.size() + d->ignoredWords.size() );
+  for( const QString& word: userWords ) {
+    addedWords.insert( word );
+  }
+  for( const QString& word: qAsConst( d->ignoredWords ) ) {
+    addedWords.insert( word );
+  }
+
+  QWriteLocker lock( &d->lock );
+  d->unmap();
+  d->addedWords = std::move( addedWords );
+  d->dictionaryIdentity.clear();
+  if( d->dictionary.isEmpty() == true ) {
+    return;
+  }
+  d->imageFile.setFileName( d->dictionary );
+  if( d->imageFile.open( QIODevice::ReadOnly ) == false ) {
+    qDebug() << "loadDictionary: Could not open dictionary image: " << d->dictionary;
+    return;
+  }
+  d->image = d->imageFile.map( 0, d->imageFile.size() );
+  if( ( d->image == nullptr )
+      || ( d->reader.open( d->image, d->imageFile.size() ) == false ) ) {
+    qDebug() << "loadDictionary: Dictionary image is not valid: " << d->dictionary;
+    d->unmap();
+    return;
+  }
+  d->alphabet = d->reader.alphabet();
+  const QFileInfo dictionaryInfo( d->dictionary );
+  d->dictionaryIdentity = QStringLiteral( "%1|%2|%3" ).arg( dictionaryInfo.absoluteFilePath()
+                                                            , dictionaryInfo.lastModified().toString( Qt::ISODate )
+                                                            , QString::number( dictionaryInfo.size() ) );
+#ifdef BENCH_TIME
+  qDebug() << "MappedDictionaryChecker: Mapped" << d->reader.wordCount() << "words"
+           << "\n  - time : " << timer.elapsed();
+#endif /* BENCH_TIME */
+}
+// --------------------------------------------------
+
+bool MappedDictionaryChecker::isSpellingMistake( const QString& word ) const
+{
+  QReadLocker lock( &d->lock );
+  if( d->reader.isValid() == false ) {
+    /* Without a dictionary everything would be a mistake. */
+    return false;
+  }
+  return d->isCorrect( word ) == false;
+}
+// --------------------------------------------------
+
+QBitArray MappedDictionaryChecker::areSpellingMistakes( const QStringList& words ) const
+{
+  QBitArray mistakes( words.size() );
+  QReadLocker lock( &d->lock );
+  if( d->reader.isValid() == false ) {
+    return mistakes;
+  }
+  for( int index = 0; index < words.size(); ++index ) {
+    if( d->isCorrect( words.at( index ) ) == false ) {
+      mistakes.setBit( index );
+    }
+  }
+  return mistakes;
+}
+// --------------------------------------------------
+
+void MappedDictionaryChecker::getSuggestionsForWord( const QString& word, QStringList& suggestionsList ) const
+{
+  suggestionsList.clear();
+  if( word.isEmpty() == true ) {
+    return;
+  }
+  QReadLocker lock( &d->lock );
+  if( d->reader.isValid() == false ) {
+    return;
+  }
+  /* Generate all words that are one edit away from the lower case word and
+   * keep the ones that are correct. The edits that are the most likely for
+   * typing mistakes are done first, since the number of suggestions are
+   * limited. Suggestions get the same case as the original word. */
+  const QString lower    = word.toLower();
+  const bool allCaps     = ( word == word.toUpper() ) && ( word != lower );
+  const bool capitalized = ( allCaps == false ) && ( word.at( 0 ).isUpper() == true );
+  QSet<QString> seen;
+  auto tryCandidate = [&]( QString candidate ) {
+    if( ( suggestionsList.size() >= MAX_SUGGESTIONS )
+        || ( candidate.isEmpty() == true )
+        || ( candidate == lower ) ) {
+      return;
+    }
+    if( allCaps == true ) {
+      candidate = candidate.toUpper();
+    } else if( capitalized == true ) {
+      candidate[0] = candidate.at( 0 ).toUpper();
+    }
+    if( ( seen.contains( candidate ) == false )
+        && ( d->isCorrect( candidate ) == true ) ) {
+      seen.insert( candidate );
+      suggestionsList.append( candidate );
+    }
+  };
+  /* Only lower case characters of the alphabet are used, the case of the
+   * suggestions is handled separately. */
+  QString alphabet;
+  for( const QChar& character: d->alphabet ) {
+    if( character.isUpper() == false ) {
+      alphabet.append( character );
+    }
+  }
+  const int size = lower.size();
+  /* Swapped characters */
+  for( int index = 0; index + 1 < size; ++index ) {
+    QString candidate = lower;
+    const QChar character = candidate.at( index );
+    candidate[index]     = candidate.at( index + 1 );
+    candidate[index + 1] = character;
+    tryCandidate( candidate );
+  }
+  /* Wrong characters */
+  for( int index = 0; index < size; ++index ) {
+    for( const QChar& character: alphabet ) {
+      if( character != lower.at( index ) ) {
+        QString candidate = lower;
+        candidate[index] = character;
+        tryCandidate( candidate );
+      }
+    }
+  }
+  /* Extra characters */
+  for( int index = 0; index < size; ++index ) {
+    tryCandidate( QString( lower ).remove( index, 1 ) );
+  }
+  /* Missing characters */
+  for( int index = 0; index <= size; ++index ) {
+    for( const QChar& character: alphabet ) {
+      tryCandidate( QString( lower ).insert( index, character ) );
+    }
+  }
+}
+// --------------------------------------------------
+
+bool MappedDictionaryChecker::addWord( const QString& word )
+{
+  /* Save the word to the user dictionary */
+  if( d->userWords.addWord( word ) == false ) {
+    return false;
+  }
+  /* Only add the word to the spellchecker if the previous checks passed. */
+  QWriteLocker lock( &d->lock );
+  d->addedWords.insert( word );
+  return true;
+}
+// --------------------------------------------------
+
+bool MappedDictionaryChecker::ignoreWord( const QString& word )
+{
+  /* The word is only added for this run of the IDE.
+   * For this reason it is not added to the file. */
+  d->ignoredWords.append( word );
+  QWriteLocker lock( &d->lock );
+  d->addedWords.insert( word );
+  return true;
+}
+// --------------------------------------------------
+
+QString MappedDictionaryChecker::dictionaryIdentity() const
+{
+  QReadLocker lock( &d->lock );
+  return d->dictionaryIdentity;
+}
+// --------------------------------------------------
+
+QWidget* MappedDictionaryChecker::optionsWidget()
+{
+  MappedDictionaryOptionsWidget* widget = new MappedDictionaryOptionsWidget( d->dictionary, d->userDictionary );
+  connect( this,   &MappedDictionaryChecker::dictionaryChanged,           widget, &MappedDictionaryOptionsWidget::updateDictionary );
+  connect( this,   &MappedDictionaryChecker::userDictionaryChanged,       widget, &MappedDictionaryOptionsWidget::updateUserDictionary );
+  connect( widget, &MappedDictionaryOptionsWidget::dictionaryChanged,     this,   &MappedDictionaryChecker::updateDictionary );
+  connect( widget, &MappedDictionaryOptionsWidget::userDictionaryChanged, this,   &MappedDictionaryChecker::updateUserDictionary );
+  return widget;
+}
+// --------------------------------------------------
+
+void MappedDictionaryChecker::updateDictionary( const QString& dictionary )
+{
+  if( d->dictionary != dictionary ) {
+    d->dictionary = dictionary;
+    emit dictionaryChanged( d->dictionary );
+    loadDictionary();
+    emit dictionaryUpdated();
+  }
+}
+// --------------------------------------------------
+
+void MappedDictionaryChecker::updateUserDictionary( const QString& userDictionary )
+{
+  if( d->userDictionary != userDictionary ) {
+    d->userDictionary = userDictionary;
+    emit userDictionaryChanged( d->userDictionary );
+    d->userWords.open( d->userDictionary );
+    loadDictionary();
+    emit dictionaryUpdated();
+  }
+}
+// --------------------------------------------------
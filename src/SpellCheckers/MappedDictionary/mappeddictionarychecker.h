@@ -0,0 +1,77 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include "../../ISpellChecker.h"
+
+#include <QObject>
+
+namespace SpellChecker {
+namespace Checker {
+namespace MappedDictionary {
+
+class MappedDictionaryCheckerPrivate;
+/*! \brief Spell checker that uses a memory mapped, precompiled dictionary.
+ *
+ * The dictionary is an image compiled by the dictcompiler tool that contains
+ * all accepted word forms. The image is mapped read-only, thus loading it is
+ * almost instant and all threads and processes using the same image share
+ * the memory. Lookups do not need a lock on the image, which makes the
+ * checker safe to use from multiple threads without pooling.
+ *
+ * Since the image does not contain affix rules, suggestions are limited to
+ * words that are a single edit away from the misspelled word. */
+class MappedDictionaryChecker
+  : public SpellChecker::ISpellChecker
+{
+  Q_OBJECT
+public:
+  MappedDictionaryChecker();
+  ~MappedDictionaryChecker() override;
+
+  QString name() const Q_DECL_OVERRIDE;
+  bool isSpellingMistake( const QString& word ) const Q_DECL_OVERRIDE;
+  QBitArray areSpellingMistakes( const QStringList& words ) const Q_DECL_OVERRIDE;
+  void getSuggestionsForWord( const QString& word, QStringList& suggestionsList ) const Q_DECL_OVERRIDE;
+  bool addWord( const QString& word ) Q_DECL_OVERRIDE;
+  bool ignoreWord( const QString& word ) Q_DECL_OVERRIDE;
+  QWidget* optionsWidget() Q_DECL_OVERRIDE;
+  QString dictionaryIdentity() const Q_DECL_OVERRIDE;
+
+signals:
+  void dictionaryChanged( const QString& dictionary );
+  void userDictionaryChanged( const QString& userDictionary );
+
+public slots:
+  void updateDictionary( const QString& dictionary );
+  void updateUserDictionary( const QString& userDictionary );
+
+private:
+  void loadSettings();
+  void saveSettings() const;
+  /*! \brief Map the dictionary image and set up the added words. */
+  void loadDictionary();
+  MappedDictionaryCheckerPrivate* const d;
+};
+
+} // namespace MappedDictionary
+} // namespace Checker
+} // namespace SpellChecker
@@ -0,0 +1,136 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "mappeddictionaryoptionswidget.h"
+#include "ui_mappeddictionaryoptionswidget.h"
+
+#include <coreplugin/icore.h>
+
+#include <QFileDialog>
+#include <QRegularExpression>
+
+using namespace SpellChecker::Checker::MappedDictionary;
+
+MappedDictionaryOptionsWidget::MappedDictionaryOptionsWidget( const QString& dictionary, const QString& userDictionary, QWidget* parent )
+  : QWidget( parent )
+  , ui( new Ui::MappedDictionaryOptionsWidget )
+{
+  ui->setupUi( this );
+  /* Set the hints on the different Dictionaries */
+  ui->lineEditDictionary->setToolTip( tr( "The dictionary is a *.scdic image compiled with the dictcompiler tool. \n"
+                                          "The image is memory mapped, thus it is available immediately and shared \n"
+                                          "between all threads and Qt Creator instances that use it. \n"
+                                          "The compiler reads a Hunspell dictionary and expands its affixes." ) );
+  ui->lineEditUserDictionary->setToolTip( tr( "The User Dictionary is a custom user dictionary that the spell checker \n"
+                                              "will use to remember words that get added to the dictionary. \n"
+                                              "It uses the same format as the Hunspell user dictionary, thus the same file can be used. " ) );
+
+  updateDictionary( dictionary );
+  updateUserDictionary( userDictionary );
+}
+// --------------------------------------------------
+
+MappedDictionaryOptionsWidget::~MappedDictionaryOptionsWidget()
+{
+  delete ui;
+}
+// --------------------------------------------------
+
+void MappedDictionaryOptionsWidget::applySettings()
+{
+  /* Make sure the dictionary exists */
+  QFileInfo dict( ui->lineEditDictionary->text() );
+  if( dict.exists() == true ) {
+    emit dictionaryChanged( ui->lineEditDictionary->text() );
+  } else {
+    emit optionsError( QLatin1String( "Mapped Dictionary Spellchecker" ), tr( "Dictionary does not exist" ) );
+    return;
+  }
+
+  QFileInfo userDict( ui->lineEditUserDictionary->text() );
+  if( userDict.dir().mkpath( "." ) == false ) {
+    emit optionsError( QLatin1String( "Mapped Dictionary Spellchecker" ), tr( "Path to user dictionary could not be created" ) );
+    return;
+  }
+  /* The Dir should exist at this point, check if the file exists and can be made if it does not */
+  if( userDict.exists() == false ) {
+    QFile file( ui->lineEditUserDictionary->text() );
+    if( file.open( QFile::ReadWrite | QFile::Text ) == false ) {
+      emit optionsError( QLatin1String( "Mapped Dictionary Spellchecker" ), tr( "User dictionary can not be created, perhaps insufficient access on folder." ) );
+      return;
+    }
+  }
+  /* At this point the user dictionary specified should be valid. */
+  emit userDictionaryChanged( ui->lineEditUserDictionary->text() );
+}
+// --------------------------------------------------
+
+void MappedDictionaryOptionsWidget::updateDictionary( const QString& dictionary )
+{
+  ui->lineEditDictionary->setText( dictionary );
+  /* If the dictionary gets changed, and the user dictionary is empty
+   * Create a user dictionary name derived from the selected dictionary,
+   * using the same name that the Hunspell spell checker would use. */
+  if( ( ui->lineEditUserDictionary->text().isEmpty() == true )
+      && ( dictionary.isEmpty() == false ) ) {
+    QFileInfo fileInfo( dictionary );
+    QString   userDictFileName = fileInfo.fileName();
+    userDictFileName.replace( QRegularExpression( QLatin1String( "\\.scdic$" ) ), QLatin1String( ".udic" ) );
+    userDictFileName = QLatin1String( "QtC-" ) + userDictFileName;
+    /* Add the file name to the User Resource Path */
+    QString userDictName = Core::ICore::userResourcePath() + QLatin1String( "/UserDictionaries/" ) + userDictFileName;
+    updateUserDictionary( userDictName );
+  }
+}
+// --------------------------------------------------
+
+void MappedDictionaryOptionsWidget::updateUserDictionary( const QString& userDictionary )
+{
+  ui->lineEditUserDictionary->setText( userDictionary );
+}
+// --------------------------------------------------
+
+void MappedDictionaryOptionsWidget::on_toolButtonBrowseDictionary_clicked()
+{
+  QString dictionary = QFileDialog::getOpenFileName( this,
+                                                     tr( "Dictionary Image" ),
+                                                     ui->lineEditDictionary->text(),
+                                                     tr( "Dictionary Images (*.scdic)" ),
+                                                     0,
+                                                     QFileDialog::ReadOnly );
+  if( dictionary.isEmpty() == false ) {
+    updateDictionary( dictionary );
+  }
+}
+// --------------------------------------------------
+
+void MappedDictionaryOptionsWidget::on_toolButtonBrowseUserDictionary_clicked()
+{
+  QString userDictionary = QFileDialog::getSaveFileName( this,
+                                                         tr( "User Dictionary File" ),
+                                                         ui->lineEditUserDictionary->text(),
+                                                         tr( "Dictionaries (*.udic)" ),
+                                                         0,
+                                                         0 );
+  if( userDictionary.isEmpty() == false ) {
+    updateUserDictionary( userDictionary );
+  }
+}
+// --------------------------------------------------
@@ -1 +1,2 @@
-include(HunspellChecker/HunspellChecker.pri)
\ No newline at end of file
+include(HunspellChecker/HunspellChecker.pri)
+include(MappedDictionary/MappedDictionary.pri)
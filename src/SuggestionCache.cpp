@@ -0,0 +1,145 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "SuggestionCache.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace {
+/*! \brief Magic number at the start of the cache file. */
+const quint32 CACHE_FILE_MAGIC = 0x53435343;
+/*! \brief Version of the cache file format.
+ *
+ * Increment this if the format changes, files with a different version are
+ * ignored when loading. */
+const quint32 CACHE_FILE_VERSION = 1;
+} // namespace
+
+using namespace SpellChecker;
+
+SuggestionCache::SuggestionCache( int maxWords )
+  : d_mutex()
+  , d_cache( maxWords )
+  , d_generation( 0 )
+{}
+// --------------------------------------------------
+
+SuggestionCache::~SuggestionCache()
+{}
+// --------------------------------------------------
+
+bool SuggestionCache::find( const QString& dictionary, const QString& word, QStringList& suggestions ) const
+{
+  QMutexLocker lock( &d_mutex );
+  /* Looking up the object marks it as the most recently used. */
+  QStringList* cached = d_cache.object( { dictionary, word } );
+  if( cached == nullptr ) {
+    return false;
+  }
+  suggestions = *cached;
+  return true;
+}
+// --------------------------------------------------
+
+void SuggestionCache::insert( quint64 generation, const QString& dictionary, const QString& word, const QStringList& suggestions )
+{
+  QMutexLocker lock( &d_mutex );
+  if( generation != d_generation ) {
+    return;
+  }
+  d_cache.insert( { dictionary, word }, new QStringList( suggestions ) );
+}
+// --------------------------------------------------
+
+void SuggestionCache::clear()
+{
+  QMutexLocker lock( &d_mutex );
+  d_cache.clear();
+  ++d_generation;
+}
+// --------------------------------------------------
+
+quint64 SuggestionCache::generation() const
+{
+  QMutexLocker lock( &d_mutex );
+  return d_generation;
+}
+// --------------------------------------------------
+
+bool SuggestionCache::load( const QString& fileName )
+{
+  QFile file( fileName );
+  if( file.open( QIODevice::ReadOnly ) == false ) {
+    return false;
+  }
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_12 );
+  quint32 magic   = 0;
+  quint32 version = 0;
+  stream >> magic >> version;
+  if( ( magic != CACHE_FILE_MAGIC )
+      || ( version != CACHE_FILE_VERSION ) ) {
+    qDebug() << "SuggestionCache: Ignoring cache file with unknown format: " << fileName;
+    return false;
+  }
+
+  QString dictionary;
+  QString word;
+  QStringList suggestions;
+  QMutexLocker lock( &d_mutex );
+  while( stream.atEnd() == false ) {
+    stream >> dictionary >> word >> suggestions;
+    if( stream.status() != QDataStream::Ok ) {
+      /* Keep what was read up to the error. */
+      return false;
+    }
+    d_cache.insert( { dictionary, word }, new QStringList( suggestions ) );
+  }
+  return true;
+}
+// --------------------------------------------------
+
+bool SuggestionCache::save( const QString& fileName ) const
+{
+  QFileInfo( fileName ).dir().mkpath( QStringLiteral( "." ) );
+  /* Use a save file so that a crash while writing does not leave a
+   * truncated cache behind. */
+  QSaveFile file( fileName );
+  if( file.open( QIODevice::WriteOnly ) == false ) {
+    qDebug() << "SuggestionCache: Could not open cache file: " << fileName;
+    return false;
+  }
+  QDataStream stream( &file );
+  stream.setVersion( QDataStream::Qt_5_12 );
+  stream << CACHE_FILE_MAGIC << CACHE_FILE_VERSION;
+  {
+    QMutexLocker lock( &d_mutex );
+    const QList<SuggestionKey> keys = d_cache.keys();
+    for( const SuggestionKey& key: keys ) {
+      stream << key.dictionary << key.word << *d_cache.object( key );
+    }
+  }
+  return file.commit();
+}
+// --------------------------------------------------
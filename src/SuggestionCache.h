@@ -0,0 +1,106 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include <QCache>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+namespace SpellChecker {
+
+/*! \brief Key of the SuggestionCache.
+ *
+ * Suggestions depend on the dictionary that was used to get them, thus the
+ * identity of the dictionary is part of the key. */
+struct SuggestionKey {
+  QString dictionary;
+  QString word;
+
+  bool operator==( const SuggestionKey& other ) const
+  {
+    return ( ( word == other.word )
+             && ( dictionary == other.dictionary ) );
+  }
+};
+
+inline uint qHash( const SuggestionKey& key, uint seed = 0 )
+{
+  return ::qHash( key.word, seed ) ^ ::qHash( key.dictionary, seed );
+}
+
+/*! \brief The SuggestionCache class
+ *
+ * Bounded least recently used cache of suggestions for misspelled words.
+ * Getting suggestions from a spell checker is slow compared to checking
+ * a word, and the same mistakes tend to be repeated in many files of a
+ * project. The cache is shared between all threads that get suggestions
+ * and is thread safe.
+ *
+ * The cache can be saved to and loaded from a file to keep the suggestions
+ * between sessions.
+ *
+ * Suggestions also change when words are added to the dictionary, which
+ * does not change the identity of the dictionary. The owner of the cache
+ * must clear() it in that case. Each clear starts a new generation, and
+ * suggestions that were looked up during an older generation are not
+ * inserted anymore.
+ */
+class SuggestionCache
+{
+public:
+  /*! \brief Construct the cache to hold at most \a maxWords words. */
+  SuggestionCache( int maxWords );
+  ~SuggestionCache();
+
+  /*! \brief Find the suggestions for the \a word.
+   * \param[in] dictionary Identity of the dictionary used to get the suggestions.
+   * \param[in] word Misspelled word.
+   * \param[out] suggestions The cached suggestions if the word was in the cache.
+   * \return True if the word was in the cache. */
+  bool find( const QString& dictionary, const QString& word, QStringList& suggestions ) const;
+  /*! \brief Insert the \a suggestions for the \a word into the cache.
+   *
+   * If the cache is full, the least recently used word is removed.
+   * \param[in] generation Generation of the cache from before the
+   *              suggestions were looked up. If the cache was cleared since,
+   *              the suggestions might be outdated and are not inserted. */
+  void insert( quint64 generation, const QString& dictionary, const QString& word, const QStringList& suggestions );
+  /*! \brief Remove all words from the cache and start a new generation. */
+  void clear();
+  /*! \brief Get the current generation of the cache. */
+  quint64 generation() const;
+  /*! \brief Load the cache from the file.
+   *
+   * Words in the file are added to the words already in the cache.
+   * \return False if the file could not be read. */
+  bool load( const QString& fileName );
+  /*! \brief Save the cache to the file.
+   * \return False if the file could not be written. */
+  bool save( const QString& fileName ) const;
+
+private:
+  mutable QMutex d_mutex;
+  mutable QCache<SuggestionKey, QStringList> d_cache;
+  quint64 d_generation;
+};
+
+} // namespace SpellChecker
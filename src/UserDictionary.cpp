@@ -0,0 +1,276 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "UserDictionary.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextCodec>
+
+// #define BENCH_TIME
+#ifdef BENCH_TIME
+#include <QElapsedTimer>
+#endif /* BENCH_TIME */
+
+namespace {
+/*! Number of bytes remembered before the end of the known part of the file. */
+const int KNOWN_TAIL_SIZE = 64;
+} // namespace
+
+using namespace SpellChecker;
+
+UserDictionary::UserDictionary( QObject* parent )
+  : QObject( parent )
+  , d_codec( QTextCodec::codecForLocale() )
+  , d_knownSize( 0 )
+{
+  connect( &d_watcher, &QFileSystemWatcher::fileChanged,      this, &UserDictionary::fileChanged );
+  connect( &d_watcher, &QFileSystemWatcher::directoryChanged, this, &UserDictionary::directoryChanged );
+}
+// --------------------------------------------------
+
+UserDictionary::~UserDictionary()
+{
+  d_appendFile.close();
+}
+// --------------------------------------------------
+
+bool UserDictionary::open( const QString& fileName )
+{
+  d_appendFile.close();
+  if( d_watcher.files().isEmpty() == false ) {
+    d_watcher.removePaths( d_watcher.files() );
+  }
+  if( d_watcher.directories().isEmpty() == false ) {
+    d_watcher.removePaths( d_watcher.directories() );
+  }
+  d_fileName = fileName;
+  d_words.clear();
+  d_index.clear();
+  d_knownSize = 0;
+  d_knownTail.clear();
+  if( d_fileName.isEmpty() == true ) {
+    return true;
+  }
+  /* Watch the directory, also if the file does not exist yet, so that a
+   * file created by another process is picked up. */
+  watch();
+  if( QFileInfo::exists( d_fileName ) == false ) {
+    return true;
+  }
+#ifdef BENCH_TIME
+  QElapsedTimer timer;
+  timer.start();
+#endif /* BENCH_TIME */
+  QStringList words;
+  if( readFrom( 0, words ) == false ) {
+    return false;
+  }
+  index( words );
+#ifdef BENCH_TIME
+  qDebug() << "UserDictionary: Loaded" << d_words.size() << "words from" << d_fileName
+           << "\n  - time : " << timer.elapsed();
+#endif /* BENCH_TIME */
+  return true;
+}
+// --------------------------------------------------
+
+QString UserDictionary::fileName() const
+{
+  return d_fileName;
+}
+// --------------------------------------------------
+
+QStringList UserDictionary::words() const
+{
+  return d_words;
+}
+// --------------------------------------------------
+
+bool UserDictionary::contains( const QString& word ) const
+{
+  return d_index.contains( word );
+}
+// --------------------------------------------------
+
+bool UserDictionary::addWord( const QString& word )
+{
+  if( d_fileName.isEmpty() == true ) {
+    qDebug() << "User dictionary name empty";
+    return false;
+  }
+  if( d_index.contains( word ) == true ) {
+    return true;
+  }
+
+  if( d_appendFile.isOpen() == false ) {
+    QFileInfo( d_fileName ).dir().mkpath( "." );
+    d_appendFile.setFileName( d_fileName );
+    if( d_appendFile.open( QIODevice::Append ) == false ) {
+      qDebug() << "Could not open user dictionary file: " << d_fileName;
+      return false;
+    }
+    watch();
+  }
+
+  QByteArray line;
+  if( ( d_knownTail.isEmpty() == false )
+      && ( d_knownTail.endsWith( '\n' ) == false ) ) {
+    /* The last word in the file does not end with a new line, without it
+     * the word would get joined with the new word. */
+    line.append( '\n' );
+  }
+  line.append( d_codec->fromUnicode( word ) );
+  line.append( '\n' );
+  /* Write the line in one go and flush it, so that the file always contains
+   * complete lines, except when the process crashes during the write. */
+  if( ( d_appendFile.write( line ) != line.size() )
+      || ( d_appendFile.flush() == false ) ) {
+    qDebug() << "Could not write to user dictionary file: " << d_fileName;
+    d_appendFile.close();
+    return false;
+  }
+  /* The store wrote these bytes, they must not be seen as a change by
+   * another process. */
+  d_knownSize += line.size();
+  d_knownTail  = ( d_knownTail + line ).right( KNOWN_TAIL_SIZE );
+  index( { word } );
+  return true;
+}
+// --------------------------------------------------
+
+void UserDictionary::fileChanged()
+{
+  if( QFileInfo::exists( d_fileName ) == false ) {
+    /* Some editors save a file by removing and renaming it, the watcher
+     * stops watching the file in that case. It is watched again once it
+     * appears in the directory, see directoryChanged(). */
+    return;
+  }
+  if( d_watcher.files().isEmpty() == true ) {
+    /* The file was removed or replaced, the append file still refers to
+     * the old file. */
+    d_appendFile.close();
+    watch();
+  }
+
+  /* Check if the part of the file that is known is unchanged. */
+  bool appended = false;
+  QFile file( d_fileName );
+  if( ( file.open( QIODevice::ReadOnly ) == true )
+      && ( file.size() >= d_knownSize ) ) {
+    const qint64 tailStart = d_knownSize - d_knownTail.size();
+    appended = ( file.seek( tailStart ) == true )
+               && ( file.read( d_knownTail.size() ) == d_knownTail );
+  }
+  file.close();
+
+  if( appended == true ) {
+    QStringList words;
+    readFrom( d_knownSize, words );
+    words = index( words );
+    if( words.isEmpty() == false ) {
+      emit wordsAdded( words );
+    }
+    return;
+  }
+  /* The file was rewritten, read it again. The append file is reopened
+   * when needed since the file might have been replaced. */
+  open( d_fileName );
+  emit reset();
+}
+// --------------------------------------------------
+
+void UserDictionary::directoryChanged()
+{
+  /* Only of interest if the file appeared while it was not watched. */
+  if( ( d_watcher.files().isEmpty() == false )
+      || ( QFileInfo::exists( d_fileName ) == false ) ) {
+    return;
+  }
+  fileChanged();
+}
+// --------------------------------------------------
+
+void UserDictionary::watch()
+{
+  if( d_fileName.isEmpty() == true ) {
+    return;
+  }
+  const QFileInfo info( d_fileName );
+  if( ( d_watcher.directories().isEmpty() == true )
+      && ( info.dir().exists() == true ) ) {
+    d_watcher.addPath( info.absolutePath() );
+  }
+  if( ( d_watcher.files().isEmpty() == true )
+      && ( info.exists() == true ) ) {
+    d_watcher.addPath( d_fileName );
+  }
+}
+// --------------------------------------------------
+
+bool UserDictionary::readFrom( qint64 offset, QStringList& words )
+{
+  QFile file( d_fileName );
+  if( file.open( QIODevice::ReadOnly ) == false ) {
+    qDebug() << "Could not open user dictionary file: " << d_fileName;
+    return false;
+  }
+  if( file.seek( offset ) == false ) {
+    return false;
+  }
+  QByteArray data = file.readAll();
+  if( offset != 0 ) {
+    /* Another process might still be busy writing the last line, only use
+     * complete lines. The rest is read on the next change. */
+    data.truncate( data.lastIndexOf( '\n' ) + 1 );
+  }
+  d_knownSize = offset + data.size();
+  d_knownTail = ( d_knownTail + data ).right( KNOWN_TAIL_SIZE );
+
+  /* Decode the data in one go and split it, instead of reading it line
+   * by line. */
+  words = d_codec->toUnicode( data ).split( QLatin1Char( '\n' ), Qt::SkipEmptyParts );
+  for( QString& word: words ) {
+    if( word.endsWith( QLatin1Char( '\r' ) ) == true ) {
+      word.chop( 1 );
+    }
+  }
+  words.removeAll( QString() );
+  return true;
+}
+// --------------------------------------------------
+
+QStringList UserDictionary::index( const QStringList& words )
+{
+  QStringList newWords;
+  newWords.reserve( words.size() );
+  d_index.reserve( d_index.size() + words.size() );
+  for( const QString& word: words ) {
+    if( d_index.contains( word ) == false ) {
+      d_index.insert( word );
+      newWords.append( word );
+    }
+  }
+  d_words.append( newWords );
+  return newWords;
+}
+// --------------------------------------------------
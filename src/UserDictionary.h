@@ -0,0 +1,119 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#pragma once
+
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+class QTextCodec;
+
+namespace SpellChecker {
+
+/*! \brief The UserDictionary class
+ *
+ * Store for the words in a user dictionary file. The file contains one word
+ * per line, encoded using the locale codec the same as the files that were
+ * written by QTextStream.
+ *
+ * The file is read in one go and the words are kept in a hash set so that
+ * duplicates are not appended again. Added words are appended to the file
+ * that stays open between calls, each word is written with a single write
+ * and flushed so that a crash can at most lose the word that was busy being
+ * written, never corrupt the words before it.
+ *
+ * The file is watched for changes by other processes, for example a shared
+ * dictionary that is updated from version control. If words were appended,
+ * only the new part of the file is read and wordsAdded() is emitted. If the
+ * file was rewritten in any other way it is read again and reset() is
+ * emitted. The directory of the file is watched as well, since some editors
+ * and version control tools remove the file before writing it again, and
+ * the watcher stops watching a file that was removed. Once the file appears
+ * again it is watched again and handled as a change.
+ *
+ * The class is not thread safe and must be used from the thread it lives in.
+ */
+class UserDictionary
+  : public QObject
+{
+  Q_OBJECT
+public:
+  UserDictionary( QObject* parent = nullptr );
+  ~UserDictionary() override;
+
+  /*! \brief Open the user dictionary file and read its words.
+   *
+   * If the file does not exist yet, the store is empty and the file will be
+   * created when the first word is added.
+   * \return False if the file exists but could not be read. */
+  bool open( const QString& fileName );
+  /*! \brief Name of the open file, empty if no file is open. */
+  QString fileName() const;
+  /*! \brief All words in the dictionary, in the order of the file. */
+  QStringList words() const;
+  /*! \brief Check if the word is in the dictionary. */
+  bool contains( const QString& word ) const;
+  /*! \brief Append the word to the dictionary file.
+   *
+   * Words already in the dictionary are not appended again.
+   * \return False if the word could not be written to the file. */
+  bool addWord( const QString& word );
+
+signals:
+  /*! \brief Emitted when words were appended to the file by another process. */
+  void wordsAdded( const QStringList& words );
+  /*! \brief Emitted when the file was rewritten and read again.
+   *
+   * Words might have been removed, thus users must rebuild anything that
+   * was built from the previous words. */
+  void reset();
+
+private:
+  /*! \brief Slot called when the watcher reports a change to the file. */
+  void fileChanged();
+  /*! \brief Slot called when the watcher reports a change to the directory
+   * of the file, the file might have been created or replaced. */
+  void directoryChanged();
+  /*! \brief Watch the file and its directory, if they exist and are not
+   * watched yet. */
+  void watch();
+  /*! \brief Read the words in the file from the \a offset to the end.
+   * \return False if the file could not be read. */
+  bool readFrom( qint64 offset, QStringList& words );
+  /*! \brief Add words to the index, only returning the words that are new. */
+  QStringList index( const QStringList& words );
+
+  QString d_fileName;
+  QTextCodec* d_codec;
+  QStringList d_words;
+  QSet<QString> d_index;
+  /*! \brief File kept open to append words. Only opened when a word is added. */
+  QFile d_appendFile;
+  /*! \brief Number of bytes of the file that were read or written by the store. */
+  qint64 d_knownSize;
+  /*! \brief Last bytes before d_knownSize, to detect files that were rewritten. */
+  QByteArray d_knownTail;
+  QFileSystemWatcher d_watcher;
+};
+
+} // namespace SpellChecker
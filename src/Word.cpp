@@ -0,0 +1,89 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "Word.h"
+
+using namespace SpellChecker;
+
+WordList::const_iterator WordList::constFind( const QString& text ) const
+{
+  updateIndex();
+  const QHash<QString, QPair<int, int>>::const_iterator iter = d_index.constFind( text );
+  if( iter == d_index.constEnd() ) {
+    return d_words.constEnd();
+  }
+  return d_words.constBegin() + d_order.at( iter.value().first );
+}
+// --------------------------------------------------
+
+int WordList::count( const QString& text ) const
+{
+  updateIndex();
+  return d_index.value( text ).second;
+}
+// --------------------------------------------------
+
+int WordList::remove( const QString& text )
+{
+  return removeIf( [&text]( const Word& word ) {
+    return word.text == text;
+  } );
+}
+// --------------------------------------------------
+
+void WordList::sortByPosition()
+{
+  std::stable_sort( d_words.begin(), d_words.end(), []( const Word& lhs, const Word& rhs ) {
+    return ( lhs.lineNumber < rhs.lineNumber )
+           || ( ( lhs.lineNumber == rhs.lineNumber ) && ( lhs.columnNumber < rhs.columnNumber ) );
+  } );
+  d_indexValid = false;
+}
+// --------------------------------------------------
+
+void WordList::updateIndex() const
+{
+  if( d_indexValid == true ) {
+    return;
+  }
+  /* Count the occurrences of each text first, then give each text its
+   * range in the order and fill the ranges in the order of the list. The
+   * first occurrence of a text in the range is thus also the first one in
+   * the list. */
+  d_index.clear();
+  d_index.reserve( d_words.size() );
+  for( const Word& word: d_words ) {
+    ++( d_index[word.text].second );
+  }
+  int offset = 0;
+  for( QPair<int, int>& range: d_index ) {
+    range.first  = offset;
+    offset      += range.second;
+    range.second = 0;
+  }
+  d_order.resize( d_words.size() );
+  for( int index = 0; index < d_words.size(); ++index ) {
+    QPair<int, int>& range = d_index[d_words.at( index ).text];
+    d_order[range.first + range.second] = index;
+    ++range.second;
+  }
+  d_indexValid = true;
+}
+// --------------------------------------------------
@@ -21,9 +21,12 @@
 #pragma once
 
 #include <QDebug>
-#include <QMultiHash>
+#include <QHash>
 #include <QString>
 #include <QStringList>
+#include <QVector>
+
+#include <algorithm>
 
 namespace SpellChecker {
 
@@ -66,32 +69,96 @@ public:
   }
 };
 
-/* Define used to use different types of word lists
- * for the spell checker. The 2 different types were defined
- * to test usage as well speed/performance of different
- * implementations. This was not done yet but might still be
- * done in future. */
-#define USE_MULTI_HASH
-#ifdef USE_MULTI_HASH
+/*! \brief The WordList class
+ *
+ * Flat list of words, stored contiguously in the order that they were added
+ * or, after sortByPosition(), in the order that they appear in the file.
+ *
+ * Lookups by the text of a word use a side index from the text to the range
+ * of its occurrences. The index is built on the first lookup after the list
+ * changed, thus building and iterating the list does not pay for it. The
+ * texts in the index are shared with the words, they are not copied.
+ *
+ * Changing the list, also through a non const iterator, invalidates the
+ * index. Like the Qt containers, a list can be copied to another thread but
+ * a single list must not be used from more than one thread at a time. */
 class WordList
-  : public QMultiHash<QString, Word>
 {
 public:
+  using iterator       = QVector<Word>::iterator;
+  using const_iterator = QVector<Word>::const_iterator;
+  using Iterator       = iterator;
+  using ConstIterator  = const_iterator;
+  using value_type     = Word;
+
   inline WordList() {}
-  void append( const Word& t ) { this->insert( t.text, t ); }
-  void append( const WordList& l )
+
+  void append( const Word& t ) { d_words.append( t ); d_indexValid = false; }
+  void append( Word&& t ) { d_words.append( std::move( t ) ); d_indexValid = false; }
+  void append( const WordList& l ) { d_words.append( l.d_words ); d_indexValid = false; }
+  void reserve( int size ) { d_words.reserve( size ); }
+  void clear() { d_words.clear(); d_index.clear(); d_order.clear(); d_indexValid = false; }
+
+  int size() const { return d_words.size(); }
+  int count() const { return d_words.size(); }
+  int capacity() const { return d_words.capacity(); }
+  bool isEmpty() const { return d_words.isEmpty(); }
+  bool empty() const { return d_words.isEmpty(); }
+  const Word& at( int index ) const { return d_words.at( index ); }
+  /*! \brief Get the words as a vector, in the order of the list. */
+  const QVector<Word>& toVector() const { return d_words; }
+
+  iterator begin() { d_indexValid = false; return d_words.begin(); }
+  iterator end() { d_indexValid = false; return d_words.end(); }
+  const_iterator begin() const { return d_words.constBegin(); }
+  const_iterator end() const { return d_words.constEnd(); }
+  const_iterator constBegin() const { return d_words.constBegin(); }
+  const_iterator constEnd() const { return d_words.constEnd(); }
+
+  /*! \brief Find the first occurrence of the word with the given text.
+   * \return Iterator to the word, or constEnd() if the text is not in the list. */
+  const_iterator constFind( const QString& text ) const;
+  /*! \brief Number of occurrences of the word with the given text. */
+  int count( const QString& text ) const;
+  /*! \brief Remove all occurrences of the word with the given text.
+   * \return The number of words removed. */
+  int remove( const QString& text );
+  /*! \brief Remove all words for which the predicate returns true.
+   *
+   * The order of the remaining words is kept. */
+  template<typename Predicate>
+  int removeIf( Predicate predicate )
   {
-    for( const Word& t: l ) {
-      append( t );
+    const iterator removedBegin = std::remove_if( d_words.begin(), d_words.end(), predicate );
+    const int removed           = int( d_words.end() - removedBegin );
+    if( removed != 0 ) {
+      d_words.erase( removedBegin, d_words.end() );
+      d_indexValid = false;
     }
+    return removed;
   }
+  /*! \brief Sort the words in the order that they appear in the file,
+   * on line and then on column. */
+  void sortByPosition();
+
+  bool operator==( const WordList& other ) const { return d_words == other.d_words; }
+  bool operator!=( const WordList& other ) const { return d_words != other.d_words; }
+
+private:
+  /*! \brief Build the index if the list changed since it was last built. */
+  void updateIndex() const;
+
+  QVector<Word> d_words;
+  /*! \brief Range of the occurrences of each text in \a d_order,
+   * as the offset of the first and the number of occurrences. */
+  mutable QHash<QString, QPair<int, int>> d_index;
+  /*! \brief Indexes of the words in \a d_words, grouped by text. */
+  mutable QVector<int> d_order;
+  mutable bool d_indexValid = false;
 };
 
 typedef WordList::iterator WordListIter;
 typedef WordList::const_iterator WordListConstIter;
-#else /* USE_MULTI_HASH */
-typedef QList<Word> WordList;
-#endif /* USE_MULTI_HASH */
 
 typedef QHash<QString /* File name */, WordList> FileWordList;
 
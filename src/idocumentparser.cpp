@@ -134,49 +134,10 @@ void IDocumentParser::getWordsFromSplitString( const QStringList& stringList, co
 
 void IDocumentParser::removeWordsThatAppearInSource( const QStringSet& wordsInSource, WordList& words )
 {
-  /* Hopefully all words that are the same would be together in the WordList because of
-   * the nature of the QMultiHash. This would make removing multiple instances of the same
-   * word faster.
-   *
-   * The idea is to save the last word that was removed, and then for the next word,
-   * first compare it to the last word removed, and if it is the same, remove it from the list. Else
-   * search for the word in the wordsInSource list. The reasoning is that the first compare will be
-   * faster than the search in the wordsInSource list. But with this the overhead is added that now
-   * there is perhaps one more compare for each word that is not present in the source. Perhaps this
-   * can then be slower because the probability is that there will be more words not in the source
-   * than there are duplicate words that are in the source. For now this will be left this way but
-   * more benchmarking needs to be done to optimize.
-   *
-   * An initial test using QTime::start() and QTime::elapsed() showed the same speed of 3ms for
-   * either option for about 1425 potential words checked in 98 words occurring in the source. 148
-   * Words were removed for this test case. NOTE: Due to the inaccuracy of the timer on windows a
-   * better test will be performed in future. */
-#ifdef USE_MULTI_HASH
-  WordList::Iterator iter = words.begin();
-  QString lastWordRemoved;
-  while( iter != words.end() ) {
-    if( iter.key() == lastWordRemoved ) {
-      iter = words.erase( iter );
-    } else if( wordsInSource.contains( iter.key() ) ) {
-      lastWordRemoved = iter.key();
-      /* The word does appear in the source, thus remove it from the list of
-       * potential words that must be checked */
-      iter = words.erase( iter );
-    } else {
-      ++iter;
-    }
-  }
-#else /* USE_MULTI_HASH */
-  WordList::Iterator iter = words.begin();
-  while( iter != words.end() ) {
-    if( wordsInSource.contains( ( *iter ).text ) ) {
-      /* The word does appear in the source, thus remove it from the list of
-       * potential words that must be checked */
-      iter = words.erase( iter );
-    } else {
-      ++iter;
-    }
-  }
-#endif /* USE_MULTI_HASH */
+  /* The words that appear in the source are removed in a single pass over the
+   * list, keeping the order of the remaining words. */
+  words.removeIf( [&wordsInSource]( const Word& word ) {
+    return wordsInSource.contains( word.text );
+  } );
 }
 // --------------------------------------------------
@@ -50,6 +50,13 @@ public:
   virtual ~IDocumentParser() Q_DECL_OVERRIDE;
   virtual QString displayName()             = 0;
   virtual Core::IOptionsPage* optionsPage() = 0;
+  /*! \brief Get a string that identifies the settings of the parser.
+   *
+   * Words that were extracted by the parser are only reused from a previous
+   * session if the identity of the settings did not change since. Parsers
+   * with settings that influence which words are extracted must add them
+   * to the identity. */
+  virtual QString settingsIdentity() { return displayName(); }
 
   static bool isReservedWord( const QString& word );
   static void getWordsFromSplitString( const QStringList& stringList, const Word& word, WordList& wordList );
@@ -57,6 +64,17 @@ public:
 protected:
 signals:
   void spellcheckWordsParsed( const QString& fileName, const SpellChecker::WordList& wordlist );
+  /*! \brief Signal emitted by parsers that also checked the words that they extracted.
+   *
+   * Checking the words in the same background task that extracted them saves
+   * the core from starting a second task for the file. The signal must be
+   * emitted from the main thread.
+   * \param[in] fileName File that the words belong to.
+   * \param[in] wordlist Words that were extracted from the file.
+   * \param[in] mistakes Misspelled words of the \a wordlist.
+   * \param[in] dictionaryRevision SpellCheckerCore::dictionaryRevision() from
+   *      before the words were checked. */
+  void spellcheckWordsChecked( const QString& fileName, const SpellChecker::WordList& wordlist, const SpellChecker::WordList& mistakes, quint32 dictionaryRevision );
 
 public slots:
   /*! Slot that will get called when the current editor changes.
@@ -88,6 +106,25 @@ public slots:
    * and then it is passed to the parsers. The parsers then does not need
    * to get the source files as well. */
   virtual void updateProjectFiles( QStringSet filesAdded, QStringSet filesRemoved ) { Q_UNUSED( filesAdded ) Q_UNUSED( filesRemoved ) }
+  /*! Slot that will get called when the results of some files of the
+   * active project were restored from a previous session.
+   *
+   * The words of these files are already known to the core, as long as the
+   * files do not change, the parser does not have to parse them again. The
+   * results are restored as the files get added to the project, thus this
+   * can be called more than once for a project, each call adds to the files
+   * of the previous calls. The files are forgotten when the active project
+   * changes.
+   * \param[in] files Files of the active project that are up to date. */
+  virtual void addFilesUpToDate( const QStringSet& files ) { Q_UNUSED( files ) }
+  /*! Slot that will get called when files must be parsed again.
+   *
+   * The core only keeps the words of the most recently checked files. When
+   * the dictionary changes, the files of which the words were dropped must
+   * be parsed again so that they are checked against the new dictionary.
+   * The parser must ignore the files that it would not parse otherwise.
+   * \param[in] files Files that must be parsed again. */
+  virtual void reparseFiles( const QStringSet& files ) { Q_UNUSED( files ) }
 };
 
 } // namespace SpellChecker
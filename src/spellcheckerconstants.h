@@ -48,6 +48,10 @@ const char SETTING_ONLY_PARSE_CURRENT[]       = "OnlyParseCurrentFile";
 const char SETTING_CHECK_EXTERNAL[]           = "CheckExternal";
 const char PROJECTS_TO_IGNORE[]               = "ProjectsToIgnore";
 const char REPLACE_ALL_FROM_RIGHT_CLICK[]     = "ReplaceAllFromRightClick";
+const char SETTING_PERSIST_SUGGESTIONS[]      = "PersistSuggestions";
+const char SETTING_LAZY_SUGGESTIONS[]         = "LazySuggestions";
+const char SETTING_PERSIST_RESULTS[]          = "PersistResults";
+const char SETTING_WORKER_THREADS[]           = "WorkerThreads";
 const char SETTINGS_OUTPUT_PANE_COL_WORD[]    = "ColWord";
 const char SETTINGS_OUTPUT_PANE_COL_LITERAL[] = "ColLiteral";
 const char SETTINGS_OUTPUT_PANE_COL_LINE[]    = "ColLine";
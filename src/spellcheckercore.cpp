@@ -22,10 +22,12 @@
 #include "ISpellChecker.h"
 #include "NavigationWidget.h"
 #include "outputpane.h"
+#include "ResultCache.h"
 #include "spellcheckerconstants.h"
 #include "spellcheckercore.h"
 #include "spellcheckercoreoptionspage.h"
 #include "spellcheckercoresettings.h"
+#include "SpellCheckerThreadPool.h"
 #include "spellingmistakesmodel.h"
 #include "suggestionsdialog.h"
 
@@ -37,6 +39,7 @@
 #include <coreplugin/actionmanager/actionmanager.h>
 #include <coreplugin/actionmanager/command.h>
 #include <coreplugin/coreconstants.h>
+#include <coreplugin/editormanager/documentmodel.h>
 #include <coreplugin/editormanager/ieditor.h>
 #include <coreplugin/icore.h>
 #include <coreplugin/idocument.h>
@@ -51,14 +54,29 @@
 #include <QFutureWatcher>
 #include <QMenu>
 #include <QMouseEvent>
+#include <QAtomicInteger>
+#include <QCache>
 #include <QMutex>
 #include <QPointer>
 #include <QtConcurrent>
 #include <QTextBlock>
 #include <QTextCursor>
 
-using FutureWatcherMap     = QMap<QFutureWatcher<SpellChecker::WordList>*, QString>;
+/*! \brief File and revision of the words that a future checks. */
+struct FileJob
+{
+  QString fileName;
+  quint64 revision;
+};
+using FutureWatcherMap     = QMap<QFutureWatcher<SpellChecker::WordList>*, FileJob>;
 using FutureWatcherMapIter = FutureWatcherMap::Iterator;
+using SuggestionsHash      = QHash<QString, QStringList>;
+
+/*! Maximum number of words that are kept to check the files again when the
+ * dictionary changes. Each word is roughly 100 bytes, keeping the words in
+ * the order of 20 MB. Files of which the words are no longer kept are
+ * parsed again instead. */
+const int CHECKED_WORDS_MAX_COST = 200000;
 
 class SpellChecker::Internal::SpellCheckerCorePrivate
 {
@@ -80,8 +98,32 @@ public:
   QStringSet filesInStartupProject;
   QMutex futureMutex;
   FutureWatcherMap futureWatchers;
-  QStringList filesInProcess;
-  QHash<QString, WordList> filesWaitingForProcess;
+  QHash<QString, QFutureWatcher<WordList>*> filesInProcess; /*!< Future checking the
+                                                             *  latest words of each file. */
+  QHash<QString, quint64> fileRevisions; /*!< Revision of the latest words of
+                                          *  each file, see supersedeFile(). */
+  quint64 lastRevision = 0;
+  QCache<QString, WordList> checkedWords; /*!< Last words that were spell checked
+                                           *  for the most recently checked files,
+                                           *  used to check them again if the
+                                           *  dictionary changes. */
+  QStringSet filesIgnoringPreviousMistakes; /*!< Files that must not reuse the
+                                             *  suggestions of previous mistakes. */
+  QStringSet filesPendingSuggestions; /*!< Files with mistakes that did not get
+                                       *  suggestions yet. */
+  QFutureWatcher<SuggestionsHash>* suggestionsWatcher = nullptr;
+  SpellCheckerThreadPool threadPool;
+  QAtomicInteger<quint32> dictionaryRevision; /*!< Incremented each time that
+                                               *  the dictionary changes. */
+  ResultCache resultCache; /*!< Words and mistakes of the files in the
+                            *  startup project, kept between sessions. */
+  QFutureWatcher<ResultCache>* resultCacheWatcher = nullptr; /*!< Loads the results
+                                                              *  of the startup project. */
+  QHash<QString, ResultCache::Result> cachedResults; /*!< Loaded results that were
+                                                      *  not restored yet. */
+  QHash<QString, WordList> wordsWaitingForDictionary; /*!< Latest words of the files
+                                                       *  that were received while the
+                                                       *  spell checker was not ready. */
   bool shuttingDown = false;
 
   SpellCheckerCorePrivate()
@@ -90,8 +132,47 @@ public:
     , currentFilePath()
     , startupProject( nullptr )
     , filesInStartupProject()
-  {}
+  {
+    checkedWords.setMaxCost( CHECKED_WORDS_MAX_COST );
+  }
   ~SpellCheckerCorePrivate() {}
+
+  /*! \brief Start a new revision of the words of the \a fileName.
+   *
+   * A future that still checks older words of the file is cancelled, the
+   * spell checker tests for cancellation between batches of words. Its
+   * result would only be replaced by the result of the new words, thus it
+   * is dropped by futureFinished() even if it finished before it could be
+   * cancelled.
+   * \note The futureMutex must be locked when calling this function.
+   * \return The revision that the new words are tagged with. */
+  quint64 supersedeFile( const QString& fileName )
+  {
+    const quint64 revision = ++lastRevision;
+    fileRevisions.insert( fileName, revision );
+    QFutureWatcher<WordList>* watcher = filesInProcess.take( fileName );
+    if( watcher != nullptr ) {
+      watcher->cancel();
+    }
+    return revision;
+  }
+
+  /*! \brief Keep the \a mistakes of the \a fileName for the next session.
+   *
+   * Mistakes are only kept if they were checked against a known dictionary,
+   * a spell checker that is not ready does not have one. */
+  void persistMistakes( const QString& fileName, const WordList& mistakes )
+  {
+    if( settings->persistResults == false ) {
+      return;
+    }
+    const QString dictionary = spellChecker->dictionaryIdentity();
+    if( ( spellChecker->isReady() == false )
+        || ( dictionary.isEmpty() == true ) ) {
+      return;
+    }
+    resultCache.setMistakes( fileName, dictionary, mistakes );
+  }
 };
 // --------------------------------------------------
 // --------------------------------------------------
@@ -111,6 +192,10 @@ SpellCheckerCore::SpellCheckerCore( QObject* parent )
 
   d->settings = new SpellCheckerCoreSettings();
   d->settings->loadFromSettings( Core::ICore::settings() );
+  d->threadPool.setWorkerCount( d->settings->workerThreads );
+  connect( d->settings, &SpellCheckerCoreSettings::settingsChanged, this, [this]() {
+    d->threadPool.setWorkerCount( d->settings->workerThreads );
+  } );
   d->spellingMistakesModel = new ProjectMistakesModel();
 
   d->mistakesModel = new SpellingMistakesModel( this );
@@ -167,6 +252,9 @@ bool SpellCheckerCore::addDocumentParser( IDocumentParser* parser )
     connect( this,   &SpellCheckerCore::activeProjectChanged, parser, &IDocumentParser::setActiveProject );
     connect( this,   &SpellCheckerCore::projectFilesChanged,  parser, &IDocumentParser::updateProjectFiles );
     connect( parser, &IDocumentParser::spellcheckWordsParsed, this,   &SpellCheckerCore::spellcheckWordsFromParser, Qt::QueuedConnection );
+    /* Parsers emit checked words from the main thread once they are done,
+     * they are handled right away without queueing them again. */
+    connect( parser, &IDocumentParser::spellcheckWordsChecked, this,  &SpellCheckerCore::spellcheckWordsCheckedByParser );
     return true;
   }
   return false;
@@ -183,6 +271,7 @@ void SpellCheckerCore::removeDocumentParser( IDocumentParser* parser )
   disconnect( this,   &SpellCheckerCore::activeProjectChanged, parser, &IDocumentParser::setActiveProject );
   disconnect( this,   &SpellCheckerCore::projectFilesChanged,  parser, &IDocumentParser::updateProjectFiles );
   disconnect( parser, &IDocumentParser::spellcheckWordsParsed, this,   &SpellCheckerCore::spellcheckWordsFromParser );
+  disconnect( parser, &IDocumentParser::spellcheckWordsChecked, this,  &SpellCheckerCore::spellcheckWordsCheckedByParser );
   /* Remove the parser from the Core. The removeOne() function is used since
    * the check in the addDocumentParser() would prevent the list from having
    * more than one occurrence of the parser in the list of parsers */
@@ -195,6 +284,8 @@ void SpellCheckerCore::addMisspelledWords( const QString& fileName, const WordLi
   d->spellingMistakesModel->insertSpellingMistakes( fileName, words, d->filesInStartupProject.contains( fileName ) );
   if( d->currentFilePath == fileName ) {
     d->mistakesModel->setCurrentSpellingMistakes( words );
+    /* The mistakes are visible, make sure that they get suggestions. */
+    requestSuggestions( fileName );
   }
 
   /* Only apply the underlines to the current file. This is done so that if the
@@ -221,7 +312,7 @@ void SpellCheckerCore::addMisspelledWords( const QString& fileName, const WordLi
   selections.reserve( words.size() );
   const WordList::ConstIterator wordsEnd = words.constEnd();
   for( WordList::ConstIterator wordIter = words.constBegin(); wordIter != wordsEnd; ++wordIter ) {
-    const Word& word = wordIter.value();
+    const Word& word = *wordIter;
     /* Get the QTextBlock for the line that the misspelled word is on.
      * The QTextDocument manages lines as blocks (in most cases).
      * The lineNumber of the misspelled word is 1 based (seen in the editor)
@@ -258,6 +349,7 @@ void SpellCheckerCore::addMisspelledWords( const QString& fileName, const WordLi
     selections.append( selection );
   }
   editorWidget->setExtraSelections( Utils::Id( SpellChecker::Constants::SPELLCHECK_MISTAKE_ID ), selections );
+  emit mistakesShown( fileName );
 
   /* The model updated, check if the word under the cursor is now a mistake
    * and notify the rest of the checker with this information. */
@@ -315,7 +407,34 @@ void SpellCheckerCore::setSpellChecker( ISpellChecker* spellChecker )
     d->addedSpellCheckers.insert( spellChecker->name(), spellChecker );
   }
 
+  if( d->spellChecker == spellChecker ) {
+    return;
+  }
+
+  ISpellChecker* previousSpellChecker = d->spellChecker;
+  if( previousSpellChecker != nullptr ) {
+    disconnect( previousSpellChecker, &ISpellChecker::dictionaryUpdated, this, &SpellCheckerCore::dictionaryUpdated );
+    disconnect( previousSpellChecker, &ISpellChecker::ready,             this, &SpellCheckerCore::spellCheckerReady );
+  }
   d->spellChecker = spellChecker;
+  connect( d->spellChecker, &ISpellChecker::dictionaryUpdated, this, &SpellCheckerCore::dictionaryUpdated, Qt::QueuedConnection );
+  connect( d->spellChecker, &ISpellChecker::ready,             this, &SpellCheckerCore::spellCheckerReady, Qt::QueuedConnection );
+  if( previousSpellChecker != nullptr ) {
+    /* Check all files again with the new spell checker. */
+    dictionaryUpdated();
+  }
+}
+// --------------------------------------------------
+
+quint32 SpellCheckerCore::dictionaryRevision() const
+{
+  return d->dictionaryRevision.loadAcquire();
+}
+// --------------------------------------------------
+
+SpellCheckerThreadPool* SpellCheckerCore::threadPool() const
+{
+  return &d->threadPool;
 }
 // --------------------------------------------------
 
@@ -329,60 +448,189 @@ void SpellCheckerCore::spellcheckWordsFromParser( const QString& fileName, const
     /* Shutting down, no need to do anything further. */
     return;
   }
+  /* Keep the words so that they can be checked again if the dictionary
+   * changes, without the need to parse the file again. */
+  d->checkedWords.insert( fileName, new WordList( words ), words.size() );
+  rememberWords( qobject_cast<IDocumentParser*>( sender() ), fileName, words );
+
+  /* These are the latest words of the file. If a QFuture is still checking
+   * older words of the file it is cancelled, instead of letting it finish and
+   * only then checking the new words. While typing, the words of the text
+   * that no longer exists are then not checked any further and the new words
+   * are checked right away. */
+  const quint64 revision = d->supersedeFile( fileName );
+  /* A spell checker that is still loading its dictionary would report all
+   * words as correct. The words are checked once it is ready, see
+   * spellCheckerReady(). */
+  if( d->spellChecker->isReady() == false ) {
+    d->wordsWaitingForDictionary.insert( fileName, words );
+    return;
+  }
+  d->wordsWaitingForDictionary.remove( fileName );
+  /* Get the list of mistakes that were extracted on the file during the last
+   * run of the processing. */
+  WordList previousMistakes;
+  if( d->filesIgnoringPreviousMistakes.remove( fileName ) == false ) {
+    previousMistakes = d->spellingMistakesModel->mistakesForFile( fileName );
+  }
+  /* If suggestions are only needed for visible mistakes, they are only
+   * looked up for the current file. Other files are marked so that the
+   * suggestions can be looked up when they become visible. */
+  const bool fetchSuggestions = ( ( fileName == d->currentFilePath )
+                                  || ( d->settings->lazySuggestions == false ) );
+  if( fetchSuggestions == true ) {
+    d->filesPendingSuggestions.remove( fileName );
+  } else {
+    d->filesPendingSuggestions.insert( fileName );
+  }
+  /* Create a processor and start processing the spelling mistakes in the
+   * background using QtConcurrent and a QFuture. */
+  SpellCheckProcessor* processor    = new SpellCheckProcessor( d->spellChecker, fileName, words, previousMistakes, fetchSuggestions );
+  QFutureWatcher<WordList>* watcher = new QFutureWatcher<WordList>();
+  connect( watcher, &QFutureWatcher<WordList>::finished, this, &SpellCheckerCore::futureFinished, Qt::QueuedConnection );
+  /* Keep track of the watchers that are busy and the file and revision that
+   * it is working on. Since all QFuterWatchers are connected to the same slot,
+   * this map is used to map the correct watcher to the correct file. */
+  d->futureWatchers.insert( watcher, { fileName, revision } );
+  /* The watcher of the latest words of each file is also kept by file, so
+   * that it can be cancelled without searching the above map. */
+  d->filesInProcess.insert( fileName, watcher );
+  /* Make sure that the processor gets cleaned up after it has finished processing
+   * the words. */
+  connect( watcher, &QFutureWatcher<WordList>::finished, processor, &SpellCheckProcessor::deleteLater );
+
+  /* Create a future to process the file.
+   * If the file to process is the current open editor, it is processed in the
+   * interactive lane with high priority.
+   * If it is not the current file, it is added to the bulk lane since it can
+   * get processed in its own time.
+   * The current one gets its own lane so that it can get processed as
+   * soon as possible and it does not need to get queued along with all other
+   * futures of the project. */
+  if( fileName == d->currentFilePath ) {
+    QFuture<WordList> future = Utils::runAsync( d->threadPool.pool( SpellCheckerThreadPool::Lane::Interactive ), QThread::HighPriority, &SpellCheckProcessor::process, processor );
+    watcher->setFuture( future );
+  } else {
+    QFuture<WordList> future = Utils::runAsync( d->threadPool.pool( SpellCheckerThreadPool::Lane::Bulk ), QThread::LowPriority, &SpellCheckProcessor::process, processor );
+    watcher->setFuture( future );
+  }
+}
+// --------------------------------------------------
+
+void SpellCheckerCore::spellcheckWordsCheckedByParser( const QString& fileName, const WordList& words, const WordList& mistakes, quint32 dictionaryRevision )
+{
+  QMutexLocker locker( &d->futureMutex );
+  if( d->shuttingDown == true ) {
+    return;
+  }
+  if( dictionaryRevision != d->dictionaryRevision.loadAcquire() ) {
+    /* The mistakes are from an older dictionary, check the words again. */
+    locker.unlock();
+    spellcheckWordsFromParser( fileName, words );
+    return;
+  }
+  /* A future of the core that still checks older words of the file must not
+   * replace these mistakes when it finishes. */
+  d->supersedeFile( fileName );
+  d->wordsWaitingForDictionary.remove( fileName );
+  d->checkedWords.insert( fileName, new WordList( words ), words.size() );
+  d->filesIgnoringPreviousMistakes.remove( fileName );
+  rememberWords( qobject_cast<IDocumentParser*>( sender() ), fileName, words );
+  d->persistMistakes( fileName, mistakes );
+  const bool hasAllSuggestions = std::all_of( mistakes.begin(), mistakes.end(), []( const Word& word ) {
+    return ( word.suggestions.isEmpty() == false );
+  } );
+  if( hasAllSuggestions == true ) {
+    d->filesPendingSuggestions.remove( fileName );
+  } else {
+    d->filesPendingSuggestions.insert( fileName );
+  }
+  locker.unlock();
+  addMisspelledWords( fileName, mistakes );
+}
+// --------------------------------------------------
 
-  /* Check if this file is not already being processed by QtConcurrent in the
-   * background. The current implementation will only use one QFuter per file
-   * and if spell checking is requested for the same file if it is already being
-   * spell checked, the file will get added to a list that will only be checked
-   * if the current QFuture completes. This prevents possible redundant spell checking
-   * but can result in a bit of a latency to update new words. It will however reduce
-   * the amount of processing, especially if code is edited, and not comments and
-   * literals. */
-  if( d->filesInProcess.contains( fileName ) == true ) {
-    /* There is already a QFuture out for the given file. Add it to the list of
-     * of waiting files and replace the current set of words with the latest ones.
-     * The assumption is that the last call to this function will always contain
-     * the latest words that should be spell checked. */
-    d->filesWaitingForProcess[fileName] = words;
+void SpellCheckerCore::rememberWords( IDocumentParser* parser, const QString& fileName, const WordList& words )
+{
+  /* Keep the words for the next session if they came from a parser. Words of
+   * documents with changes that are not saved do not match the file. */
+  if( ( parser == nullptr )
+      || ( d->settings->persistResults == false ) ) {
+    return;
+  }
+  Core::IDocument* document = Core::DocumentModel::documentForFilePath( Utils::FilePath::fromString( fileName ) );
+  if( ( document != nullptr )
+      && ( document->isModified() == true ) ) {
+    d->resultCache.remove( fileName );
   } else {
-    /* Get the list of mistakes that were extracted on the file during the last
-     * run of the processing. */
-    WordList previousMistakes = d->spellingMistakesModel->mistakesForFile( fileName );
-    /* There is no background process processing the words for the given file.
-     * Create a processor and start processing the spelling mistakes in the
-     * background using QtConcurrent and a QFuture. */
-    SpellCheckProcessor* processor    = new SpellCheckProcessor( d->spellChecker, fileName, words, previousMistakes );
-    QFutureWatcher<WordList>* watcher = new QFutureWatcher<WordList>();
-    connect( watcher, &QFutureWatcher<WordList>::finished, this, &SpellCheckerCore::futureFinished, Qt::QueuedConnection );
-    /* Keep track of the watchers that are busy and the file that it is working on.
-     * Since all QFuterWatchers are connected to the same slot, this map is used
-     * to map the correct watcher to the correct file. */
-    d->futureWatchers.insert( watcher, fileName );
-    /* This is just a convenience list to speed up checking if a file is getting
-     * processed already. An alternative would be to iterate through the above map
-     * and check where the value matches the file. This can be slow especially if
-     * there are multiple watchers running. The separate list can use indexing and
-     * other search technicians compared to the mentioned iteration search. */
-    d->filesInProcess.append( fileName );
-    /* Make sure that the processor gets cleaned up after it has finished processing
-     * the words. */
-    connect( watcher, &QFutureWatcher<WordList>::finished, processor, &SpellCheckProcessor::deleteLater );
-
-    /* Create a future to process the file.
-     * If the file to process is the current open editor, it is processed in a new
-     * thread with high priority.
-     * If it is not the current file, it is added to the global thread pool
-     * since it can get processed in its own time.
-     * The current one gets a new thread so that it can get processed as
-     * soon as possible and it does not need to get queued along with all other
-     * futures added to the global thread pool. */
-    if( fileName == d->currentFilePath ) {
-      QFuture<WordList> future = Utils::runAsync( QThread::HighPriority, &SpellCheckProcessor::process, processor );
-      watcher->setFuture( future );
-    } else {
-      QFuture<WordList> future = Utils::runAsync( QThreadPool::globalInstance(), QThread::LowPriority, &SpellCheckProcessor::process, processor );
-      watcher->setFuture( future );
+    d->resultCache.setWords( fileName, parser->displayName(), parser->settingsIdentity(), words );
+  }
+}
+// --------------------------------------------------
+
+void SpellCheckerCore::dictionaryUpdated()
+{
+  /* Results that parsers checked against the old dictionary must be
+   * checked again. */
+  d->dictionaryRevision.fetchAndAddOrdered( 1 );
+  if( d->shuttingDown == true ) {
+    return;
+  }
+  /* The dictionary changed, check the words of all files again using the
+   * new dictionary. The words from the last parse of a file are used if
+   * they are still kept, thus those files do not need to be parsed again.
+   * The suggestions of the previous mistakes were made with the old
+   * dictionary and are not reused. */
+  const QList<QString> keptFiles = d->checkedWords.keys();
+  for( const QString& fileName: keptFiles ) {
+    const WordList* words = d->checkedWords.object( fileName );
+    if( words == nullptr ) {
+      continue;
     }
+    /* The words are copied since checking them replaces the kept list. */
+    const WordList wordsCopy = *words;
+    d->filesIgnoringPreviousMistakes.insert( fileName );
+    spellcheckWordsFromParser( fileName, wordsCopy );
+  }
+  /* The words of the other files were dropped to bound the memory, those
+   * files must be parsed again. The parsers only parse the files that they
+   * would normally parse. */
+  QStringSet filesToReparse = d->filesInStartupProject;
+  if( d->currentFilePath.isEmpty() == false ) {
+    filesToReparse.insert( d->currentFilePath );
+  }
+  for( const QString& fileName: keptFiles ) {
+    filesToReparse.remove( fileName );
+  }
+  if( filesToReparse.isEmpty() == true ) {
+    return;
+  }
+  d->filesIgnoringPreviousMistakes.unite( filesToReparse );
+  for( const QPointer<IDocumentParser>& parser: qAsConst( d->documentParsers ) ) {
+    if( parser.isNull() == false ) {
+      parser->reparseFiles( filesToReparse );
+    }
+  }
+}
+// --------------------------------------------------
+
+void SpellCheckerCore::spellCheckerReady()
+{
+  if( ( d->shuttingDown == true )
+      || ( d->spellChecker == nullptr )
+      || ( d->spellChecker->isReady() == false ) ) {
+    return;
+  }
+  /* Restore the results of the previous session first, files that got
+   * words while waiting for the spell checker are not restored since
+   * their words are newer. */
+  restoreCachedResults( d->filesInStartupProject );
+  /* The words were already kept and remembered when they were received,
+   * only the checking itself was deferred. */
+  QHash<QString, WordList> waiting;
+  waiting.swap( d->wordsWaitingForDictionary );
+  for( QHash<QString, WordList>::const_iterator iter = waiting.constBegin(); iter != waiting.constEnd(); ++iter ) {
+    spellcheckWordsFromParser( iter.key(), iter.value() );
   }
 }
 // --------------------------------------------------
@@ -401,54 +649,128 @@ void SpellCheckerCore::futureFinished()
     /* Application shutting down, should not try something */
     return;
   }
-  if( watcher->isCanceled() == true ) {
-    /* Application is shutting down */
-    return;
-  }
-  /* Get the list of words with spelling mistakes from the future. */
-  WordList checkedWords = watcher->result();
   QMutexLocker locker( &d->futureMutex );
   /* Recheck again after getting the lock. */
   if( d->shuttingDown == true ) {
     return;
   }
-  /* Get the file name associated with this future and the misspelled
-   * words. */
+  /* Get the file name and revision associated with this future. */
   FutureWatcherMapIter iter = d->futureWatchers.find( watcher );
   if( iter == d->futureWatchers.end() ) {
     return;
   }
-  QString fileName = iter.value();
-  /* Remove the watcher from the list of running watchers and the file that
-   * kept track of the file getting spell checked. */
+  const FileJob job = iter.value();
+  /* Remove the watcher from the list of running watchers. */
   d->futureWatchers.erase( iter );
-  d->filesInProcess.removeAll( fileName );
-  /* Check if the file was scheduled for a re-check. As discussed previously,
-   * if a spell check was requested for a file that had a future already in
-   * progress, it was scheduled for a re-check as soon as the in progress one
-   * completes. If it was scheduled, restart it using the normal slot. */
-  QHash<QString, WordList>::iterator waitingIter = d->filesWaitingForProcess.find( fileName );
-  if( waitingIter != d->filesWaitingForProcess.end() ) {
-    WordList wordsToSpellCheck = waitingIter.value();
-    /* remove the file and words from the scheduled list. */
-    d->filesWaitingForProcess.erase( waitingIter );
-    locker.unlock();
-    /* Invoke the method to make sure that it gets called from the main thread.
-     * This will most probably be already in the main thread, but to make sure
-     * it is done like this. */
-    this->metaObject()->invokeMethod( this
-                                      , "spellcheckWordsFromParser"
-                                      , Qt::QueuedConnection
-                                      , Q_ARG( QString, fileName )
-                                      , Q_ARG( SpellChecker::WordList, wordsToSpellCheck ) );
+  if( d->filesInProcess.value( job.fileName ) == watcher ) {
+    d->filesInProcess.remove( job.fileName );
   }
-  locker.unlock();
   watcher->deleteLater();
+  /* Drop the result if newer words of the file were received since the
+   * future was started, see SpellCheckerCorePrivate::supersedeFile(). Such
+   * a future was cancelled, but it could have finished before that. */
+  if( ( watcher->isCanceled() == true )
+      || ( d->fileRevisions.value( job.fileName ) != job.revision ) ) {
+    return;
+  }
+  const QString fileName = job.fileName;
+  /* Get the list of words with spelling mistakes from the future. */
+  WordList checkedWords = watcher->result();
+  d->persistMistakes( fileName, checkedWords );
+  locker.unlock();
   /* Add the list of misspelled words to the mistakes model */
   addMisspelledWords( fileName, checkedWords );
 }
 // --------------------------------------------------
 
+void SpellCheckerCore::requestSuggestions( const QString& fileName )
+{
+  if( ( fileName.isEmpty() == true )
+      || ( d->shuttingDown == true )
+      || ( d->filesPendingSuggestions.contains( fileName ) == false ) ) {
+    return;
+  }
+  /* Only the suggestions for the latest visible file are of interest. */
+  cancelSuggestions();
+
+  const QStringList wordsWithoutSuggestions = d->spellingMistakesModel->wordsWithoutSuggestions( fileName );
+  if( wordsWithoutSuggestions.isEmpty() == true ) {
+    d->filesPendingSuggestions.remove( fileName );
+    return;
+  }
+
+  QFutureWatcher<SuggestionsHash>* watcher = new QFutureWatcher<SuggestionsHash>();
+  d->suggestionsWatcher                    = watcher;
+  connect( watcher, &QFutureWatcher<SuggestionsHash>::finished, this, [this, watcher, fileName]() {
+    suggestionsFinished( watcher, fileName );
+  } );
+  ISpellChecker* spellChecker = d->spellChecker;
+  QFuture<SuggestionsHash> future = Utils::runAsync( d->threadPool.pool( SpellCheckerThreadPool::Lane::Interactive ), QThread::HighPriority, [spellChecker, wordsWithoutSuggestions]( QFutureInterface<SuggestionsHash>& futureInterface ) {
+    SuggestionsHash suggestions;
+    for( const QString& word: wordsWithoutSuggestions ) {
+      if( futureInterface.isCanceled() == true ) {
+        return;
+      }
+      spellChecker->getSuggestionsForWord( word, suggestions[word] );
+    }
+    futureInterface.reportResult( suggestions );
+  } );
+  watcher->setFuture( future );
+}
+// --------------------------------------------------
+
+void SpellCheckerCore::suggestionsFinished( QFutureWatcher<QHash<QString, QStringList>>* watcher, const QString& fileName )
+{
+  watcher->deleteLater();
+  if( ( watcher != d->suggestionsWatcher )
+      || ( watcher->isCanceled() == true )
+      || ( d->shuttingDown == true ) ) {
+    return;
+  }
+  d->suggestionsWatcher = nullptr;
+  if( watcher->future().resultCount() == 0 ) {
+    return;
+  }
+  const SuggestionsHash suggestions = watcher->result();
+  /* Get the latest mistakes for the file, they might have changed while the
+   * suggestions were looked up. Words that did not exist when the lookup
+   * started will not get suggestions, these are picked up again below. */
+  WordList mistakes      = d->spellingMistakesModel->mistakesForFile( fileName );
+  bool allHaveSuggestion = true;
+  for( WordList::Iterator iter = mistakes.begin(); iter != mistakes.end(); ++iter ) {
+    Word& word = *iter;
+    if( word.suggestions.isEmpty() == false ) {
+      continue;
+    }
+    SuggestionsHash::ConstIterator suggestionIter = suggestions.constFind( word.text );
+    if( suggestionIter != suggestions.constEnd() ) {
+      word.suggestions = suggestionIter.value();
+    } else {
+      allHaveSuggestion = false;
+    }
+  }
+  if( allHaveSuggestion == true ) {
+    d->filesPendingSuggestions.remove( fileName );
+  }
+  d->persistMistakes( fileName, mistakes );
+  /* Update the models and the underlines with the suggestions. If there are
+   * still words without suggestions, and the file is still visible, this
+   * will request them again. */
+  addMisspelledWords( fileName, mistakes );
+}
+// --------------------------------------------------
+
+void SpellCheckerCore::cancelSuggestions()
+{
+  if( d->suggestionsWatcher == nullptr ) {
+    return;
+  }
+  /* The watcher deletes itself when the future finishes, see suggestionsFinished(). */
+  d->suggestionsWatcher->cancel();
+  d->suggestionsWatcher = nullptr;
+}
+// --------------------------------------------------
+
 void SpellCheckerCore::cancelFutures()
 {
   QMutexLocker lock( &d->futureMutex );
@@ -464,6 +786,8 @@ void SpellCheckerCore::cancelFutures()
     delete iter.key();
   }
   d->futureWatchers.clear();
+  d->filesInProcess.clear();
+  d->fileRevisions.clear();
 }
 
 // --------------------------------------------------
@@ -476,7 +800,11 @@ void SpellCheckerCore::aboutToQuit()
   d->shuttingDown   = true;
   d->startupProject = nullptr;
   disconnect( this );
+  cancelSuggestions();
   cancelFutures();
+  if( d->settings->persistResults == true ) {
+    d->resultCache.save();
+  }
 }
 // --------------------------------------------------
 
@@ -507,24 +835,10 @@ bool SpellCheckerCore::isWordUnderCursorMistake( Word& word ) const
   int32_t column           = d->currentEditor->currentColumn();
   int32_t line             = d->currentEditor->currentLine();
   QString  currentFileName = d->currentEditor->document()->filePath().toString();
-  WordList wl;
-  wl = d->spellingMistakesModel->mistakesForFile( currentFileName );
-  if( wl.isEmpty() == true ) {
-    return false;
-  }
-  WordList::ConstIterator iter          = wl.constBegin();
-  const WordList::ConstIterator iterEnd = wl.constEnd();
-  while( iter != iterEnd ) {
-    const Word& currentWord = iter.value();
-    if( ( currentWord.lineNumber == line )
-        && ( ( currentWord.columnNumber <= column )
-             && ( ( currentWord.columnNumber + currentWord.length ) >= column ) ) ) {
-      word = currentWord;
-      return true;
-    }
-    ++iter;
-  }
-  return false;
+  /* If the suggestions of the file are still looked up in the background
+   * the word has none yet. The mistakes get updated when the lookup is
+   * done, which also notifies the word under the cursor again. */
+  return d->spellingMistakesModel->mistakeAt( currentFileName, line, column, word );
 }
 // --------------------------------------------------
 
@@ -533,22 +847,10 @@ bool SpellCheckerCore::getAllOccurrencesOfWord( const Word& word, WordList& word
   if( d->currentEditor.isNull() == true ) {
     return false;
   }
-  WordList wl;
-  QString  currentFileName = d->currentEditor->document()->filePath().toString();
-  wl = d->spellingMistakesModel->mistakesForFile( currentFileName );
-  if( wl.isEmpty() == true ) {
-    return false;
-  }
-  WordList::ConstIterator iter = wl.constBegin();
-  while( iter != wl.constEnd() ) {
-    const Word& currentWord = iter.value();
-    if( currentWord.text == word.text ) {
-      words.append( currentWord );
-    }
-    ++iter;
-  }
-  return ( wl.count() > 0 );
-
+  QString currentFileName    = d->currentEditor->document()->filePath().toString();
+  const WordList occurrences = d->spellingMistakesModel->mistakesOfWord( currentFileName, word.text );
+  words.append( occurrences );
+  return ( occurrences.isEmpty() == false );
 }
 // --------------------------------------------------
 
@@ -623,6 +925,14 @@ void SpellCheckerCore::cursorPositionChanged()
   /* Check if the cursor is over a spelling mistake */
   Word word;
   bool wordIsMisspelled = isWordUnderCursorMistake( word );
+  /* The suggestions of the mistake are needed for the actions on the word.
+   * If the lookup of the suggestions for the file was cancelled, start it
+   * again in the background, a lookup that is still running is kept. */
+  if( ( wordIsMisspelled == true )
+      && ( word.suggestions.isEmpty() == true )
+      && ( d->suggestionsWatcher == nullptr ) ) {
+    requestSuggestions( d->currentFilePath );
+  }
   emit wordUnderCursorMistake( wordIsMisspelled, word );
 }
 // --------------------------------------------------
@@ -657,6 +967,9 @@ void SpellCheckerCore::removeWordUnderCursor( RemoveAction action )
   }
 
   if( wordRemoved == true ) {
+    /* Results that were checked before the word was added, by the parsers or
+     * kept by them for shared tokens, must not be used. */
+    d->dictionaryRevision.fetchAndAddOrdered( 1 );
     /* Remove all occurrences of the removed word. This removes the need to
      * re-parse the whole project, it will be a lot faster doing this.  */
     d->spellingMistakesModel->removeAllOccurrences( word.text );
@@ -719,9 +1032,23 @@ void SpellCheckerCore::startupProjectChanged( ProjectExplorer::Project* startupP
 {
   /* Cancel all outstanding futures */
   cancelFutures();
+  cancelSuggestions();
+  d->filesPendingSuggestions.clear();
+  d->checkedWords.clear();
+  d->filesIgnoringPreviousMistakes.clear();
   d->spellingMistakesModel->clearAllSpellingMistakes();
   d->filesInStartupProject.clear();
-  d->startupProject = startupProject;
+  /* Keep the results of the previous project for the next time that it
+   * is opened. */
+  if( d->settings->persistResults == true ) {
+    d->resultCache.save();
+  }
+  d->resultCache.clear();
+  d->cachedResults.clear();
+  /* A load that is still running is for the previous project, its result is
+   * ignored when it finishes, see resultCacheLoaded(). */
+  d->resultCacheWatcher = nullptr;
+  d->startupProject     = startupProject;
   if( startupProject != nullptr ) {
     /* Check if the current project is not set to be ignored by the settings. */
     if( d->settings->projectsToIgnore.contains( startupProject->displayName() ) == false ) {
@@ -731,10 +1058,119 @@ void SpellCheckerCore::startupProjectChanged( ProjectExplorer::Project* startupP
       d->startupProject = nullptr;
     }
   }
+  /* Load the results of the previous session in the background. Reading
+   * them, and hashing the files that changed on disk, can take a while for
+   * large projects. The results of the files that did not change are
+   * restored when the load finished, and for files that are only added to
+   * the project later, when they get added. The load runs in the bulk lane
+   * so that it does not hold up the checking of the current editor. */
+  if( ( d->startupProject != nullptr )
+      && ( d->settings->persistResults == true ) ) {
+    const QString projectFile = d->startupProject->projectFilePath().toString();
+    d->resultCache.setProjectFile( projectFile );
+    QFutureWatcher<ResultCache>* watcher = new QFutureWatcher<ResultCache>();
+    d->resultCacheWatcher                = watcher;
+    connect( watcher, &QFutureWatcher<ResultCache>::finished, this, [this, watcher]() {
+      resultCacheLoaded( watcher );
+    } );
+    QFuture<ResultCache> future = Utils::runAsync( d->threadPool.pool( SpellCheckerThreadPool::Lane::Bulk ), QThread::LowPriority, [projectFile]( QFutureInterface<ResultCache>& futureInterface ) {
+      ResultCache cache;
+      cache.load( projectFile );
+      futureInterface.reportResult( cache );
+    } );
+    watcher->setFuture( future );
+  }
   emit activeProjectChanged( startupProject );
 }
 // --------------------------------------------------
 
+void SpellCheckerCore::resultCacheLoaded( QFutureWatcher<ResultCache>* watcher )
+{
+  watcher->deleteLater();
+  if( ( watcher != d->resultCacheWatcher )
+      || ( d->shuttingDown == true ) ) {
+    return;
+  }
+  d->resultCacheWatcher = nullptr;
+  if( watcher->future().resultCount() == 0 ) {
+    return;
+  }
+  const ResultCache loaded = watcher->result();
+  if( loaded.projectFile() != d->resultCache.projectFile() ) {
+    return;
+  }
+  /* Results of files that were saved in this session are newer than the
+   * loaded ones, those files are not restored. */
+  const QStringList added                           = d->resultCache.merge( loaded );
+  const QHash<QString, ResultCache::Result> results = loaded.results();
+  for( const QString& fileName: added ) {
+    const QHash<QString, ResultCache::Result>::const_iterator iter = results.constFind( fileName );
+    if( iter != results.constEnd() ) {
+      d->cachedResults.insert( fileName, iter.value() );
+    }
+  }
+  restoreCachedResults( d->filesInStartupProject );
+}
+// --------------------------------------------------
+
+void SpellCheckerCore::restoreCachedResults( const QStringSet& files )
+{
+  /* The results can only be compared to the dictionary once it is known.
+   * Until the spell checker is ready the results are kept, they are
+   * restored by spellCheckerReady(). */
+  if( ( d->cachedResults.isEmpty() == true )
+      || ( d->spellChecker == nullptr )
+      || ( d->spellChecker->isReady() == false ) ) {
+    return;
+  }
+  const QString dictionary = d->spellChecker->dictionaryIdentity();
+  if( dictionary.isEmpty() == true ) {
+    return;
+  }
+  QHash<IDocumentParser*, QStringSet> filesUpToDate;
+  for( const QString& fileName: files ) {
+    const QHash<QString, ResultCache::Result>::iterator cachedIter = d->cachedResults.find( fileName );
+    if( cachedIter == d->cachedResults.end() ) {
+      continue;
+    }
+    const ResultCache::Result result = cachedIter.value();
+    d->cachedResults.erase( cachedIter );
+    {
+      /* A file that got words in this session already has newer results. */
+      QMutexLocker locker( &d->futureMutex );
+      if( d->fileRevisions.contains( fileName ) == true ) {
+        continue;
+      }
+    }
+    if( result.dictionary != dictionary ) {
+      continue;
+    }
+    const auto parserIter = std::find_if( d->documentParsers.cbegin(), d->documentParsers.cend(), [&result]( const QPointer<IDocumentParser>& parser ) {
+      return ( parser.isNull() == false )
+             && ( parser->displayName() == result.parser )
+             && ( parser->settingsIdentity() == result.settings );
+    } );
+    if( parserIter == d->documentParsers.cend() ) {
+      continue;
+    }
+    filesUpToDate[parserIter->data()].insert( fileName );
+    d->checkedWords.insert( fileName, new WordList( result.words ), result.words.size() );
+    const bool hasAllSuggestions = std::all_of( result.mistakes.begin(), result.mistakes.end(), []( const Word& word ) {
+      return ( word.suggestions.isEmpty() == false );
+    } );
+    if( hasAllSuggestions == false ) {
+      d->filesPendingSuggestions.insert( fileName );
+    }
+    addMisspelledWords( fileName, result.mistakes );
+  }
+  /* Let the parsers know which files do not have to be parsed, files that
+   * they did not parse yet are then skipped. */
+  for( QHash<IDocumentParser*, QStringSet>::const_iterator iter = filesUpToDate.constBegin(); iter != filesUpToDate.constEnd(); ++iter ) {
+    iter.key()->addFilesUpToDate( iter.value() );
+  }
+}
+// --------------------------------------------------
+
 void SpellCheckerCore::fileListChanged()
 {
   if( d->startupProject == nullptr ) {
@@ -768,6 +1204,15 @@ void SpellCheckerCore::fileListChanged()
   } );
 
   d->filesInStartupProject = newFiles;
+  for( const QString& file: removed ) {
+    d->checkedWords.remove( file );
+    d->filesIgnoringPreviousMistakes.remove( file );
+    d->resultCache.remove( file );
+  }
+  /* The project is often not complete yet when it becomes the startup
+   * project, restore the results of the files as they get added. This is
+   * done before the parsers get the files so that they can skip them. */
+  restoreCachedResults( added );
   /* Must let the model know about the changes since it is interested */
   d->spellingMistakesModel->projectFilesChanged( added, removed );
 
@@ -790,6 +1235,13 @@ void SpellCheckerCore::mangerEditorChanged( Core::IEditor* editor )
     wl = d->spellingMistakesModel->mistakesForFile( d->currentFilePath );
   }
   d->mistakesModel->setCurrentSpellingMistakes( wl );
+  /* If the file was checked in the background without suggestions, get
+   * them now that its mistakes are visible. */
+  if( d->filesPendingSuggestions.contains( d->currentFilePath ) == true ) {
+    requestSuggestions( d->currentFilePath );
+  } else {
+    cancelSuggestions();
+  }
 }
 // --------------------------------------------------
 
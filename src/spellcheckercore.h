@@ -25,6 +25,7 @@
 #include <coreplugin/editormanager/editormanager.h>
 #include <projectexplorer/project.h>
 
+#include <QFutureWatcher>
 #include <QObject>
 #include <QSettings>
 
@@ -38,7 +39,9 @@ class SpellCheckerCorePrivate;
 class OutputPane;
 class SpellCheckerCoreSettings;
 class ProjectMistakesModel;
+class ResultCache;
 } // namespace Internal
+class SpellCheckerThreadPool;
 class IDocumentParser;
 class ISpellChecker;
 
@@ -98,6 +101,17 @@ public:
    * \sa addSpellChecker()
    * \sa spellChecker() */
   void setSpellChecker( ISpellChecker* spellChecker );
+  /*! \brief Get the revision of the dictionary of the spell checker.
+   *
+   * The revision changes each time that the spell checker or its dictionary
+   * changes. Parsers that check words themselves pass the revision that was
+   * current when they started along with the mistakes, so that results that
+   * were checked against an old dictionary can be checked again.
+   * This function is thread safe. */
+  quint32 dictionaryRevision() const;
+  /*! \brief Get the threads that the spell checker and parsers must use for
+   * their background work. */
+  SpellCheckerThreadPool* threadPool() const;
 
   Core::IOptionsPage* optionsPage();
   /*! \brief Get the Core Settings. */
@@ -136,6 +150,33 @@ private:
    * \param[in] action Action to use to remove the word.
    */
   void removeWordUnderCursor( RemoveAction action );
+  /*! \brief Keep the words from the \a parser for the next session, if enabled. */
+  void rememberWords( IDocumentParser* parser, const QString& fileName, const WordList& words );
+  /*! \brief Request suggestions for the mistakes in the file.
+   *
+   * If the file was spell checked without getting suggestions for the
+   * misspelled words, the suggestions are looked up in the background and
+   * the mistakes get updated when done. Only one file is looked up at a time,
+   * requesting suggestions for another file cancels the current lookup.
+   * \param[in] fileName File that needs suggestions for its mistakes.
+   */
+  void requestSuggestions( const QString& fileName );
+  /*! \brief Called when the background lookup of suggestions finished. */
+  void suggestionsFinished( QFutureWatcher<QHash<QString, QStringList>>* watcher, const QString& fileName );
+  /*! \brief Cancel the background lookup of suggestions if one is running. */
+  void cancelSuggestions();
+  /*! \brief Called when the results of the previous session of the startup
+   * project were loaded in the background. */
+  void resultCacheLoaded( QFutureWatcher<Internal::ResultCache>* watcher );
+  /*! \brief Restore the loaded results of the \a files.
+   *
+   * Only files that are in the startup project and that did not get new
+   * words in this session are restored. Results of files that are not in
+   * the project yet are kept, so that they can be restored once the files
+   * are added to the project. Nothing is restored while the spell checker is
+   * not ready, since the dictionary of the results can not be compared yet.
+   * \param[in] files Files that are in, or were added to, the startup project. */
+  void restoreCachedResults( const QStringSet& files );
 
 signals:
   /*! \brief Signal emitted to inform the plugin if the word under the cursor is a mistake.
@@ -171,6 +212,10 @@ signals:
    * \param filesRemoved List of files removed from the project since the last
    *     notification. */
   void projectFilesChanged( QStringSet filesAdded, QStringSet filesRemoved );
+  /*! \brief Signal emitted once the mistakes of the current editor were
+   * underlined in the editor.
+   * \param fileName Name of the file of the current editor. */
+  void mistakesShown( const QString& fileName );
 
 public slots:
   /*! \brief Open the suggestions widget for the word under the cursor. */
@@ -200,10 +245,27 @@ private slots:
    * will relay the words to the set spellchecker that will then spell
    * check the words and give suggestions for misspelled words.
    *
+   * Each call starts a new revision of the words of the file. A future that
+   * still checks older words of the file is cancelled and its result is
+   * dropped, so that only the mistakes of the latest words reach the model.
+   *
    * \param[in] fileName Name of the file that the words belong to.
    * \param[in] words List of words that must be checked for spelling mistakes.
    */
   void spellcheckWordsFromParser( const QString& fileName, const SpellChecker::WordList& words );
+  /*! \brief Words and mistakes from a parser that also checked the words.
+   *
+   * The mistakes are used as they are, unless they were checked against an
+   * older dictionary. In that case the words are checked again using
+   * spellcheckWordsFromParser(). A future that still checks older words of
+   * the file is cancelled.
+   *
+   * \param[in] fileName Name of the file that the words belong to.
+   * \param[in] words Words of the file that were checked.
+   * \param[in] mistakes Misspelled words of the file.
+   * \param[in] dictionaryRevision Revision of the dictionary that the words were checked against.
+   */
+  void spellcheckWordsCheckedByParser( const QString& fileName, const SpellChecker::WordList& words, const SpellChecker::WordList& mistakes, quint32 dictionaryRevision );
   /*! \brief Slot called when the Qt Creator Startup or active project changes. */
   void startupProjectChanged( ProjectExplorer::Project* startupProject );
   /*! \brief Slot called when the files in the project changes. */
@@ -230,6 +292,18 @@ private slots:
   /*! \brief Slot called when a Future is finished checking the spelling of potential
    * words. */
   void futureFinished();
+  /*! \brief Slot called when the dictionary of the spell checker changed.
+   *
+   * All files that were checked are checked again using the words from
+   * the last time that the file was parsed. */
+  void dictionaryUpdated();
+  /*! \brief Slot called when the spell checker becomes ready.
+   *
+   * The results of the previous session are restored, and the words that
+   * were received while the spell checker was not ready are checked now.
+   * This is not handled as a change of the dictionary, thus the restored
+   * files are not checked again. */
+  void spellCheckerReady();
   /*! \brief Slot called when the application quits to cancel all outstanding futures. */
   void cancelFutures();
   /*! \brief Slot called when Qt Creator is about to quit. */
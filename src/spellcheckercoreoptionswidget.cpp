@@ -81,6 +81,10 @@ const SpellCheckerCoreSettings& SpellCheckerCoreOptionsWidget::settings()
   m_settings.checkExternalFiles       = ui->checkBoxCheckExternal->isChecked();
   m_settings.projectsToIgnore         = m_projectsToIgnore;
   m_settings.replaceAllFromRightClick = ui->checkBoxReplaceAllRightClick->isChecked();
+  m_settings.persistSuggestions       = ui->checkBoxPersistSuggestions->isChecked();
+  m_settings.lazySuggestions          = ui->checkBoxLazySuggestions->isChecked();
+  m_settings.persistResults           = ui->checkBoxPersistResults->isChecked();
+  m_settings.workerThreads            = ui->spinBoxWorkerThreads->value();
   return m_settings;
 }
 // --------------------------------------------------
@@ -123,6 +127,10 @@ void SpellCheckerCoreOptionsWidget::updateWithSettings( const SpellCheckerCoreSe
   ui->listWidget->clear();
   ui->listWidget->addItems( m_projectsToIgnore );
   ui->checkBoxReplaceAllRightClick->setChecked( settings->replaceAllFromRightClick );
+  ui->checkBoxPersistSuggestions->setChecked( settings->persistSuggestions );
+  ui->checkBoxLazySuggestions->setChecked( settings->lazySuggestions );
+  ui->checkBoxPersistResults->setChecked( settings->persistResults );
+  ui->spinBoxWorkerThreads->setValue( settings->workerThreads );
 }
 // --------------------------------------------------
 
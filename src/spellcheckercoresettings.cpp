@@ -30,6 +30,10 @@ SpellCheckerCoreSettings::SpellCheckerCoreSettings()
   , checkExternalFiles( false )
   , projectsToIgnore()
   , replaceAllFromRightClick( true )
+  , persistSuggestions( false )
+  , lazySuggestions( false )
+  , persistResults( false )
+  , workerThreads( 0 )
 {}
 // --------------------------------------------------
 
@@ -40,6 +44,10 @@ SpellCheckerCoreSettings::SpellCheckerCoreSettings( const SpellCheckerCoreSettin
   , checkExternalFiles( settings.checkExternalFiles )
   , projectsToIgnore( settings.projectsToIgnore )
   , replaceAllFromRightClick( settings.replaceAllFromRightClick )
+  , persistSuggestions( settings.persistSuggestions )
+  , lazySuggestions( settings.lazySuggestions )
+  , persistResults( settings.persistResults )
+  , workerThreads( settings.workerThreads )
 {}
 // --------------------------------------------------
 
@@ -55,6 +63,10 @@ void SpellCheckerCoreSettings::saveToSettings( QSettings* settings ) const
   settings->setValue( QLatin1String( Constants::SETTING_CHECK_EXTERNAL ),       checkExternalFiles );
   settings->setValue( QLatin1String( Constants::PROJECTS_TO_IGNORE ),           projectsToIgnore );
   settings->setValue( QLatin1String( Constants::REPLACE_ALL_FROM_RIGHT_CLICK ), replaceAllFromRightClick );
+  settings->setValue( QLatin1String( Constants::SETTING_PERSIST_SUGGESTIONS ),  persistSuggestions );
+  settings->setValue( QLatin1String( Constants::SETTING_LAZY_SUGGESTIONS ),     lazySuggestions );
+  settings->setValue( QLatin1String( Constants::SETTING_PERSIST_RESULTS ),      persistResults );
+  settings->setValue( QLatin1String( Constants::SETTING_WORKER_THREADS ),       workerThreads );
   settings->endGroup(); /* CORE_SETTINGS_GROUP */
   settings->sync();
 }
@@ -68,6 +80,10 @@ void SpellCheckerCoreSettings::loadFromSettings( QSettings* settings )
   checkExternalFiles       = settings->value( QLatin1String( Constants::SETTING_CHECK_EXTERNAL ), checkExternalFiles ).toBool();
   projectsToIgnore         = settings->value( QLatin1String( Constants::PROJECTS_TO_IGNORE ), projectsToIgnore ).toStringList();
   replaceAllFromRightClick = settings->value( QLatin1String( Constants::REPLACE_ALL_FROM_RIGHT_CLICK ), replaceAllFromRightClick ).toBool();
+  persistSuggestions       = settings->value( QLatin1String( Constants::SETTING_PERSIST_SUGGESTIONS ), persistSuggestions ).toBool();
+  lazySuggestions          = settings->value( QLatin1String( Constants::SETTING_LAZY_SUGGESTIONS ), lazySuggestions ).toBool();
+  persistResults           = settings->value( QLatin1String( Constants::SETTING_PERSIST_RESULTS ), persistResults ).toBool();
+  workerThreads            = settings->value( QLatin1String( Constants::SETTING_WORKER_THREADS ), workerThreads ).toInt();
   settings->endGroup(); /* CORE_SETTINGS_GROUP */
 }
 // --------------------------------------------------
@@ -81,6 +97,10 @@ SpellCheckerCoreSettings& SpellCheckerCoreSettings::operator=( const SpellChecke
     this->checkExternalFiles       = other.checkExternalFiles;
     this->projectsToIgnore         = other.projectsToIgnore;
     this->replaceAllFromRightClick = other.replaceAllFromRightClick;
+    this->persistSuggestions       = other.persistSuggestions;
+    this->lazySuggestions          = other.lazySuggestions;
+    this->persistResults           = other.persistResults;
+    this->workerThreads            = other.workerThreads;
     emit settingsChanged();
   }
   return *this;
@@ -95,6 +115,10 @@ bool SpellCheckerCoreSettings::operator==( const SpellCheckerCoreSettings& other
   different = different | ( checkExternalFiles != other.checkExternalFiles );
   different = different | ( projectsToIgnore != other.projectsToIgnore );
   different = different | ( replaceAllFromRightClick != other.replaceAllFromRightClick );
+  different = different | ( persistSuggestions != other.persistSuggestions );
+  different = different | ( lazySuggestions != other.lazySuggestions );
+  different = different | ( persistResults != other.persistResults );
+  different = different | ( workerThreads != other.workerThreads );
   return ( different == false );
 }
 // --------------------------------------------------
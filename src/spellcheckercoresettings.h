@@ -48,6 +48,18 @@ public:
   /*! Replace all occurrences of a misspelled word on the current page when
    * a suggestion is selected from the right click menu. */
   bool replaceAllFromRightClick;
+  /*! Keep the suggestions for misspelled words between sessions so that
+   * they do not have to be computed again. */
+  bool persistSuggestions;
+  /*! Only get suggestions for mistakes once they become visible, files
+   * checked in the background only keep the misspelled words. */
+  bool lazySuggestions;
+  /*! Keep the words and mistakes of the files of a project between
+   * sessions so that files that did not change are not checked again. */
+  bool persistResults;
+  /*! Number of threads used to check the files of a project in the
+   * background, 0 to pick a number based on the cores of the machine. */
+  int workerThreads;
 
 signals:
   void settingsChanged();
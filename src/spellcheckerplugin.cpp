@@ -18,15 +18,19 @@
 ** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
 ****************************************************************************/
 
+#include "CachedSpellChecker.h"
+#include "KnownWordsSpellChecker.h"
 #include "NavigationWidget.h"
 #include "outputpane.h"
 #include "spellcheckerconstants.h"
 #include "spellcheckercore.h"
+#include "spellcheckercoresettings.h"
 #include "spellcheckerplugin.h"
 #include "spellcheckquickfix.h"
 
 /* SpellCheckers */
 #include "SpellCheckers/HunspellChecker/hunspellchecker.h"
+#include "SpellCheckers/MappedDictionary/mappeddictionarychecker.h"
 
 /* Parsers */
 #include "Parsers/CppParser/cppdocumentparser.h"
@@ -60,7 +64,8 @@ public:
   std::unique_ptr<SpellCheckerCore> spellCheckerCore;
   std::unique_ptr<CppSpellChecker::Internal::CppParserSettings> cppParserSettings;
   std::unique_ptr<NavigationWidgetFactory> navFactory;
-  std::unique_ptr<SpellChecker::ISpellChecker> spellChecker;
+  std::unique_ptr<SpellChecker::CachedSpellChecker> spellChecker;
+  std::unique_ptr<SpellChecker::Checker::MappedDictionary::MappedDictionaryChecker> mappedSpellChecker;
   std::unique_ptr<SpellChecker::IDocumentParser> cppParser;
   std::unique_ptr<SpellCheckCppQuickFixFactory>  quickFixFactory;
 };
@@ -177,9 +182,34 @@ bool SpellCheckerPlugin::initialize( const QStringList& arguments, QString* erro
   d->navFactory = std::make_unique<NavigationWidgetFactory>( d->spellCheckerCore->spellingMistakesModel() );
 
   /* --- Create the default Spell Checker and Document Parser --- */
-  /* Hunspell Spell Checker */
-  d->spellChecker = std::make_unique<SpellChecker::Checker::Hunspell::HunspellChecker>();
+  /* Hunspell Spell Checker, wrapped in the known words filter so that the
+   * plain words of the dictionary do not go through the affix handling of
+   * Hunspell, and in the cache so that repeated words do not have to be
+   * checked each time. */
+  d->spellChecker = std::make_unique<SpellChecker::CachedSpellChecker>(
+        std::make_unique<SpellChecker::KnownWordsSpellChecker>(
+          std::make_unique<SpellChecker::Checker::Hunspell::HunspellChecker>() ) );
   d->spellCheckerCore->setSpellChecker( d->spellChecker.get() );
+  SpellChecker::CachedSpellChecker* cachedSpellChecker = d->spellChecker.get();
+  SpellCheckerCoreSettings* coreSettings               = d->spellCheckerCore->settings();
+  cachedSpellChecker->setPersistentSuggestions( coreSettings->persistSuggestions );
+  connect( coreSettings, &SpellCheckerCoreSettings::settingsChanged, cachedSpellChecker, [=]() {
+    cachedSpellChecker->setPersistentSuggestions( coreSettings->persistSuggestions );
+  } );
+  /* Spell checker using a precompiled, memory mapped dictionary. Lookups on
+   * the image are cheap, thus it is not wrapped in the cache. */
+  d->mappedSpellChecker = std::make_unique<SpellChecker::Checker::MappedDictionary::MappedDictionaryChecker>();
+  d->spellCheckerCore->addSpellChecker( d->mappedSpellChecker.get() );
+  /* Use the spell checker selected in the settings. */
+  SpellCheckerCore* spellCheckerCore = d->spellCheckerCore.get();
+  auto setActiveSpellChecker         = [=]() {
+    ISpellChecker* activeSpellChecker = spellCheckerCore->addedSpellCheckers().value( coreSettings->activeSpellChecker, nullptr );
+    if( activeSpellChecker != nullptr ) {
+      spellCheckerCore->setSpellChecker( activeSpellChecker );
+    }
+  };
+  setActiveSpellChecker();
+  connect( coreSettings, &SpellCheckerCoreSettings::settingsChanged, spellCheckerCore, setActiveSpellChecker );
 
   /* Cpp Document Parser */
   d->cppParser = std::make_unique<SpellChecker::CppSpellChecker::Internal::CppDocumentParser>();
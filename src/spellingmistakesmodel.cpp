@@ -89,7 +89,7 @@ private:
 class SpellChecker::Internal::SpellingMistakesModelPrivate
 {
 public:
-  QList<SpellChecker::Word> wordList;
+  QVector<SpellChecker::Word> wordList;
   Constants::MistakesModelColumn sortColumn;
   Qt::SortOrder sortOrder;
   QDir projectDir;
@@ -121,7 +121,7 @@ SpellingMistakesModel::~SpellingMistakesModel()
 void SpellingMistakesModel::setCurrentSpellingMistakes( const SpellChecker::WordList& words )
 {
   beginResetModel();
-  d->wordList = words.values();
+  d->wordList = words.toVector();
   sort( d->sortColumn, d->sortOrder );
   endResetModel();
   emit layoutChanged();
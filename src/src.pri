@@ -9,9 +9,18 @@ SOURCES += \
         $${PWD}/spellingmistakesmodel.cpp \
         $${PWD}/outputpane.cpp \
         $${PWD}/ISpellChecker.cpp \
+        $${PWD}/CachedSpellChecker.cpp \
+        $${PWD}/KnownWordsFilter.cpp \
+        $${PWD}/KnownWordsSpellChecker.cpp \
+        $${PWD}/MistakeStore.cpp \
+        $${PWD}/ResultCache.cpp \
+        $${PWD}/SuggestionCache.cpp \
+        $${PWD}/UserDictionary.cpp \
+        $${PWD}/Word.cpp \
         $${PWD}/spellcheckercoreoptionspage.cpp \
         $${PWD}/spellcheckercoresettings.cpp \
         $${PWD}/spellcheckercoreoptionswidget.cpp \
+        $${PWD}/SpellCheckerThreadPool.cpp \
         $${PWD}/suggestionsdialog.cpp \
         $${PWD}/NavigationWidget.cpp \
         $${PWD}/ProjectMistakesModel.cpp \
@@ -27,9 +36,17 @@ HEADERS += \
         $${PWD}/spellingmistakesmodel.h \
         $${PWD}/outputpane.h \
         $${PWD}/ISpellChecker.h \
+        $${PWD}/CachedSpellChecker.h \
+        $${PWD}/KnownWordsFilter.h \
+        $${PWD}/KnownWordsSpellChecker.h \
+        $${PWD}/MistakeStore.h \
+        $${PWD}/ResultCache.h \
+        $${PWD}/SuggestionCache.h \
+        $${PWD}/UserDictionary.h \
         $${PWD}/spellcheckercoreoptionspage.h \
         $${PWD}/spellcheckercoresettings.h \
         $${PWD}/spellcheckercoreoptionswidget.h \
+        $${PWD}/SpellCheckerThreadPool.h \
         $${PWD}/suggestionsdialog.h \
         $${PWD}/NavigationWidget.h \
         $${PWD}/ProjectMistakesModel.h \
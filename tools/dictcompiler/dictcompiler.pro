@@ -0,0 +1,18 @@
+# Offline compiler for the dictionary images used by the
+# Mapped Dictionary spell checker of the SpellChecker plugin.
+#
+# The tool does not depend on Qt Creator or Hunspell, only on QtCore.
+
+QT      -= gui
+CONFIG  += console c++14
+CONFIG  -= app_bundle
+TEMPLATE = app
+TARGET   = dictcompiler
+
+INCLUDEPATH += $${PWD}/../../src/SpellCheckers/MappedDictionary
+
+SOURCES += \
+        $${PWD}/main.cpp
+
+HEADERS += \
+        $${PWD}/../../src/SpellCheckers/MappedDictionary/MappedDictionaryFormat.h
@@ -0,0 +1,544 @@
+/**************************************************************************
+**
+** Copyright (c) 2014 Carel Combrink
+**
+** This file is part of the SpellChecker Plugin, a Qt Creator plugin.
+**
+** The SpellChecker Plugin is free software: you can redistribute it and/or
+** modify it under the terms of the GNU Lesser General Public License as
+** published by the Free Software Foundation, either version 3 of the
+** License, or (at your option) any later version.
+**
+** The SpellChecker Plugin is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with the SpellChecker Plugin.  If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "MappedDictionaryFormat.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegExp>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextCodec>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <vector>
+
+/*! \file
+ * \brief Compiler for the dictionary images used by the MappedDictionaryChecker.
+ *
+ * The compiler reads lists of accepted word forms and writes a sorted,
+ * front coded image that the checker can memory map. The image does not
+ * contain any affix rules, thus the entries of a Hunspell dictionary are
+ * expanded into all their word forms while reading it:
+ *
+ *     dictcompiler -o en_US.scdic en_US.dic QtC-en_US.udic
+ *
+ * Lines of the inputs are handled as follows:
+ *  - Empty lines and lines starting with '#' are skipped.
+ *  - The first line is skipped if it only contains a number, the word count
+ *      at the start of a .dic file.
+ *  - Anything after a tab or space is removed, thus morphological fields of
+ *      .dic entries are ignored.
+ *  - Anything after an unescaped '/' are the flags of the entry. For a .dic
+ *      file with a .aff file next to it, the PFX and SFX rules of the flags
+ *      are applied the same as the unmunch tool of Hunspell does, using the
+ *      encoding from the SET option of the .aff file. Stems with FORBIDDENWORD
+ *      are removed from the image, stems with ONLYINCOMPOUND are left out.
+ *      Compounds and forms that need the continuation flags of an affix are
+ *      not expanded, Hunspell accepts more words than the image contains.
+ *      For other inputs the flags are ignored. */
+
+using namespace SpellChecker::Checker::MappedDictionary;
+
+namespace {
+
+/*! \brief Rule of a PFX or SFX entry of a .aff file. */
+struct AffixRule
+{
+  QString strip;      /*!< Characters removed from the stem. */
+  QString affix;      /*!< Characters added to the stem. */
+  QRegExp condition;  /*!< Condition on the stem, empty if any stem matches. */
+};
+
+/*! \brief The rules of a single PFX or SFX flag. */
+struct AffixClass
+{
+  bool crossProduct = false; /*!< Can be combined with an affix of the other kind. */
+  QVector<AffixRule> rules;
+};
+
+/*! \brief The parts of a .aff file needed to expand the entries of a .dic file. */
+struct AffixFile
+{
+  QTextCodec* codec = nullptr;
+  QString flagType;
+  QStringList flagAliases;          /*!< Flag sets of the AF lines, referenced by number. */
+  QSet<QString> needAffixFlags;     /*!< NEEDAFFIX and PSEUDOROOT, the stem itself is not a word. */
+  QSet<QString> onlyInCompoundFlags;
+  QSet<QString> forbiddenFlags;
+  QSet<QString> circumfixFlags;
+  QHash<QString, AffixClass> prefixes;
+  QHash<QString, AffixClass> suffixes;
+};
+
+/*! \brief Split the flags of an entry according to the FLAG type and the AF aliases. */
+QStringList splitFlags( const QString& flags, const AffixFile& affixFile )
+{
+  QString expanded = flags;
+  if( affixFile.flagAliases.isEmpty() == false ) {
+    bool isNumber   = false;
+    const int alias = flags.toInt( &isNumber );
+    if( isNumber == true ) {
+      expanded = affixFile.flagAliases.value( alias - 1 );
+    }
+  }
+  QStringList result;
+  if( affixFile.flagType == QLatin1String( "num" ) ) {
+    result = expanded.split( QLatin1Char( ',' ), Qt::SkipEmptyParts );
+  } else if( affixFile.flagType == QLatin1String( "long" ) ) {
+    for( int index = 0; index < expanded.size(); index += 2 ) {
+      result.append( expanded.mid( index, 2 ) );
+    }
+  } else {
+    for( const QChar& flag: expanded ) {
+      result.append( flag );
+    }
+  }
+  return result;
+}
+// --------------------------------------------------
+
+/*! \brief Check if any of the \a flags is in the set of \a special flags. */
+bool hasFlag( const QStringList& flags, const QSet<QString>& special )
+{
+  return std::any_of( flags.cbegin(), flags.cend(), [&special]( const QString& flag ) {
+    return special.contains( flag );
+  } );
+}
+// --------------------------------------------------
+
+/*! \brief Convert the condition of an affix rule to a regular expression.
+ *
+ * The condition is a sequence of characters, '.' for any character and
+ * character classes in square brackets. All other characters are literal. */
+QRegExp conditionRegExp( const QString& condition, bool suffix )
+{
+  if( condition == QLatin1String( "." ) ) {
+    return QRegExp();
+  }
+  QString pattern;
+  bool inClass = false;
+  for( const QChar& character: condition ) {
+    if( ( inClass == false ) && ( character == QLatin1Char( '.' ) ) ) {
+      pattern.append( character );
+    } else if( ( inClass == false ) && ( character == QLatin1Char( '[' ) ) ) {
+      inClass = true;
+      pattern.append( character );
+    } else if( ( inClass == true ) && ( character == QLatin1Char( ']' ) ) ) {
+      inClass = false;
+      pattern.append( character );
+    } else if( ( inClass == true ) && ( character == QLatin1Char( '^' ) ) && ( pattern.endsWith( QLatin1Char( '[' ) ) == true ) ) {
+      pattern.append( character );
+    } else if( character.isLetterOrNumber() == true ) {
+      pattern.append( character );
+    } else {
+      pattern.append( QLatin1Char( '\\' ) ).append( character );
+    }
+  }
+  return QRegExp( ( suffix == true ) ? QString( pattern + QLatin1Char( '$' ) ) : QString( QLatin1Char( '^' ) + pattern ) );
+}
+// --------------------------------------------------
+
+/*! \brief Read the affix rules of a .aff file.
+ * \return False if the file could not be read. */
+bool readAffixFile( const QString& fileName, AffixFile& affixFile )
+{
+  QFile file( fileName );
+  if( file.open( QIODevice::ReadOnly ) == false ) {
+    QTextStream( stderr ) << "Could not open affix file: " << fileName << Qt::endl;
+    return false;
+  }
+  const QByteArray contents = file.readAll();
+  /* The keywords are ASCII, the SET line gives the encoding of the rest. */
+  QByteArray encoding = "ISO8859-1";
+  for( const QByteArray& line: contents.split( '\n' ) ) {
+    const QList<QByteArray> fields = line.simplified().split( ' ' );
+    if( ( fields.size() >= 2 )
+        && ( fields.at( 0 ) == "SET" ) ) {
+      encoding = fields.at( 1 );
+      break;
+    }
+  }
+  affixFile.codec = QTextCodec::codecForName( encoding );
+  if( affixFile.codec == nullptr ) {
+    QTextStream( stderr ) << "Unknown encoding " << encoding << " in affix file: " << fileName << Qt::endl;
+    return false;
+  }
+  const QStringList lines = affixFile.codec->toUnicode( contents ).split( QLatin1Char( '\n' ) );
+  /* The rules are only added once all lines are read, the flag type and
+   * aliases are needed to split the continuation flags of a rule. */
+  struct RuleLine
+  {
+    bool suffix;
+    QStringList fields;
+  };
+  QVector<RuleLine> ruleLines;
+  bool aliasCountRead = false;
+  for( const QString& line: lines ) {
+    const QStringList fields = line.simplified().split( QLatin1Char( ' ' ), Qt::SkipEmptyParts );
+    if( fields.size() < 2 ) {
+      continue;
+    }
+    const QString& keyword = fields.at( 0 );
+    if( keyword == QLatin1String( "FLAG" ) ) {
+      affixFile.flagType = fields.at( 1 );
+    } else if( keyword == QLatin1String( "AF" ) ) {
+      /* The first AF line only holds the number of aliases. */
+      if( aliasCountRead == true ) {
+        affixFile.flagAliases.append( fields.at( 1 ) );
+      }
+      aliasCountRead = true;
+    } else if( ( keyword == QLatin1String( "NEEDAFFIX" ) )
+               || ( keyword == QLatin1String( "PSEUDOROOT" ) ) ) {
+      affixFile.needAffixFlags.insert( fields.at( 1 ) );
+    } else if( keyword == QLatin1String( "ONLYINCOMPOUND" ) ) {
+      affixFile.onlyInCompoundFlags.insert( fields.at( 1 ) );
+    } else if( keyword == QLatin1String( "FORBIDDENWORD" ) ) {
+      affixFile.forbiddenFlags.insert( fields.at( 1 ) );
+    } else if( keyword == QLatin1String( "CIRCUMFIX" ) ) {
+      affixFile.circumfixFlags.insert( fields.at( 1 ) );
+    } else if( ( ( keyword == QLatin1String( "PFX" ) ) || ( keyword == QLatin1String( "SFX" ) ) )
+               && ( fields.size() >= 4 ) ) {
+      ruleLines.append( { keyword == QLatin1String( "SFX" ), fields } );
+    }
+  }
+  for( const RuleLine& ruleLine: qAsConst( ruleLines ) ) {
+    QHash<QString, AffixClass>& classes = ( ruleLine.suffix == true ) ? affixFile.suffixes : affixFile.prefixes;
+    const QStringList& fields           = ruleLine.fields;
+    const QString& flag                 = fields.at( 1 );
+    if( classes.contains( flag ) == false ) {
+      /* The first line of a flag is the header: flag, cross product and count. */
+      classes[flag].crossProduct = ( fields.at( 2 ) == QLatin1String( "Y" ) );
+      continue;
+    }
+    QString affix = fields.at( 3 );
+    const int continuationStart = affix.indexOf( QLatin1Char( '/' ) );
+    if( continuationStart != -1 ) {
+      /* Affixes that need another affix are not words by themselves. Other
+       * continuation flags are not expanded, the forms that they allow are
+       * not in the image. */
+      const QStringList continuation = splitFlags( affix.mid( continuationStart + 1 ), affixFile );
+      if( ( hasFlag( continuation, affixFile.needAffixFlags ) == true )
+          || ( hasFlag( continuation, affixFile.circumfixFlags ) == true ) ) {
+        continue;
+      }
+      affix.truncate( continuationStart );
+    }
+    AffixRule rule;
+    rule.strip     = ( fields.at( 2 ) == QLatin1String( "0" ) ) ? QString() : fields.at( 2 );
+    rule.affix     = ( affix == QLatin1String( "0" ) ) ? QString() : affix;
+    rule.condition = conditionRegExp( fields.value( 4, QStringLiteral( "." ) ), ruleLine.suffix );
+    classes[flag].rules.append( rule );
+  }
+  return true;
+}
+// --------------------------------------------------
+
+/*! \brief Check if the \a rule applies to the \a word. */
+bool ruleApplies( const AffixRule& rule, const QString& word, bool suffix )
+{
+  if( word.size() <= rule.strip.size() ) {
+    return false;
+  }
+  if( ( ( suffix == true ) && ( word.endsWith( rule.strip ) == false ) )
+      || ( ( suffix == false ) && ( word.startsWith( rule.strip ) == false ) ) ) {
+    return false;
+  }
+  return ( rule.condition.isEmpty() == true )
+         || ( rule.condition.indexIn( word ) != -1 );
+}
+// --------------------------------------------------
+
+/*! \brief Expand the stem of a .dic entry into all its word forms.
+ *
+ * Suffixes and prefixes of the stem are applied, and each prefix with cross
+ * product also to the forms of the suffixes with cross product, the same
+ * as the unmunch tool of Hunspell does. */
+QStringList expandEntry( const QString& stem, const QStringList& flags, const AffixFile& affixFile )
+{
+  QStringList forms;
+  if( hasFlag( flags, affixFile.needAffixFlags ) == false ) {
+    forms.append( stem );
+  }
+  QStringList crossSuffixed;
+  for( const QString& flag: flags ) {
+    const auto suffixes = affixFile.suffixes.constFind( flag );
+    if( suffixes == affixFile.suffixes.cend() ) {
+      continue;
+    }
+    for( const AffixRule& rule: suffixes->rules ) {
+      if( ruleApplies( rule, stem, true ) == true ) {
+        const QString form = stem.left( stem.size() - rule.strip.size() ) + rule.affix;
+        forms.append( form );
+        if( suffixes->crossProduct == true ) {
+          crossSuffixed.append( form );
+        }
+      }
+    }
+  }
+  for( const QString& flag: flags ) {
+    const auto prefixes = affixFile.prefixes.constFind( flag );
+    if( prefixes == affixFile.prefixes.cend() ) {
+      continue;
+    }
+    for( const AffixRule& rule: prefixes->rules ) {
+      if( ruleApplies( rule, stem, false ) == true ) {
+        forms.append( rule.affix + stem.mid( rule.strip.size() ) );
+      }
+      if( prefixes->crossProduct == false ) {
+        continue;
+      }
+      for( const QString& suffixed: qAsConst( crossSuffixed ) ) {
+        if( ruleApplies( rule, suffixed, false ) == true ) {
+          forms.append( rule.affix + suffixed.mid( rule.strip.size() ) );
+        }
+      }
+    }
+  }
+  return forms;
+}
+// --------------------------------------------------
+
+/*! \brief Read the words from the input file and add them to \a words.
+ *
+ * If \a affixFile is set the input is a .dic file and its entries are
+ * expanded using the affix rules. Stems marked as forbidden are added to
+ * \a forbidden instead.
+ * \return False if the file could not be read. */
+bool readWords( const QString& fileName, QTextCodec* codec, const AffixFile* affixFile, std::vector<QByteArray>& words, QSet<QString>& forbidden, QSet<QChar>& alphabet, int& skipped )
+{
+  QFile file( fileName );
+  if( file.open( QIODevice::ReadOnly | QIODevice::Text ) == false ) {
+    QTextStream( stderr ) << "Could not open input file: " << fileName << Qt::endl;
+    return false;
+  }
+  QTextStream stream( &file );
+  stream.setCodec( ( affixFile != nullptr ) ? affixFile->codec : codec );
+  bool firstLine = true;
+  while( stream.atEnd() == false ) {
+    QString line = stream.readLine();
+    if( firstLine == true ) {
+      firstLine = false;
+      bool isNumber = false;
+      line.trimmed().toUInt( &isNumber );
+      if( isNumber == true ) {
+        continue;
+      }
+    }
+    const int end = line.indexOf( QRegExp( QStringLiteral( "[\\t ]" ) ) );
+    if( end != -1 ) {
+      line.truncate( end );
+    }
+    /* A slash that is part of the word is escaped with a backslash. */
+    int flagsStart = line.indexOf( QLatin1Char( '/' ) );
+    while( ( flagsStart > 0 )
+           && ( line.at( flagsStart - 1 ) == QLatin1Char( '\\' ) ) ) {
+      flagsStart = line.indexOf( QLatin1Char( '/' ), flagsStart + 1 );
+    }
+    QString word = ( flagsStart == -1 ) ? line : line.left( flagsStart );
+    word.replace( QStringLiteral( "\\/" ), QStringLiteral( "/" ) );
+    if( ( word.isEmpty() == true )
+        || ( word.startsWith( QLatin1Char( '#' ) ) == true ) ) {
+      continue;
+    }
+    QStringList forms( word );
+    if( affixFile != nullptr ) {
+      const QStringList flags = ( flagsStart == -1 ) ? QStringList() : splitFlags( line.mid( flagsStart + 1 ), *affixFile );
+      if( hasFlag( flags, affixFile->forbiddenFlags ) == true ) {
+        forbidden.insert( word );
+        continue;
+      }
+      if( hasFlag( flags, affixFile->onlyInCompoundFlags ) == true ) {
+        continue;
+      }
+      forms = expandEntry( word, flags, *affixFile );
+    }
+    for( const QString& form: qAsConst( forms ) ) {
+      const QByteArray utf8 = form.toUtf8();
+      if( utf8.size() > Format::MAX_WORD_BYTES ) {
+        ++skipped;
+        continue;
+      }
+      for( const QChar& character: form ) {
+        alphabet.insert( character );
+      }
+      words.push_back( utf8 );
+    }
+  }
+  return true;
+}
+// --------------------------------------------------
+
+/*! \brief Build the image from the sorted, unique list of words. */
+QByteArray buildImage( const std::vector<QByteArray>& words, const QSet<QChar>& alphabet )
+{
+  QList<QChar> characters = alphabet.values();
+  std::sort( characters.begin(), characters.end() );
+  QString alphabetString;
+  for( const QChar& character: characters ) {
+    alphabetString.append( character );
+  }
+  const QByteArray alphabetUtf8 = alphabetString.toUtf8();
+
+  QByteArray data;
+  QByteArray index;
+  const QByteArray* previous = nullptr;
+  for( size_t wordIdx = 0; wordIdx < words.size(); ++wordIdx ) {
+    const QByteArray& word = words[wordIdx];
+    if( ( wordIdx % Format::WORDS_PER_BLOCK ) == 0 ) {
+      /* Start of a new block, store the full word. */
+      const quint32 offset = qToLittleEndian( quint32( data.size() ) );
+      index.append( reinterpret_cast<const char*>( &offset ), sizeof( offset ) );
+      Format::appendVarint( data, quint32( word.size() ) );
+      data.append( word );
+    } else {
+      int prefix = 0;
+      const int maxPrefix = qMin( word.size(), previous->size() );
+      while( ( prefix < maxPrefix )
+             && ( word.at( prefix ) == previous->at( prefix ) ) ) {
+        ++prefix;
+      }
+      Format::appendVarint( data, quint32( prefix ) );
+      Format::appendVarint( data, quint32( word.size() - prefix ) );
+      data.append( word.constData() + prefix, word.size() - prefix );
+    }
+    previous = &word;
+  }
+
+  Format::Header header;
+  std::memcpy( header.magic, Format::MAGIC, sizeof( Format::MAGIC ) );
+  header.version        = qToLittleEndian( Format::VERSION );
+  header.wordCount      = qToLittleEndian( quint32( words.size() ) );
+  header.blockCount     = qToLittleEndian( quint32( index.size() / int( sizeof( quint32 ) ) ) );
+  header.alphabetSize   = qToLittleEndian( quint32( alphabetUtf8.size() ) );
+  header.alphabetOffset = qToLittleEndian( quint64( sizeof( header ) ) );
+  header.indexOffset    = qToLittleEndian( quint64( sizeof( header ) + alphabetUtf8.size() ) );
+  header.dataOffset     = qToLittleEndian( quint64( sizeof( header ) + alphabetUtf8.size() + index.size() ) );
+  header.dataSize       = qToLittleEndian( quint64( data.size() ) );
+
+  QByteArray image;
+  image.reserve( int( sizeof( header ) ) + alphabetUtf8.size() + index.size() + data.size() );
+  image.append( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+  image.append( alphabetUtf8 );
+  image.append( index );
+  image.append( data );
+  return image;
+}
+// --------------------------------------------------
+
+} // namespace
+
+int main( int argc, char* argv[] )
+{
+  QCoreApplication app( argc, argv );
+  QCoreApplication::setApplicationName( QStringLiteral( "dictcompiler" ) );
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription( QStringLiteral( "Compile word lists into a dictionary image for the SpellChecker plugin." ) );
+  parser.addHelpOption();
+  const QCommandLineOption outputOption( { QStringLiteral( "o" ), QStringLiteral( "output" ) },
+                                         QStringLiteral( "Image file to write." ), QStringLiteral( "file" ) );
+  const QCommandLineOption encodingOption( { QStringLiteral( "e" ), QStringLiteral( "encoding" ) },
+                                           QStringLiteral( "Encoding of the word lists. Hunspell dictionaries use the SET option of their .aff file." ),
+                                           QStringLiteral( "name" ), QStringLiteral( "UTF-8" ) );
+  const QCommandLineOption verifyOption( QStringLiteral( "verify" ),
+                                         QStringLiteral( "Look up every word in the written image." ) );
+  parser.addOption( outputOption );
+  parser.addOption( encodingOption );
+  parser.addOption( verifyOption );
+  parser.addPositionalArgument( QStringLiteral( "inputs" ), QStringLiteral( "Hunspell .dic files with their .aff file next to them, or word lists such as a user dictionary." ), QStringLiteral( "inputs..." ) );
+  parser.process( app );
+
+  QTextStream err( stderr );
+  const QStringList inputs = parser.positionalArguments();
+  if( ( inputs.isEmpty() == true )
+      || ( parser.isSet( outputOption ) == false ) ) {
+    parser.showHelp( 1 );
+  }
+  QTextCodec* codec = QTextCodec::codecForName( parser.value( encodingOption ).toLatin1() );
+  if( codec == nullptr ) {
+    err << "Unknown encoding: " << parser.value( encodingOption ) << Qt::endl;
+    return 1;
+  }
+
+  std::vector<QByteArray> words;
+  QSet<QString> forbidden;
+  QSet<QChar> alphabet;
+  int skipped = 0;
+  for( const QString& input: inputs ) {
+    /* A .dic file with a .aff file next to it is a Hunspell dictionary,
+     * other inputs are lists of words. */
+    AffixFile affixFile;
+    const QFileInfo inputInfo( input );
+    const QString affixFileName = inputInfo.path() + QLatin1Char( '/' ) + inputInfo.completeBaseName() + QLatin1String( ".aff" );
+    const bool isDictionary     = ( inputInfo.suffix() == QLatin1String( "dic" ) )
+                                  && ( QFileInfo::exists( affixFileName ) == true );
+    if( ( isDictionary == true )
+        && ( readAffixFile( affixFileName, affixFile ) == false ) ) {
+      return 1;
+    }
+    if( readWords( input, codec, ( isDictionary == true ) ? &affixFile : nullptr, words, forbidden, alphabet, skipped ) == false ) {
+      return 1;
+    }
+  }
+  /* Sort by the bytes of the words, the same order as used by the lookup. */
+  std::sort( words.begin(), words.end() );
+  words.erase( std::unique( words.begin(), words.end() ), words.end() );
+  if( forbidden.isEmpty() == false ) {
+    words.erase( std::remove_if( words.begin(), words.end(), [&forbidden]( const QByteArray& word ) {
+      return forbidden.contains( QString::fromUtf8( word ) );
+    } ), words.end() );
+  }
+
+  const QByteArray image = buildImage( words, alphabet );
+  QSaveFile output( parser.value( outputOption ) );
+  if( ( output.open( QIODevice::WriteOnly ) == false )
+      || ( output.write( image ) != image.size() )
+      || ( output.commit() == false ) ) {
+    err << "Could not write output file: " << parser.value( outputOption ) << Qt::endl;
+    return 1;
+  }
+
+  if( parser.isSet( verifyOption ) == true ) {
+    Format::ImageReader reader;
+    if( reader.open( reinterpret_cast<const uchar*>( image.constData() ), image.size() ) == false ) {
+      err << "Written image is not valid" << Qt::endl;
+      return 1;
+    }
+    for( const QByteArray& word: words ) {
+      if( reader.contains( word ) == false ) {
+        err << "Word not found in written image: " << QString::fromUtf8( word ) << Qt::endl;
+        return 1;
+      }
+    }
+  }
+
+  QTextStream( stdout ) << "Wrote " << words.size() << " words (" << image.size() << " bytes)"
+                        << " to " << parser.value( outputOption ) << Qt::endl;
+  if( skipped != 0 ) {
+    err << "Skipped " << skipped << " words longer than " << Format::MAX_WORD_BYTES << " bytes" << Qt::endl;
+  }
+  return 0;
+}